@@ -0,0 +1,137 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include "alloc_stats.h"
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// 基准测试公用的计时与数据生成工具
+
+// 简单的计时器，返回毫秒
+class BenchTimer
+{
+public:
+    BenchTimer() : start(std::chrono::steady_clock::now()) {}
+
+    void reset()
+    {
+        start = std::chrono::steady_clock::now();
+    }
+
+    double elapsedMs() const
+    {
+        auto now = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(now - start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+// 以-DREGEXP_ALLOC_STATS=ON构建且设置了环境变量REGEXP_ALLOC_REPORT时，输出自上次调用以来
+// 各阶段与数据结构的内存分配统计并清零；放在一段计时的输出之后，内存与时间的变化一起出现
+inline void reportAllocations(const std::string &title)
+{
+    static const bool requested = std::getenv("REGEXP_ALLOC_REPORT") != nullptr;
+    if (!requested || !allocStatsEnabled())
+    {
+        return;
+    }
+    std::cout << "  内存分配（" << title << "）:\n";
+    writeAllocReport(std::cout, "    ");
+    resetAllocStats();
+}
+
+// 逐行读取文件，忽略空行
+inline std::vector<std::string> loadLines(const std::string &path)
+{
+    std::vector<std::string> lines;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (!line.empty())
+        {
+            lines.push_back(line);
+        }
+    }
+    return lines;
+}
+
+// 在支持的语法（| * + ? 和括号）内生成随机正则表达式
+inline std::string randomPattern(std::mt19937 &rng, const std::string &alphabet, int depth)
+{
+    std::uniform_int_distribution<int> pick(0, 9);
+    std::uniform_int_distribution<size_t> symbol(0, alphabet.size() - 1);
+    int kind = depth <= 0 ? 0 : pick(rng);
+
+    if (kind <= 3)
+    {
+        return std::string(1, alphabet[symbol(rng)]);
+    }
+    if (kind <= 5)
+    {
+        return randomPattern(rng, alphabet, depth - 1) + randomPattern(rng, alphabet, depth - 1);
+    }
+    if (kind <= 7)
+    {
+        return "(" + randomPattern(rng, alphabet, depth - 1) + "|" +
+               randomPattern(rng, alphabet, depth - 1) + ")";
+    }
+    static const char quantifiers[] = {'*', '+', '?'};
+    return "(" + randomPattern(rng, alphabet, depth - 1) + ")" + quantifiers[pick(rng) % 3];
+}
+
+// 生成随机输入字符串
+inline std::string randomInput(std::mt19937 &rng, const std::string &alphabet, size_t length)
+{
+    std::uniform_int_distribution<size_t> symbol(0, alphabet.size() - 1);
+    std::string input;
+    input.reserve(length);
+    for (size_t i = 0; i < length; i++)
+    {
+        input.push_back(alphabet[symbol(rng)]);
+    }
+    return input;
+}
+
+// 256个字节各重复一次组成的选择式 \x00\x00|\x01\x01|…|\xff\xff，字母和数字以外的字节都转义。
+// 每个字节的转换列各不相同，没有在所有状态下都转向死状态的字节，字节等价类正好占满256个
+inline std::string allBytePairsPattern()
+{
+    std::string pattern;
+    for (int b = 0; b < 256; b++)
+    {
+        std::string atom;
+        if (!std::isalnum(b))
+        {
+            atom.push_back('\\');
+        }
+        atom.push_back(static_cast<char>(b));
+        pattern += (b ? "|" : "") + atom + atom;
+    }
+    return pattern;
+}
+
+// allBytePairsPattern()应接受的全部字符串
+inline std::vector<std::string> allBytePairs()
+{
+    std::vector<std::string> pairs;
+    for (int b = 0; b < 256; b++)
+    {
+        pairs.push_back(std::string(2, static_cast<char>(b)));
+    }
+    return pairs;
+}
+
+#endif // BENCH_UTIL_H
@@ -0,0 +1,110 @@
+// 位并行NFA与DFA状态上限测试
+// 模式 (a|b)*a(a|b)...(a|b)（n个(a|b)）的最小DFA有 2^(n+1) 个状态，n较大时子集构造必然爆炸。
+// 对每个n报告Matcher选择的引擎、构造时间、内存和吞吐量；
+// n较小时同时构造不受限制的DFA，检查位并行NFA的结果与之一致。
+// 以-DREGEXP_ALLOC_STATS=ON构建并设置REGEXP_ALLOC_REPORT时，每个n之后输出内存分配统计，
+// 其中包括Matcher放弃子集构造之前的分配。
+//
+// 用法: bitnfa_bench [--count N] [--length N] [--seed N] [n ...]
+
+#include "bench_util.h"
+#include "bit_nfa.h"
+#include "dfa.h"
+#include "dfa_table.h"
+#include "matcher.h"
+#include "nfa.h"
+#include <cstdlib>
+#include <iostream>
+
+int main(int argc, char *argv[])
+{
+    size_t count = 20000;
+    size_t length = 64;
+    unsigned seed = 42;
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--count" && i + 1 < argc)
+            count = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--length" && i + 1 < argc)
+            length = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--seed" && i + 1 < argc)
+            seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        else
+            sizes.push_back(std::atoi(argv[i]));
+    }
+    if (sizes.empty())
+    {
+        sizes = {4, 8, 12, 16, 24, 40, 100};
+    }
+
+    std::mt19937 rng(seed);
+    std::vector<std::string> inputs;
+    size_t totalBytes = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        inputs.push_back(randomInput(rng, "ab", length));
+        totalBytes += length;
+    }
+    auto throughput = [&](auto &&match, size_t &accepted)
+    {
+        BenchTimer timer;
+        accepted = 0;
+        for (const auto &input : inputs)
+        {
+            accepted += match(input);
+        }
+        return (totalBytes / 1048576.0) / (timer.elapsedMs() / 1000.0);
+    };
+
+    int failures = 0;
+    for (int n : sizes)
+    {
+        std::string regex = "(a|b)*a";
+        for (int i = 0; i < n; i++)
+        {
+            regex += "(a|b)";
+        }
+
+        BenchTimer timer;
+        Matcher matcher(regex);
+        double compileMs = timer.elapsedMs();
+        size_t accepted = 0;
+        double matcherSpeed = throughput([&matcher](const std::string &s)
+                                         { return matcher.match(s); },
+                                         accepted);
+        std::cout << "n=" << n << ": " << matcher.getEngineName() << ", 构造 " << compileMs << " ms, 内存 "
+                  << matcher.memoryUsage() / 1024.0 << " KB, " << matcherSpeed << " MB/s";
+
+        NFABuilder nfaBuilder;
+        auto nfa = nfaBuilder.buildNFA(regex);
+        BitNFA bitNFA(nfa);
+        size_t bitAccepted = 0;
+        double bitSpeed = throughput([&bitNFA](const std::string &s)
+                                     { return bitNFA.match(s); },
+                                     bitAccepted);
+        std::cout << "; 位并行NFA " << bitNFA.getPositionCount() << " 个位置, " << bitSpeed << " MB/s";
+
+        // 不受限制的DFA只在状态数可以承受时构造
+        if (n <= 16)
+        {
+            DFABuilder dfaBuilder;
+            DFATable table(dfaBuilder.buildDFA(nfa));
+            size_t dfaAccepted = 0;
+            double dfaSpeed = throughput([&table](const std::string &s)
+                                         { return table.match(s); },
+                                         dfaAccepted);
+            std::cout << "; DFA " << table.getStateCount() << " 个状态, " << dfaSpeed << " MB/s";
+            for (const auto &input : inputs)
+            {
+                failures += bitNFA.match(input) != table.match(input);
+            }
+        }
+        failures += accepted != bitAccepted;
+        std::cout << "; 接受 " << accepted << "\n";
+        reportAllocations("n=" + std::to_string(n));
+    }
+    std::cout << "结果不一致: " << failures << "\n";
+    return failures == 0 ? 0 : 1;
+}
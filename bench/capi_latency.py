@@ -0,0 +1,82 @@
+"""比较界面两种转换方式的端到端延迟
+
+  动态库：通过ctypes在进程内调用regexp_compile，再生成状态转换表
+  子进程：每个正则表达式启动一次regexp_to_dfa，再解析其输出
+
+用法：python capi_latency.py [--bin 构建目录/bin] [--lines 500] [--seed 1] [--input 文件]
+两种方式的输出必须完全相同，否则以非零状态退出。
+"""
+import argparse
+import os
+import random
+import sys
+import time
+
+
+def random_pattern(rng, alphabet, depth):
+    # 与bench_util.h中randomPattern的文法和各分支概率相同
+    kind = 0 if depth <= 0 else rng.randrange(10)
+    if kind <= 3:
+        return rng.choice(alphabet)
+    if kind <= 5:
+        return random_pattern(rng, alphabet, depth - 1) + random_pattern(rng, alphabet, depth - 1)
+    if kind <= 7:
+        return '(' + random_pattern(rng, alphabet, depth - 1) + '|' + random_pattern(rng, alphabet, depth - 1) + ')'
+    return '(' + random_pattern(rng, alphabet, depth - 1) + ')' + rng.choice('*+?')
+
+
+def convert_all(converter, lines):
+    outputs = []
+    for line in lines:
+        try:
+            outputs.append(converter.convert(line))
+        except Exception as e:
+            outputs.append(('error', type(e).__name__))
+    return outputs
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--bin', default=os.path.dirname(os.path.abspath(__file__)),
+                        help='包含regexp_core.py、regexp动态库和regexp_to_dfa的目录')
+    parser.add_argument('--lines', type=int, default=500)
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--input', help='每行一个正则表达式的输入文件，缺省时随机生成')
+    args = parser.parse_args()
+
+    sys.path.insert(0, args.bin)
+    import regexp_core
+
+    if args.input:
+        with open(args.input, encoding='utf-8') as f:
+            lines = [line.strip() for line in f if line.strip()][:args.lines]
+    else:
+        rng = random.Random(args.seed)
+        lines = [random_pattern(rng, 'abcd', 4) for _ in range(args.lines)]
+
+    start = time.perf_counter()
+    compiler = regexp_core.Compiler(None)
+    load_ms = (time.perf_counter() - start) * 1000
+
+    start = time.perf_counter()
+    library_outputs = convert_all(compiler, lines)
+    library_ms = (time.perf_counter() - start) * 1000
+
+    name = 'regexp_to_dfa.exe' if sys.platform.startswith('win') else 'regexp_to_dfa'
+    subprocess_converter = regexp_core.SubprocessConverter(os.path.join(args.bin, name))
+    start = time.perf_counter()
+    subprocess_outputs = convert_all(subprocess_converter, lines)
+    subprocess_ms = (time.perf_counter() - start) * 1000
+
+    mismatches = sum(1 for a, b in zip(library_outputs, subprocess_outputs) if a != b)
+    print(f'{len(lines)} lines')
+    print(f'  library load : {load_ms:10.2f} ms')
+    print(f'  ctypes       : {library_ms:10.2f} ms  ({library_ms / len(lines):.3f} ms/line)')
+    print(f'  subprocess   : {subprocess_ms:10.2f} ms  ({subprocess_ms / len(lines):.3f} ms/line)')
+    print(f'  speedup      : {subprocess_ms / library_ms:10.1f}x')
+    print(f'  mismatches   : {mismatches}')
+    return 1 if mismatches else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
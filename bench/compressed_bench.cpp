@@ -0,0 +1,150 @@
+// 压缩转换表测试
+// 用随机关键词构造状态数很多的DFA，对比稠密表与压缩表的内存占用和匹配吞吐量，
+// 并检查两者以及Matcher对每个输入的结果一致。
+// 关键词的并直接构造成字典树形式的DFA：经过正则表达式和minimizeDFA构造
+// 数十万状态的DFA耗时过长，而两种转换表只关心DFA本身。
+// 另外用256个字节各重复一次的选择式检查字节等价类占满256个时的转换表：全部双字节串都应被接受。
+// 以-DREGEXP_ALLOC_STATS=ON构建并设置REGEXP_ALLOC_REPORT时，在构造两种转换表之后输出内存分配统计。
+//
+// 用法: compressed_bench [--words N] [--count N] [--seed N]
+
+#include "bench_util.h"
+#include "compressed_table.h"
+#include "dfa.h"
+#include "dfa_table.h"
+#include "matcher.h"
+#include "nfa.h"
+#include <cstdlib>
+#include <iostream>
+#include <map>
+
+int main(int argc, char *argv[])
+{
+    size_t wordCount = 50000;
+    size_t count = 1000000;
+    unsigned seed = 42;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--words" && i + 1 < argc)
+            wordCount = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--count" && i + 1 < argc)
+            count = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--seed" && i + 1 < argc)
+            seed = static_cast<unsigned>(std::atoi(argv[++i]));
+    }
+
+    // 关键词取自小写字母、数字和下划线，长度4到12
+    const std::string alphabet = "abcdefghijklmnopqrstuvwxyz0123456789_";
+    std::mt19937 rng(seed);
+    std::vector<std::string> words;
+    for (size_t i = 0; i < wordCount; i++)
+    {
+        words.push_back(randomInput(rng, alphabet, 4 + rng() % 9));
+    }
+
+    // 字典树的每个节点是一个DFA状态
+    BenchTimer timer;
+    auto dfa = std::make_shared<Graph>();
+    std::vector<std::map<char, int>> children(1);
+    dfa->setInitialState(0);
+    for (const auto &word : words)
+    {
+        int state = 0;
+        for (char c : word)
+        {
+            auto it = children[state].find(c);
+            if (it == children[state].end())
+            {
+                int next = static_cast<int>(children.size());
+                children.emplace_back();
+                children[state][c] = next;
+                dfa->addState(next);
+                dfa->addEdge(state, next, c);
+                state = next;
+            }
+            else
+            {
+                state = it->second;
+            }
+        }
+        dfa->addAcceptState(state);
+    }
+    double buildMs = timer.elapsedMs();
+
+    timer.reset();
+    DFATable dense(dfa);
+    double denseMs = timer.elapsedMs();
+    timer.reset();
+    CompressedDFATable compressed(dfa);
+    double compressedMs = timer.elapsedMs();
+    Matcher matcher(dfa);
+
+    std::cout << "关键词数: " << wordCount << ", DFA状态数: " << compressed.getStateCount()
+              << ", 等价类数: " << compressed.getClassCount() << ", 构造DFA " << buildMs << " ms\n";
+    std::cout << "稠密表: " << dense.memoryUsage() / 1024.0 << " KB, 构造 " << denseMs << " ms\n";
+    std::cout << "压缩表: " << compressed.memoryUsage() / 1024.0 << " KB, 构造 " << compressedMs << " ms, "
+              << (compressed.usesNarrowStates() ? "16" : "32") << "位状态号, 槽位 "
+              << compressed.getUsedSlotCount() << "/" << compressed.getSlotCount() << "\n";
+    std::cout << "压缩比: " << static_cast<double>(dense.memoryUsage()) / compressed.memoryUsage()
+              << ", Matcher选择 " << matcher.getEngineName() << "\n";
+    reportAllocations("构造");
+
+    // 一半输入是关键词，一半是随机字符串
+    std::vector<std::string> inputs;
+    inputs.reserve(count);
+    size_t totalBytes = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        inputs.push_back(i % 2 ? words[rng() % words.size()] : randomInput(rng, alphabet, 4 + rng() % 9));
+        totalBytes += inputs.back().size();
+    }
+
+    auto run = [&](const char *name, auto &&match)
+    {
+        BenchTimer runTimer;
+        size_t accepted = 0;
+        for (const auto &input : inputs)
+        {
+            accepted += match(input);
+        }
+        double ms = runTimer.elapsedMs();
+        std::cout << name << ": " << ms << " ms, " << (totalBytes / 1048576.0) / (ms / 1000.0)
+                  << " MB/s, 接受 " << accepted << "\n";
+        return accepted;
+    };
+    size_t denseAccepted = run("稠密表", [&dense](const std::string &s)
+                               { return dense.match(s); });
+    size_t compressedAccepted = run("压缩表", [&compressed](const std::string &s)
+                                    { return compressed.match(s); });
+    run("Matcher", [&matcher](const std::string &s)
+        { return matcher.match(s); });
+
+    size_t mismatches = 0;
+    for (const auto &input : inputs)
+    {
+        bool expected = dense.match(input);
+        mismatches += compressed.match(input) != expected || matcher.match(input) != expected;
+    }
+    std::cout << "结果不一致: " << mismatches << "\n";
+
+    // 字节等价类占满256个
+    NFABuilder nfaBuilder;
+    DFABuilder dfaBuilder;
+    auto fullRangeDFA = dfaBuilder.buildDFA(nfaBuilder.buildNFA(allBytePairsPattern()));
+    DFATable fullRange(fullRangeDFA);
+    CompressedDFATable fullRangeCompressed(fullRangeDFA);
+    Matcher fullRangeMatcher(allBytePairsPattern());
+    size_t fullRangeMismatches = 0;
+    for (const std::string &pair : allBytePairs())
+    {
+        fullRangeMismatches += !fullRange.match(pair) || fullRange.match(pair.substr(1));
+        fullRangeMismatches += !fullRangeCompressed.match(pair) || fullRangeCompressed.match(pair.substr(1));
+        fullRangeMismatches += !fullRangeMatcher.match(pair) || fullRangeMatcher.match(pair.substr(1));
+    }
+    std::cout << "256个字节等价类: 稠密表 " << fullRange.getClassCount() << " 类, 压缩表 "
+              << fullRangeCompressed.getClassCount() << " 类, Matcher选择 " << fullRangeMatcher.getEngineName()
+              << ", 不一致 " << fullRangeMismatches << "\n";
+    mismatches += fullRangeMismatches;
+    return mismatches == 0 && denseAccepted == compressedAccepted ? 0 : 1;
+}
@@ -0,0 +1,334 @@
+// 与std::regex的差分测试与性能对比
+// 在支持的语法（| * + ? 括号和转义）内随机生成正则表达式，对每个表达式生成输入
+// （一半由表达式生成，其中部分随机改动一个字节，另一半为随机串；或从语料文件中抽取），
+// 逐个比较最小化DFA与std::regex_match（ECMAScript）的接受结果，并报告两者的编译延迟和匹配吞吐量。
+//
+// 第i个表达式及其输入只由种子seed+i和生成参数决定，发现不一致时输出的参数
+// （--seed seed+i --patterns 1 及其余生成参数）即可单独复现该用例。
+//
+// std::regex以回溯实现，量词作用于可空的子表达式（如(a*)*）时可能不终止或栈溢出，
+// 生成时对可空的子表达式只使用'?'；输入也保持较短，避免回溯的指数代价。
+//
+// 以-DREGEXP_ALLOC_STATS=ON构建并设置REGEXP_ALLOC_REPORT时，最后输出全部模式的内存分配统计，
+// std::regex的分配没有阶段标记，记入"(未标记)"。
+//
+// 用法: differential_bench [--seed N] [--patterns N] [--inputs N] [--depth N]
+//                          [--max-length N] [--corpus FILE]
+
+#include "bench_util.h"
+#include "dfa.h"
+#include "dfa_table.h"
+#include "nfa.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <regex>
+
+namespace
+{
+    // 字面字符；未转义的'$'表示ε转换（std::regex中为行尾），不出现在表达式中
+    const std::string LITERALS = "abc";
+    // 需要转义的字符，两种语法中的含义相同
+    const std::string ESCAPED = "*+?|().\\$";
+    // 输入字母表
+    const std::string INPUT_ALPHABET = "abcabcabc*+?|().\\$d";
+
+    // 表达式的语法树，用于生成表达式文本和能被它匹配的样例输入
+    struct PatternNode
+    {
+        char op;      // 0 字面字符, '.' 连接, '|' 选择, '*' '+' '?' 量词
+        char literal; // op为0时的字符
+        bool escaped; // 字面字符是否需要转义
+        bool nullable; // 能否匹配空串
+        std::vector<PatternNode> children;
+    };
+
+    PatternNode generatePattern(std::mt19937 &rng, int depth)
+    {
+        int kind = depth <= 0 ? 0 : static_cast<int>(rng() % 10);
+        PatternNode node{0, 0, false, false, {}};
+        if (kind <= 3)
+        {
+            node.escaped = rng() % 8 == 0;
+            node.literal = node.escaped ? ESCAPED[rng() % ESCAPED.size()] : LITERALS[rng() % LITERALS.size()];
+            return node;
+        }
+        node.children.push_back(generatePattern(rng, depth - 1));
+        if (kind <= 7)
+        {
+            node.op = kind <= 5 ? '.' : '|';
+            node.children.push_back(generatePattern(rng, depth - 1));
+            bool left = node.children[0].nullable, right = node.children[1].nullable;
+            node.nullable = node.op == '.' ? left && right : left || right;
+            return node;
+        }
+        // 可空的子表达式只加'?'，不重复
+        node.op = node.children[0].nullable ? '?' : "*+?"[rng() % 3];
+        node.nullable = node.op != '+' || node.children[0].nullable;
+        return node;
+    }
+
+    std::string renderPattern(const PatternNode &node)
+    {
+        switch (node.op)
+        {
+        case 0:
+            return node.escaped ? std::string("\\") + node.literal : std::string(1, node.literal);
+        case '.':
+            return renderPattern(node.children[0]) + renderPattern(node.children[1]);
+        case '|':
+            return "(" + renderPattern(node.children[0]) + "|" + renderPattern(node.children[1]) + ")";
+        default:
+            return "(" + renderPattern(node.children[0]) + ")" + node.op;
+        }
+    }
+
+    // 随机生成一个能被node匹配的串
+    void samplePattern(std::mt19937 &rng, const PatternNode &node, std::string &out)
+    {
+        switch (node.op)
+        {
+        case 0:
+            out.push_back(node.literal);
+            break;
+        case '.':
+            samplePattern(rng, node.children[0], out);
+            samplePattern(rng, node.children[1], out);
+            break;
+        case '|':
+            samplePattern(rng, node.children[rng() % 2], out);
+            break;
+        default:
+        {
+            int low = node.op == '+' ? 1 : 0;
+            int high = node.op == '?' ? 1 : 3;
+            for (int count = low + static_cast<int>(rng() % (high - low + 1)); count > 0; count--)
+            {
+                samplePattern(rng, node.children[0], out);
+            }
+            break;
+        }
+        }
+    }
+
+    // 不可打印的字节和反斜杠转义后输出，便于复制复现
+    std::string printable(const std::string &text)
+    {
+        static const char hex[] = "0123456789abcdef";
+        std::string out;
+        for (unsigned char c : text)
+        {
+            if (c == '\\')
+                out += "\\\\";
+            else if (c < 0x20 || c >= 0x7f)
+                out += std::string("\\x") + hex[c >> 4] + hex[c & 0xf];
+            else
+                out += static_cast<char>(c);
+        }
+        return out;
+    }
+
+    struct Case
+    {
+        unsigned seed;
+        std::string pattern;
+        std::vector<std::string> inputs;
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned seed = 42;
+    size_t patternCount = 500;
+    size_t inputCount = 200;
+    int depth = 5;
+    size_t maxLength = 24;
+    std::string corpusPath;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc)
+            seed = static_cast<unsigned>(std::atoll(argv[++i]));
+        else if (arg == "--patterns" && i + 1 < argc)
+            patternCount = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--inputs" && i + 1 < argc)
+            inputCount = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--depth" && i + 1 < argc)
+            depth = std::atoi(argv[++i]);
+        else if (arg == "--max-length" && i + 1 < argc)
+            maxLength = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--corpus" && i + 1 < argc)
+            corpusPath = argv[++i];
+    }
+
+    // 语料中的行截断到maxLength
+    std::vector<std::string> corpus;
+    if (!corpusPath.empty())
+    {
+        corpus = loadLines(corpusPath);
+        if (corpus.empty())
+        {
+            std::cerr << "Error: 语料文件为空或无法读取: " << corpusPath << std::endl;
+            return 1;
+        }
+        for (auto &line : corpus)
+        {
+            line.resize(std::min(line.size(), maxLength));
+        }
+    }
+
+    // 复现单个用例所需的参数
+    auto reproduce = [&](unsigned caseSeed)
+    {
+        return "--seed " + std::to_string(caseSeed) + " --patterns 1 --inputs " + std::to_string(inputCount) +
+               " --depth " + std::to_string(depth) + " --max-length " + std::to_string(maxLength) +
+               (corpusPath.empty() ? "" : " --corpus " + corpusPath);
+    };
+
+    std::vector<Case> cases;
+    for (size_t i = 0; i < patternCount; i++)
+    {
+        Case c;
+        c.seed = seed + static_cast<unsigned>(i);
+        std::mt19937 rng(c.seed);
+        PatternNode root = generatePattern(rng, depth);
+        c.pattern = renderPattern(root);
+        for (size_t k = 0; k < inputCount; k++)
+        {
+            if (!corpus.empty())
+            {
+                c.inputs.push_back(corpus[rng() % corpus.size()]);
+                continue;
+            }
+            // 一半输入由表达式本身生成，其中一部分再随机改动一个字节；另一半为随机串
+            std::string input;
+            if (k % 2 == 0)
+            {
+                samplePattern(rng, root, input);
+                if (!input.empty() && rng() % 4 == 0)
+                {
+                    input[rng() % input.size()] = INPUT_ALPHABET[rng() % INPUT_ALPHABET.size()];
+                }
+                input.resize(std::min(input.size(), maxLength));
+            }
+            else
+            {
+                input = randomInput(rng, INPUT_ALPHABET, rng() % (maxLength + 1));
+            }
+            c.inputs.push_back(std::move(input));
+        }
+        cases.push_back(std::move(c));
+    }
+
+    double dfaCompileMs = 0, regexCompileMs = 0, dfaMatchMs = 0, regexMatchMs = 0;
+    double dfaCompileMax = 0, regexCompileMax = 0;
+    size_t totalBytes = 0, totalInputs = 0, dfaAccepted = 0, regexAccepted = 0;
+    size_t mismatches = 0, skipped = 0;
+    const size_t reportLimit = 10;
+    // 少数模式会让std::regex回溯的代价急剧上升，总吞吐量被它们主导，因此另外给出逐模式加速比的中位数
+    std::vector<double> speedups;
+    double slowestMs = 0;
+    unsigned slowestSeed = 0;
+    std::string slowestPattern;
+    for (const Case &c : cases)
+    {
+        BenchTimer timer;
+        NFABuilder nfaBuilder;
+        DFABuilder dfaBuilder;
+        DFATable table(dfaBuilder.minimizeDFA(dfaBuilder.buildDFA(nfaBuilder.buildNFA(c.pattern))));
+        double dfaMs = timer.elapsedMs();
+
+        std::regex regex;
+        timer.reset();
+        try
+        {
+            regex.assign(c.pattern, std::regex::ECMAScript);
+        }
+        catch (const std::regex_error &e)
+        {
+            std::cout << "跳过 " << reproduce(c.seed) << ": std::regex无法编译 " << printable(c.pattern) << " (" << e.what()
+                      << ")\n";
+            skipped++;
+            continue;
+        }
+        double regexMs = timer.elapsedMs();
+        dfaCompileMs += dfaMs;
+        regexCompileMs += regexMs;
+        dfaCompileMax = std::max(dfaCompileMax, dfaMs);
+        regexCompileMax = std::max(regexCompileMax, regexMs);
+
+        // 先分别计时，再逐个比较结果
+        std::vector<char> dfaResults(c.inputs.size()), regexResults(c.inputs.size());
+        timer.reset();
+        for (size_t k = 0; k < c.inputs.size(); k++)
+        {
+            dfaResults[k] = table.match(c.inputs[k]);
+        }
+        double dfaCaseMs = timer.elapsedMs();
+        dfaMatchMs += dfaCaseMs;
+        timer.reset();
+        try
+        {
+            for (size_t k = 0; k < c.inputs.size(); k++)
+            {
+                regexResults[k] = std::regex_match(c.inputs[k], regex);
+            }
+        }
+        catch (const std::regex_error &e)
+        {
+            std::cout << "跳过 " << reproduce(c.seed) << ": std::regex匹配失败 " << printable(c.pattern) << " (" << e.what()
+                      << ")\n";
+            skipped++;
+            continue;
+        }
+        double regexCaseMs = timer.elapsedMs();
+        regexMatchMs += regexCaseMs;
+        speedups.push_back(regexCaseMs / std::max(dfaCaseMs, 1e-6));
+        if (regexCaseMs > slowestMs)
+        {
+            slowestMs = regexCaseMs;
+            slowestSeed = c.seed;
+            slowestPattern = c.pattern;
+        }
+
+        for (size_t k = 0; k < c.inputs.size(); k++)
+        {
+            totalBytes += c.inputs[k].size();
+            dfaAccepted += dfaResults[k];
+            regexAccepted += regexResults[k];
+            if (dfaResults[k] != regexResults[k])
+            {
+                if (mismatches < reportLimit)
+                {
+                    std::cout << "不一致 " << reproduce(c.seed) << ": 模式 \"" << printable(c.pattern)
+                              << "\" 输入 \"" << printable(c.inputs[k]) << "\" DFA " << (dfaResults[k] ? "接受" : "拒绝")
+                              << ", std::regex " << (regexResults[k] ? "接受" : "拒绝") << "\n";
+                }
+                mismatches++;
+            }
+        }
+        totalInputs += c.inputs.size();
+    }
+
+    size_t compiled = cases.size() - skipped;
+    double medianSpeedup = 0;
+    if (!speedups.empty())
+    {
+        std::nth_element(speedups.begin(), speedups.begin() + speedups.size() / 2, speedups.end());
+        medianSpeedup = speedups[speedups.size() / 2];
+    }
+    double mb = totalBytes / 1048576.0;
+    std::cout << "种子 " << seed << ", 模式 " << compiled << " 个（跳过 " << skipped << "）, 输入 " << totalInputs
+              << " 个, 共 " << mb << " MB" << (corpus.empty() ? "" : "（来自语料）") << "\n"
+              << "编译延迟: DFA 平均 " << (compiled ? dfaCompileMs / compiled : 0) << " ms, 最长 " << dfaCompileMax
+              << " ms; std::regex 平均 " << (compiled ? regexCompileMs / compiled : 0) << " ms, 最长 "
+              << regexCompileMax << " ms\n"
+              << "匹配吞吐量: DFA " << mb / (dfaMatchMs / 1000.0) << " MB/s, std::regex "
+              << mb / (regexMatchMs / 1000.0) << " MB/s, 加速 " << regexMatchMs / dfaMatchMs << "x, 逐模式加速中位数 "
+              << medianSpeedup << "x\n"
+              << "std::regex最慢的模式 " << reproduce(slowestSeed) << ": \"" << printable(slowestPattern)
+              << "\" " << slowestMs << " ms\n"
+              << "接受: DFA " << dfaAccepted << ", std::regex " << regexAccepted << ", 不一致 " << mismatches << "\n";
+    reportAllocations("全部模式");
+    return mismatches == 0 ? 0 : 1;
+}
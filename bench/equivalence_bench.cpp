@@ -0,0 +1,174 @@
+// 等价判定测试
+// 随机生成正则表达式对，一部分由代数恒等式改写得到（X+ 与 XX*、(X*)* 与 X*、X|Y 与 Y|X 等），
+// 保证有足够多的等价对。对每一对：
+//   - areEquivalent的结果与乘积自动机的判定（两个方向的isSubsetOf都成立，即两个差集为空）一致
+//   - 不等价时给出的区分字符串恰好被其中一侧接受
+//   - 直接在NFA上判定的结果与在DFA转换表上判定的结果一致
+// 并报告两种判定方式的时间。最后把全部表达式交给groupEquivalentPatterns，
+// 检查同组的表达式两两等价、不同组的组代表两两不等价。
+// 以-DREGEXP_ALLOC_STATS=ON构建并设置REGEXP_ALLOC_REPORT时，逐对判定与分组之后各输出一次内存分配统计。
+//
+// 用法: equivalence_bench [--pairs N] [--depth N] [--seed N]
+
+#include "bench_util.h"
+#include "dfa.h"
+#include "dfa_table.h"
+#include "equivalence.h"
+#include "nfa.h"
+#include "product.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+    const std::string ALPHABET = "ab";
+
+    // 按恒等式由pattern和另一个随机表达式other构造一对等价的表达式
+    std::pair<std::string, std::string> equivalentPair(std::mt19937 &rng, const std::string &pattern,
+                                                       const std::string &other)
+    {
+        const std::string x = "(" + pattern + ")";
+        const std::string y = "(" + other + ")";
+        switch (rng() % 5)
+        {
+        case 0:
+            return {x + "+", x + x + "*"};
+        case 1:
+            return {x + "*", "(" + x + "*)*"};
+        case 2:
+            return {"(" + x + "|" + y + ")", "(" + y + "|" + x + ")"};
+        case 3:
+            return {pattern, "(" + x + "|" + x + ")"};
+        default:
+            return {x + "*", x + "*" + x + "*"};
+        }
+    }
+
+    DFATable compileTable(const std::string &pattern)
+    {
+        NFABuilder nfaBuilder;
+        DFABuilder dfaBuilder;
+        return DFATable(dfaBuilder.buildDFA(nfaBuilder.buildNFA(pattern)));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t pairCount = 2000;
+    int depth = 4;
+    unsigned seed = 42;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--pairs" && i + 1 < argc)
+            pairCount = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--depth" && i + 1 < argc)
+            depth = std::atoi(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc)
+            seed = static_cast<unsigned>(std::atoi(argv[++i]));
+    }
+
+    std::mt19937 rng(seed);
+    std::vector<std::pair<std::string, std::string>> pairs;
+    for (size_t i = 0; i < pairCount; i++)
+    {
+        std::string pattern = randomPattern(rng, ALPHABET, depth);
+        std::string other = randomPattern(rng, ALPHABET, depth);
+        if (i % 2 == 0)
+        {
+            pairs.push_back(equivalentPair(rng, pattern, other));
+        }
+        else
+        {
+            pairs.emplace_back(pattern, other);
+        }
+    }
+
+    size_t equivalent = 0, mismatches = 0, badWitnesses = 0, nfaMismatches = 0;
+    double equivalenceMs = 0, productMs = 0, nfaMs = 0;
+    const size_t reportLimit = 10;
+    size_t reported = 0;
+    for (const auto &pair : pairs)
+    {
+        DFATable a = compileTable(pair.first);
+        DFATable b = compileTable(pair.second);
+
+        std::string witness;
+        BenchTimer timer;
+        bool same = areEquivalent(a, b, &witness);
+        equivalenceMs += timer.elapsedMs();
+
+        // 乘积自动机：L(a) ⊆ L(b) 且 L(b) ⊆ L(a)，即 a-b 与 b-a 都为空
+        timer.reset();
+        bool productSame = isSubsetOf(a, b) && isSubsetOf(b, a);
+        productMs += timer.elapsedMs();
+
+        NFABuilder nfaBuilder;
+        auto nfaA = nfaBuilder.buildNFA(pair.first);
+        auto nfaB = nfaBuilder.buildNFA(pair.second);
+        timer.reset();
+        bool nfaSame = areEquivalent(nfaA, nfaB);
+        nfaMs += timer.elapsedMs();
+
+        equivalent += same;
+        bool mismatch = same != productSame;
+        bool badWitness = !same && a.match(witness) == b.match(witness);
+        mismatches += mismatch;
+        badWitnesses += badWitness;
+        nfaMismatches += nfaSame != same;
+        if ((mismatch || badWitness || nfaSame != same) && reported++ < reportLimit)
+        {
+            std::cout << "不一致: \"" << pair.first << "\" 与 \"" << pair.second << "\" areEquivalent "
+                      << (same ? "等价" : "不等价") << ", 乘积 " << (productSame ? "等价" : "不等价") << ", NFA "
+                      << (nfaSame ? "等价" : "不等价");
+            if (!same)
+            {
+                std::cout << ", 区分字符串 \"" << witness << "\"";
+            }
+            std::cout << "\n";
+        }
+    }
+
+    std::cout << "种子 " << seed << ", 表达式对 " << pairs.size() << ", 等价 " << equivalent << "\n"
+              << "判定时间: areEquivalent " << equivalenceMs << " ms, 乘积自动机 " << productMs
+              << " ms, NFA上直接判定 " << nfaMs << " ms\n";
+    reportAllocations("逐对判定");
+
+    // 分组：同组两两等价，各组代表两两不等价
+    std::vector<std::string> patterns;
+    for (const auto &pair : pairs)
+    {
+        patterns.push_back(pair.first);
+        patterns.push_back(pair.second);
+    }
+    patterns.resize(std::min<size_t>(patterns.size(), 400));
+    std::vector<DFATable> tables;
+    for (const auto &pattern : patterns)
+    {
+        tables.push_back(compileTable(pattern));
+    }
+    BenchTimer timer;
+    auto groups = groupEquivalentPatterns(patterns);
+    double groupMs = timer.elapsedMs();
+    size_t groupErrors = 0, grouped = 0;
+    for (size_t g = 0; g < groups.size(); g++)
+    {
+        grouped += groups[g].size();
+        for (size_t k = 1; k < groups[g].size(); k++)
+        {
+            groupErrors += !areEquivalent(tables[groups[g][0]], tables[groups[g][k]]);
+        }
+        for (size_t h = g + 1; h < groups.size(); h++)
+        {
+            groupErrors += areEquivalent(tables[groups[g][0]], tables[groups[h][0]]);
+        }
+    }
+    groupErrors += grouped != patterns.size();
+    std::cout << "分组: " << patterns.size() << " 个表达式分为 " << groups.size() << " 组, " << groupMs
+              << " ms, 错误 " << groupErrors << "\n";
+    reportAllocations("分组");
+    std::cout << "不一致: 与乘积 " << mismatches << ", 区分字符串无效 " << badWitnesses << ", NFA " << nfaMismatches
+              << "\n";
+    return mismatches == 0 && badWitnesses == 0 && nfaMismatches == 0 && groupErrors == 0 ? 0 : 1;
+}
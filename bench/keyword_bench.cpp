@@ -0,0 +1,199 @@
+// 关键词表测试
+// 对1k、10k、100k、1M个随机关键词组成的字面选择式（k1|k2|...）报告：
+//   - 字典树：识别并解析选择式、构造字典树与失败链接的时间和内存
+//   - Graph：NFABuilder::buildNFA（自动走字典树）与DFATable的构造时间
+//   - 搜索：字典树沿失败链接搜索与展开后的非锚定DFATable的吞吐量，并核对两者的匹配位置
+//   - 对照：整个选择式加一层括号后不再被识别，按Thompson构造逐对合并并做子集构造
+// Graph、搜索表和Thompson对照只在关键词数不超过各自的上限时运行，超过时输出跳过的原因：
+// 默认上限下1M个关键词不运行Graph与搜索表（字典树约480万个状态，
+// std::map存储的图与展开的转换表需要数GB内存），Thompson对照只运行1k。
+// 最后用256个字节各重复一次的关键词检查字节等价类占满256个时的两种转换表。
+// 以-DREGEXP_ALLOC_STATS=ON构建并设置REGEXP_ALLOC_REPORT时，每一项之后输出内存分配统计。
+//
+// 用法: keyword_bench [--sizes N,N,...] [--graph-max N] [--table-max N] [--baseline-max N] [--seed N]
+
+#include "bench_util.h"
+#include "dfa.h"
+#include "dfa_table.h"
+#include "keyword_trie.h"
+#include "nfa.h"
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+    std::vector<size_t> parseSizes(const std::string &text)
+    {
+        std::vector<size_t> sizes;
+        std::stringstream in(text);
+        std::string item;
+        while (std::getline(in, item, ','))
+        {
+            sizes.push_back(static_cast<size_t>(std::atoll(item.c_str())));
+        }
+        return sizes;
+    }
+
+    // 非锚定DFA扫描，每次接受后回到初始状态，与KeywordTrie::findAll的结束位置相同
+    std::vector<size_t> scanEnds(const DFATable &table, const std::string &text)
+    {
+        std::vector<size_t> ends;
+        int state = table.getInitialState();
+        for (size_t i = 0; i < text.size(); i++)
+        {
+            state = table.getNextState(state, static_cast<unsigned char>(text[i]));
+            if (table.isAccept(state))
+            {
+                ends.push_back(i + 1);
+                state = table.getInitialState();
+            }
+        }
+        return ends;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<size_t> sizes = {1000, 10000, 100000, 1000000};
+    size_t graphMax = 100000;
+    size_t tableMax = 100000;
+    size_t baselineMax = 1000;
+    unsigned seed = 42;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--sizes" && i + 1 < argc)
+            sizes = parseSizes(argv[++i]);
+        else if (arg == "--graph-max" && i + 1 < argc)
+            graphMax = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--table-max" && i + 1 < argc)
+            tableMax = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--baseline-max" && i + 1 < argc)
+            baselineMax = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--seed" && i + 1 < argc)
+            seed = static_cast<unsigned>(std::atoi(argv[++i]));
+    }
+
+    const std::string alphabet = "abcdefghijklmnopqrstuvwxyz0123456789_";
+    std::mt19937 rng(seed);
+    size_t mismatches = 0;
+    for (size_t size : sizes)
+    {
+        std::vector<std::string> words;
+        std::string regex;
+        for (size_t i = 0; i < size; i++)
+        {
+            words.push_back(randomInput(rng, alphabet, 4 + rng() % 9));
+            regex += (i ? "|" : "") + words.back();
+        }
+
+        // 文本由随机字符与穿插其中的关键词组成
+        std::string text;
+        while (text.size() < (8u << 20))
+        {
+            text += rng() % 4 ? randomInput(rng, alphabet + " ", 1 + rng() % 16) : words[rng() % size];
+        }
+        double textMb = text.size() / 1048576.0;
+
+        std::cout << "关键词数 " << size << ", 选择式 " << regex.size() / 1048576.0 << " MB\n";
+
+        BenchTimer timer;
+        std::vector<std::string> parsed;
+        KeywordTrie::parseAlternation(regex, parsed);
+        KeywordTrie trie(std::move(parsed));
+        double trieMs = timer.elapsedMs();
+        std::cout << "  字典树: 构造 " << trieMs << " ms, " << trie.getNodeCount() << " 结点, "
+                  << trie.memoryUsage() / 1048576.0 << " MB\n";
+
+        timer.reset();
+        std::vector<MatchSpan> found = trie.findAll(text.data(), text.size());
+        double findMs = timer.elapsedMs();
+        std::cout << "  失败链接搜索: " << textMb / (findMs / 1000.0) << " MB/s, 匹配 " << found.size() << "\n";
+        reportAllocations("字典树");
+
+        if (size <= graphMax)
+        {
+            NFABuilder nfaBuilder;
+            timer.reset();
+            auto nfa = nfaBuilder.buildNFA(regex);
+            double nfaMs = timer.elapsedMs();
+            timer.reset();
+            DFATable table(nfa);
+            double tableMs = timer.elapsedMs();
+            std::cout << "  Graph: buildNFA " << nfaMs << " ms, " << nfa->getAllStates().size() << " 状态; DFATable "
+                      << tableMs << " ms, " << table.memoryUsage() / 1048576.0 << " MB\n";
+            for (size_t i = 0; i < 1000; i++)
+            {
+                const std::string &word = words[rng() % size];
+                std::string other = randomInput(rng, alphabet, 4 + rng() % 9);
+                mismatches += !table.match(word) || !trie.contains(word.data(), word.size());
+                mismatches += table.match(other) != trie.contains(other.data(), other.size());
+            }
+            reportAllocations("Graph");
+        }
+        else
+        {
+            std::cout << "  Graph: 跳过, 关键词数超过 --graph-max " << graphMax << "\n";
+        }
+
+        if (size <= tableMax)
+        {
+            timer.reset();
+            DFATable search = trie.toSearchTable();
+            double searchBuildMs = timer.elapsedMs();
+            timer.reset();
+            std::vector<size_t> ends = scanEnds(search, text);
+            double scanMs = timer.elapsedMs();
+            size_t differ = ends.size() != found.size();
+            for (size_t i = 0; i < ends.size() && i < found.size(); i++)
+            {
+                differ += ends[i] != found[i].end;
+            }
+            mismatches += differ;
+            std::cout << "  非锚定DFATable: 展开 " << searchBuildMs << " ms, " << search.memoryUsage() / 1048576.0
+                      << " MB, " << textMb / (scanMs / 1000.0) << " MB/s, 位置不一致 " << differ << "\n";
+            reportAllocations("非锚定DFATable");
+        }
+        else
+        {
+            std::cout << "  非锚定DFATable: 跳过, 关键词数超过 --table-max " << tableMax << "\n";
+        }
+
+        if (size <= baselineMax)
+        {
+            NFABuilder nfaBuilder;
+            DFABuilder dfaBuilder;
+            timer.reset();
+            auto nfa = nfaBuilder.buildNFA("(" + regex + ")");
+            double nfaMs = timer.elapsedMs();
+            timer.reset();
+            auto dfa = dfaBuilder.buildDFA(nfa);
+            double dfaMs = timer.elapsedMs();
+            std::cout << "  Thompson对照: buildNFA " << nfaMs << " ms, " << nfa->getAllStates().size()
+                      << " 状态; buildDFA " << dfaMs << " ms, " << dfa->getAllStates().size() << " 状态\n";
+            reportAllocations("Thompson对照");
+        }
+        else
+        {
+            std::cout << "  Thompson对照: 跳过, 关键词数超过 --baseline-max " << baselineMax << "\n";
+        }
+    }
+
+    // 关键词用到全部256个字节时等价类从0编号，不保留死的等价类0
+    KeywordTrie fullRange(allBytePairs());
+    DFATable fullRangeTable = fullRange.toTable();
+    DFATable fullRangeSearch = fullRange.toSearchTable();
+    size_t fullRangeMismatches = 0;
+    for (const std::string &pair : allBytePairs())
+    {
+        fullRangeMismatches += !fullRangeTable.match(pair) || fullRangeTable.match(pair.substr(1));
+        fullRangeMismatches += !fullRangeSearch.match("x" + pair) || fullRangeSearch.match(pair.substr(1));
+    }
+    std::cout << "256个字节等价类: 锚定表 " << fullRangeTable.getClassCount() << " 类, 搜索表 "
+              << fullRangeSearch.getClassCount() << " 类, 不一致 " << fullRangeMismatches << "\n";
+    mismatches += fullRangeMismatches;
+
+    std::cout << "结果不一致: " << mismatches << "\n";
+    return mismatches == 0 ? 0 : 1;
+}
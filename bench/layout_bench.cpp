@@ -0,0 +1,276 @@
+// 状态布局测试
+// 用随机关键词构造大的字典树DFA，状态编号随机打乱，模拟minimizeDFA按划分顺序编号、
+// 与访问模式无关的情况。输入按Zipf分布抽取关键词，少数关键词占大部分访问。
+// 对原始编号、广度优先布局和按样本访问统计的布局分别报告：
+//   - 访问跨度：稠密表中覆盖90%查表次数的缓存行数与4KB页数
+//   - 模拟缓存缺失：按稠密表实际查表地址模拟32KB/8路和1MB/16路的LRU组相联缓存，每KB输入的缺失数
+//   - 稠密表与压缩表的匹配吞吐量（三次中最快的一次）
+// 访问统计取自独立的样本输入，测量使用另一组输入。并检查重新编号前后的结果一致。
+// 以-DREGEXP_ALLOC_STATS=ON构建并设置REGEXP_ALLOC_REPORT时，构造转换表和每种布局之后输出内存分配统计。
+//
+// 用法: layout_bench [--words N] [--count N] [--zipf S] [--seed N]
+
+#include "bench_util.h"
+#include "compressed_table.h"
+#include "dfa_table.h"
+#include "layout.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <unordered_map>
+
+namespace
+{
+    const size_t CACHE_LINE = 64;
+    const size_t PAGE_SIZE = 4096;
+
+    // LRU组相联缓存模拟
+    class CacheModel
+    {
+    public:
+        CacheModel(size_t bytes, size_t ways)
+            : ways(ways), sets(bytes / CACHE_LINE / ways), tags(sets * ways, UINT64_MAX), misses(0) {}
+
+        void access(uint64_t line)
+        {
+            uint64_t *set = &tags[(line % sets) * ways];
+            for (size_t w = 0; w < ways; w++)
+            {
+                if (set[w] == line)
+                {
+                    // 命中的行移到最前
+                    std::rotate(set, set + w, set + w + 1);
+                    return;
+                }
+            }
+            misses++;
+            std::rotate(set, set + ways - 1, set + ways);
+            set[0] = line;
+        }
+
+        size_t getMisses() const { return misses; }
+
+    private:
+        size_t ways;
+        size_t sets;
+        std::vector<uint64_t> tags;
+        size_t misses;
+    };
+
+    // 按访问次数从多到少取单元（缓存行或页），覆盖fraction访问次数所需的单元数
+    size_t coverage(const std::unordered_map<uint64_t, uint64_t> &unitVisits, double fraction)
+    {
+        std::vector<uint64_t> counts;
+        uint64_t total = 0;
+        for (const auto &item : unitVisits)
+        {
+            counts.push_back(item.second);
+            total += item.second;
+        }
+        std::sort(counts.rbegin(), counts.rend());
+        uint64_t covered = 0;
+        size_t units = 0;
+        while (units < counts.size() && covered < fraction * total)
+        {
+            covered += counts[units++];
+        }
+        return units;
+    }
+
+    // 对比吞吐量时取多次运行中最快的一次
+    const int REPEAT = 3;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t wordCount = 50000;
+    size_t count = 1000000;
+    double zipf = 1.0;
+    unsigned seed = 42;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--words" && i + 1 < argc)
+            wordCount = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--count" && i + 1 < argc)
+            count = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--zipf" && i + 1 < argc)
+            zipf = std::atof(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc)
+            seed = static_cast<unsigned>(std::atoi(argv[++i]));
+    }
+
+    const std::string alphabet = "abcdefghijklmnopqrstuvwxyz0123456789_";
+    std::mt19937 rng(seed);
+    std::vector<std::string> words;
+    for (size_t i = 0; i < wordCount; i++)
+    {
+        words.push_back(randomInput(rng, alphabet, 4 + rng() % 9));
+    }
+
+    // 先建字典树，再以随机的标签加入图中，DFATable按标签顺序编号
+    std::vector<std::map<char, int>> children(1);
+    std::vector<int> acceptNodes;
+    for (const auto &word : words)
+    {
+        int node = 0;
+        for (char c : word)
+        {
+            auto it = children[node].find(c);
+            if (it == children[node].end())
+            {
+                int next = static_cast<int>(children.size());
+                children.emplace_back();
+                children[node][c] = next;
+                node = next;
+            }
+            else
+            {
+                node = it->second;
+            }
+        }
+        acceptNodes.push_back(node);
+    }
+    std::vector<int> label(children.size());
+    std::iota(label.begin(), label.end(), 0);
+    std::shuffle(label.begin(), label.end(), rng);
+    auto dfa = std::make_shared<Graph>();
+    dfa->setInitialState(label[0]);
+    for (size_t node = 0; node < children.size(); node++)
+    {
+        dfa->addState(label[node]);
+        for (const auto &child : children[node])
+        {
+            dfa->addEdge(label[node], label[child.second], child.first);
+        }
+    }
+    for (int node : acceptNodes)
+    {
+        dfa->addAcceptState(label[node]);
+    }
+
+    DFATable original(dfa);
+    CompressedDFATable compressed(original);
+    std::cout << "关键词数: " << wordCount << ", DFA状态数: " << original.getStateCount()
+              << ", 等价类数: " << original.getClassCount() << ", 稠密表 " << original.memoryUsage() / 1048576.0
+              << " MB, 压缩表 " << compressed.memoryUsage() / 1048576.0 << " MB\n";
+    reportAllocations("转换表");
+
+    // 四分之三的输入按Zipf分布抽取关键词，其余为随机字符串
+    std::vector<double> weights(wordCount);
+    for (size_t i = 0; i < wordCount; i++)
+    {
+        weights[i] = 1.0 / std::pow(static_cast<double>(i + 1), zipf);
+    }
+    std::discrete_distribution<size_t> pickWord(weights.begin(), weights.end());
+    auto makeInputs = [&](size_t n, size_t &bytes)
+    {
+        std::vector<std::string> inputs;
+        inputs.reserve(n);
+        bytes = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            inputs.push_back(i % 4 ? words[pickWord(rng)] : randomInput(rng, alphabet, 4 + rng() % 9));
+            bytes += inputs.back().size();
+        }
+        return inputs;
+    };
+    size_t sampleBytes, totalBytes;
+    std::vector<std::string> sample = makeInputs(count / 10, sampleBytes);
+    std::vector<std::string> inputs = makeInputs(count, totalBytes);
+
+    // 在样本输入上收集访问统计
+    BenchTimer timer;
+    std::vector<uint64_t> sampleVisits;
+    for (const auto &input : sample)
+    {
+        original.matchProfiled(input.data(), input.size(), sampleVisits);
+    }
+    double profileMs = timer.elapsedMs();
+    std::cout << "样本输入 " << sample.size() << " 个，统计访问 " << profileMs << " ms\n\n";
+
+    auto report = [&](const char *name, const DFATable &table, const CompressedDFATable &packed, double layoutMs)
+    {
+        // 按稠密表实际读取的表项地址模拟缓存，同时统计每个缓存行和页的访问次数
+        CacheModel l1(32 << 10, 8), l2(1 << 20, 16);
+        std::unordered_map<uint64_t, uint64_t> lineVisits, pageVisits;
+        const std::vector<int> &transitions = table.getTransitions();
+        const size_t classCount = table.getClassCount();
+        for (const auto &input : inputs)
+        {
+            int state = table.getInitialState();
+            for (char c : input)
+            {
+                size_t index = state * classCount + table.getByteClass(static_cast<unsigned char>(c));
+                uint64_t line = index * sizeof(int) / CACHE_LINE;
+                l1.access(line);
+                l2.access(line);
+                lineVisits[line]++;
+                pageVisits[index * sizeof(int) / PAGE_SIZE]++;
+                state = transitions[index];
+                if (state == table.getDeadState())
+                    break;
+            }
+        }
+
+        auto throughput = [&](auto &&match, size_t &accepted)
+        {
+            double best = 0;
+            for (int r = 0; r < REPEAT; r++)
+            {
+                BenchTimer runTimer;
+                accepted = 0;
+                for (const auto &input : inputs)
+                {
+                    accepted += match(input);
+                }
+                best = std::max(best, (totalBytes / 1048576.0) / (runTimer.elapsedMs() / 1000.0));
+            }
+            return best;
+        };
+        size_t denseAccepted, packedAccepted;
+        double denseSpeed = throughput([&table](const std::string &input)
+                                       { return table.match(input); },
+                                       denseAccepted);
+        double packedSpeed = throughput([&packed](const std::string &input)
+                                        { return packed.match(input); },
+                                        packedAccepted);
+
+        double kb = totalBytes / 1024.0;
+        std::cout << name << ": 布局 " << layoutMs << " ms\n"
+                  << "  90%访问跨度 " << coverage(lineVisits, 0.9) << " 缓存行 / " << coverage(pageVisits, 0.9)
+                  << " 页, 模拟缺失/KB L1 " << l1.getMisses() / kb << " L2 " << l2.getMisses() / kb << "\n"
+                  << "  稠密表 " << denseSpeed << " MB/s, 压缩表 " << packedSpeed << " MB/s, 接受 " << denseAccepted
+                  << "\n";
+        return denseAccepted == packedAccepted ? denseAccepted : SIZE_MAX;
+    };
+
+    size_t expected = report("原始编号", original, compressed, 0);
+    reportAllocations("原始编号");
+
+    timer.reset();
+    DFATable bfs = original.renumbered(breadthFirstLayout(original));
+    double bfsMs = timer.elapsedMs();
+    size_t bfsAccepted = report("广度优先", bfs, CompressedDFATable(bfs), bfsMs);
+    reportAllocations("广度优先");
+
+    timer.reset();
+    DFATable profiled = original.renumbered(profileLayout(original, sampleVisits));
+    double profiledMs = timer.elapsedMs();
+    CompressedDFATable profiledPacked = compressed.renumbered(profileLayout(compressed, sampleVisits));
+    size_t profiledAccepted = report("访问统计", profiled, profiledPacked, profiledMs);
+    reportAllocations("访问统计");
+
+    size_t mismatches = 0;
+    for (const auto &input : inputs)
+    {
+        bool result = original.match(input);
+        mismatches += bfs.match(input) != result || profiled.match(input) != result ||
+                      profiledPacked.match(input) != result;
+    }
+    std::cout << "\n结果不一致: " << mismatches << "\n";
+    return mismatches == 0 && expected != SIZE_MAX && bfsAccepted == expected && profiledAccepted == expected ? 0 : 1;
+}
@@ -0,0 +1,188 @@
+// 词法分析测试
+// 生成类C源代码，用一组按优先级排列的记号规则切分，比较两种做法：
+//   - 合并DFA：Lexer把全部规则合并成一个DFA，每个位置单趟前进并回退到最后的接受位置
+//   - 逐条规则：每条规则各自一个DFATable，每个位置依次尝试全部规则取最长匹配，
+//     长度相同时前面的规则优先
+// 报告构造时间、吞吐量和记号速率，并检查两者切分出的记号序列一致。
+// 以-DREGEXP_ALLOC_STATS=ON构建并设置REGEXP_ALLOC_REPORT时，两种做法构造之后各输出一次内存分配统计。
+//
+// 用法: lexer_bench [--size N] [--seed N]
+
+#include "bench_util.h"
+#include "dfa.h"
+#include "dfa_table.h"
+#include "lexer.h"
+#include "nfa.h"
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+    // 关键字放在标识符前面，使"if"切成关键字而"iffy"仍是标识符
+    const std::vector<std::string> RULES = {
+        "if|else|while|for|return|int|char|void|struct|static|const",
+        "[a-zA-Z_][a-zA-Z_0-9]*",
+        "[0-9]+|0x[0-9a-fA-F]+",
+        "\"([^\"\\\\\\n]|\\\\[^\\n])*\"",
+        "//[^\\n]*",
+        "[ \\t\\n]+",
+        "==|!=|<=|>=|&&|\\|\\||\\+\\+|--|->|\\+=|-=",
+        "[-+*/%=<>!&|^~?:;,\\.(){}]|\\[|\\]",
+    };
+
+    std::string makeSource(std::mt19937 &rng, size_t size)
+    {
+        static const char *keywords[] = {"if", "else", "while", "for", "return", "int", "char", "void", "struct"};
+        static const char *operators[] = {"==", "!=", "<=", "&&", "||", "++", "->", "+=", "=", "+", "*", "<",
+                                          ";", ",", "(", ")", "{", "}", "[", "]", "."};
+        const std::string letters = "abcdefghijklmnopqrstuvwxyz_";
+        const std::string tail = letters + "0123456789";
+        std::string source;
+        while (source.size() < size)
+        {
+            switch (rng() % 10)
+            {
+            case 0:
+                source += keywords[rng() % 9];
+                break;
+            case 1:
+            case 2:
+                source += randomInput(rng, letters, 1) + randomInput(rng, tail, rng() % 10);
+                break;
+            case 3:
+                source += randomInput(rng, "0123456789", 1 + rng() % 5);
+                break;
+            case 4:
+            case 5:
+            case 6:
+                source += operators[rng() % 21];
+                break;
+            case 7:
+                source += rng() % 8 ? " " : "\n    ";
+                break;
+            case 8:
+                // 字符串中的转义序列整体生成，避免反斜杠恰好落在结尾引号前
+                source += rng() % 4 ? "\"" + randomInput(rng, letters + " %", rng() % 16) + (rng() % 2 ? "\\n\"" : "\"")
+                                    : "// " + randomInput(rng, letters + " ", rng() % 30) + "\n";
+                break;
+            default:
+                source += " ";
+                break;
+            }
+        }
+        return source;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t size = 4 << 20;
+    unsigned seed = 42;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--size" && i + 1 < argc)
+            size = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--seed" && i + 1 < argc)
+            seed = static_cast<unsigned>(std::atoi(argv[++i]));
+    }
+
+    std::mt19937 rng(seed);
+    std::string source = makeSource(rng, size);
+
+    BenchTimer timer;
+    Lexer lexer(RULES);
+    double lexerBuildMs = timer.elapsedMs();
+    reportAllocations("合并DFA构造");
+
+    timer.reset();
+    std::vector<DFATable> tables;
+    NFABuilder nfaBuilder;
+    DFABuilder dfaBuilder;
+    int separateStates = 0;
+    for (const auto &rule : RULES)
+    {
+        tables.emplace_back(dfaBuilder.minimizeDFA(dfaBuilder.buildDFA(nfaBuilder.buildNFA(rule))));
+        separateStates += tables.back().getStateCount();
+    }
+    double separateBuildMs = timer.elapsedMs();
+    reportAllocations("逐条规则构造");
+
+    // 合并DFA：记号数组只分配一次，分批切分
+    const size_t batch = 4096;
+    std::vector<LexToken> buffer(batch);
+    std::vector<LexToken> lexerTokens;
+    lexerTokens.reserve(source.size() / 2);
+    timer.reset();
+    size_t position = 0;
+    while (position < source.size())
+    {
+        size_t consumed;
+        size_t count = lexer.tokenize(source.data() + position, source.size() - position, buffer.data(), batch, consumed);
+        for (size_t i = 0; i < count; i++)
+        {
+            lexerTokens.push_back({buffer[i].rule, position + buffer[i].offset, buffer[i].length});
+        }
+        position += consumed;
+        if (count < batch && position < source.size())
+        {
+            break;
+        }
+    }
+    double lexerMs = timer.elapsedMs();
+    size_t lexerEnd = position;
+
+    // 逐条规则：每个位置对每条规则各走一遍
+    std::vector<LexToken> separateTokens;
+    separateTokens.reserve(source.size() / 2);
+    timer.reset();
+    position = 0;
+    while (position < source.size())
+    {
+        int bestRule = -1;
+        size_t bestLength = 0;
+        for (size_t rule = 0; rule < tables.size(); rule++)
+        {
+            const DFATable &table = tables[rule];
+            int state = table.getInitialState();
+            for (size_t i = position; i < source.size(); i++)
+            {
+                state = table.getNextState(state, static_cast<unsigned char>(source[i]));
+                if (state == table.getDeadState())
+                    break;
+                if (table.isAccept(state) && i + 1 - position > bestLength)
+                {
+                    bestRule = static_cast<int>(rule);
+                    bestLength = i + 1 - position;
+                }
+            }
+        }
+        if (bestRule < 0)
+        {
+            break;
+        }
+        separateTokens.push_back({bestRule, position, bestLength});
+        position += bestLength;
+    }
+    double separateMs = timer.elapsedMs();
+
+    size_t mismatches = lexerEnd != position || lexerTokens.size() != separateTokens.size();
+    for (size_t i = 0; i < lexerTokens.size() && i < separateTokens.size(); i++)
+    {
+        const LexToken &a = lexerTokens[i];
+        const LexToken &b = separateTokens[i];
+        mismatches += a.rule != b.rule || a.offset != b.offset || a.length != b.length;
+    }
+
+    double mb = source.size() / 1048576.0;
+    std::cout << "输入 " << mb << " MB, 规则 " << RULES.size() << " 条, 记号 " << lexerTokens.size()
+              << ", 切分到偏移 " << lexerEnd << "\n"
+              << "合并DFA: " << lexer.getStateCount() << " 状态, 构造 " << lexerBuildMs << " ms, "
+              << mb / (lexerMs / 1000.0) << " MB/s, " << lexerTokens.size() / (lexerMs / 1000.0) / 1e6
+              << " M记号/s\n"
+              << "逐条规则: " << separateStates << " 状态, 构造 " << separateBuildMs << " ms, "
+              << mb / (separateMs / 1000.0) << " MB/s, " << separateTokens.size() / (separateMs / 1000.0) / 1e6
+              << " M记号/s\n"
+              << "加速 " << separateMs / lexerMs << "x, 结果不一致 " << mismatches << "\n";
+    return mismatches == 0 && lexerEnd == source.size() ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+// 并行最小化测试
+// 用随机关键词构造未最小化的字典树DFA：每个关键词由随机前缀和取自少量后缀的公共后缀组成，
+// 字典树中大量相同的后缀子树在最小化时合并。对每个规模报告：
+//   - 并行签名细化在1、2、4……直到--threads个线程下的最小化时间与相对1个线程的加速比，
+//     时间包含展开平坦数组和构造结果Graph这些单线程的部分
+//   - 各线程数的结果与1个线程完全相同（状态编号、接受状态和每条边）
+// 规模不超过--sequential-max时再与逐组细化的顺序方式比较结果与时间，
+// 并给接受状态加上规则号，比较两种方式带规则号的最小化结果。
+// 以-DREGEXP_ALLOC_STATS=ON构建并设置REGEXP_ALLOC_REPORT时，每次最小化之后输出内存分配统计。
+//
+// 用法: minimize_bench [--words N,N,...] [--threads N] [--sequential-max N] [--seed N]
+
+#include "bench_util.h"
+#include "dfa.h"
+#include "keyword_trie.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <tuple>
+
+namespace
+{
+    std::vector<size_t> parseSizes(const std::string &text)
+    {
+        std::vector<size_t> sizes;
+        std::stringstream in(text);
+        std::string item;
+        while (std::getline(in, item, ','))
+        {
+            sizes.push_back(static_cast<size_t>(std::atoll(item.c_str())));
+        }
+        return sizes;
+    }
+
+    // 边按(起点, 符号, 终点)排序后比较，与加边的顺序无关
+    std::vector<std::tuple<int, char, int>> sortedEdges(const Graph &graph)
+    {
+        std::vector<std::tuple<int, char, int>> edges;
+        for (const auto &edge : graph.getEdges())
+        {
+            edges.emplace_back(edge.u, edge.w, edge.v);
+        }
+        std::sort(edges.begin(), edges.end());
+        return edges;
+    }
+
+    bool sameGraph(const Graph &a, const Graph &b)
+    {
+        return a.getAllStates() == b.getAllStates() && a.getInitialState() == b.getInitialState() &&
+               a.getAcceptStates() == b.getAcceptStates() && sortedEdges(a) == sortedEdges(b);
+    }
+
+    std::shared_ptr<Graph> minimizeWith(const std::shared_ptr<Graph> &dfa, MinimizeMode mode, size_t threads,
+                                        double &ms)
+    {
+        DFABuilder builder;
+        builder.setMinimizeMode(mode, threads);
+        BenchTimer timer;
+        auto minDfa = builder.minimizeDFA(dfa);
+        ms = timer.elapsedMs();
+        return minDfa;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<size_t> sizes = {100, 20000, 200000};
+    size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    size_t sequentialMax = 100;
+    unsigned seed = 42;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--words" && i + 1 < argc)
+            sizes = parseSizes(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc)
+            maxThreads = std::max<size_t>(1, static_cast<size_t>(std::atoll(argv[++i])));
+        else if (arg == "--sequential-max" && i + 1 < argc)
+            sequentialMax = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--seed" && i + 1 < argc)
+            seed = static_cast<unsigned>(std::atoi(argv[++i]));
+    }
+
+    std::vector<size_t> threadCounts;
+    for (size_t threads = 1; threads < maxThreads; threads *= 2)
+    {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    std::cout << "硬件并发数 " << std::thread::hardware_concurrency() << ", 最多 " << maxThreads << " 个线程\n";
+    const std::string alphabet = "abcdefgh";
+    std::mt19937 rng(seed);
+    size_t mismatches = 0;
+    for (size_t size : sizes)
+    {
+        std::vector<std::string> suffixes;
+        for (int i = 0; i < 64; i++)
+        {
+            suffixes.push_back(randomInput(rng, alphabet, 3 + rng() % 6));
+        }
+        std::vector<std::string> words;
+        for (size_t i = 0; i < size; i++)
+        {
+            words.push_back(randomInput(rng, alphabet, 3 + rng() % 8) + suffixes[rng() % suffixes.size()]);
+        }
+        auto dfa = KeywordTrie(words).toGraph();
+        std::cout << "关键词数 " << size << ": 字典树DFA " << dfa->getAllStates().size() << " 状态\n";
+        reportAllocations("字典树DFA");
+
+        double baseMs = 0;
+        std::shared_ptr<Graph> base;
+        for (size_t threads : threadCounts)
+        {
+            double ms;
+            auto minDfa = minimizeWith(dfa, MinimizeMode::Parallel, threads, ms);
+            bool same = true;
+            if (!base)
+            {
+                base = minDfa;
+                baseMs = ms;
+                std::cout << "  最小化后 " << minDfa->getAllStates().size() << " 状态\n";
+            }
+            else
+            {
+                same = sameGraph(*base, *minDfa);
+                mismatches += !same;
+            }
+            std::cout << "  并行 " << threads << " 线程: " << ms << " ms, 加速 " << baseMs / ms << "x"
+                      << (same ? "" : ", 结果不同") << "\n";
+            reportAllocations("并行 " + std::to_string(threads) + " 线程");
+        }
+
+        if (size <= sequentialMax)
+        {
+            double ms;
+            auto minDfa = minimizeWith(dfa, MinimizeMode::Sequential, 0, ms);
+            bool same = sameGraph(*base, *minDfa);
+            mismatches += !same;
+            std::cout << "  顺序: " << ms << " ms, 与并行" << (same ? "相同" : "不同") << "\n";
+            reportAllocations("顺序");
+
+            // 每个接受状态取状态号模3作为规则号，规则号不同的状态不能合并
+            std::map<int, int> tags;
+            for (int state : dfa->getAcceptStates())
+            {
+                tags[state] = state % 3;
+            }
+            std::map<int, int> sequentialTags, parallelTags;
+            DFABuilder sequential, parallel;
+            parallel.setMinimizeMode(MinimizeMode::Parallel, maxThreads);
+            auto sequentialDfa = sequential.minimizeDFA(dfa, tags, sequentialTags);
+            auto parallelDfa = parallel.minimizeDFA(dfa, tags, parallelTags);
+            same = sameGraph(*sequentialDfa, *parallelDfa) && sequentialTags == parallelTags;
+            mismatches += !same;
+            std::cout << "  带规则号: " << parallelDfa->getAllStates().size() << " 状态, 两种方式"
+                      << (same ? "相同" : "不同") << "\n";
+        }
+    }
+    std::cout << "结果不一致: " << mismatches << "\n";
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+// 规则两两相交检测的基准测试
+// 对比惰性乘积（找到第一个接受状态对即停止）与先最小化再展开完整乘积的做法；
+// 完整乘积不经过ProductDFA，不做剪枝，展开全部可达状态对（含死状态）。
+// 以-DREGEXP_ALLOC_STATS=ON构建并设置REGEXP_ALLOC_REPORT时，编译和两种检测之后各输出一次内存分配统计。
+//
+// 用法: product_bench [规则文件] [--seed N] [--count N]
+//   未给出规则文件时随机生成规则集
+
+#include "bench_util.h"
+#include "dfa.h"
+#include "dfa_table.h"
+#include "nfa.h"
+#include "product.h"
+#include <cstdlib>
+#include <iostream>
+#include <queue>
+#include <unordered_map>
+
+namespace
+{
+    // 不剪枝的完整乘积：按两个转换表的联合字节等价类广度优先展开全部可达状态对并构造Graph，
+    // 返回是否存在两侧都接受的状态对，states返回状态对的数量
+    bool fullProductIntersects(const DFATable &a, const DFATable &b, size_t &states)
+    {
+        std::vector<unsigned char> representatives;
+        std::unordered_map<int, int> seenClasses;
+        for (int byte = 0; byte < 256; byte++)
+        {
+            unsigned char c = static_cast<unsigned char>(byte);
+            int key = a.getByteClass(c) * 256 + b.getByteClass(c);
+            if (seenClasses.emplace(key, static_cast<int>(representatives.size())).second)
+            {
+                representatives.push_back(c);
+            }
+        }
+
+        Graph graph;
+        std::unordered_map<uint64_t, int> ids;
+        std::vector<std::pair<int, int>> pairs;
+        auto idOf = [&](int p, int q)
+        {
+            uint64_t key = (static_cast<uint64_t>(p) << 32) | static_cast<uint32_t>(q);
+            auto inserted = ids.emplace(key, static_cast<int>(pairs.size()));
+            if (inserted.second)
+            {
+                pairs.emplace_back(p, q);
+                graph.addState(inserted.first->second);
+                if (a.isAccept(p) && b.isAccept(q))
+                {
+                    graph.addAcceptState(inserted.first->second);
+                }
+            }
+            return inserted.first->second;
+        };
+        graph.setInitialState(idOf(a.getInitialState(), b.getInitialState()));
+        for (size_t id = 0; id < pairs.size(); id++)
+        {
+            for (unsigned char c : representatives)
+            {
+                int p = a.getNextState(pairs[id].first, c);
+                int q = b.getNextState(pairs[id].second, c);
+                graph.addEdge(static_cast<int>(id), idOf(p, q), static_cast<char>(c));
+            }
+        }
+        states = pairs.size();
+        return !graph.getAcceptStates().empty();
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::string corpusPath;
+    unsigned seed = 42;
+    int count = 150;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc)
+            seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "--count" && i + 1 < argc)
+            count = std::atoi(argv[++i]);
+        else
+            corpusPath = arg;
+    }
+
+    std::vector<std::string> rules;
+    if (!corpusPath.empty())
+    {
+        rules = loadLines(corpusPath);
+    }
+    else
+    {
+        std::mt19937 rng(seed);
+        for (int i = 0; i < count; i++)
+        {
+            rules.push_back(randomPattern(rng, "abcd", 4));
+        }
+    }
+    if (rules.size() < 2)
+    {
+        std::cerr << "至少需要两条规则" << std::endl;
+        return 1;
+    }
+    std::cout << "规则数: " << rules.size() << ", 规则对: " << rules.size() * (rules.size() - 1) / 2 << "\n";
+
+    // 编译：惰性方式只需要子集构造，完整方式还需要最小化
+    NFABuilder nfaBuilder;
+    DFABuilder dfaBuilder;
+    std::vector<DFATable> lazyTables, minimizedTables;
+    double lazyCompileMs = 0, fullCompileMs = 0;
+    for (const auto &rule : rules)
+    {
+        BenchTimer timer;
+        auto dfa = dfaBuilder.buildDFA(nfaBuilder.buildNFA(rule));
+        lazyTables.emplace_back(dfa);
+        lazyCompileMs += timer.elapsedMs();
+
+        timer.reset();
+        minimizedTables.emplace_back(dfaBuilder.minimizeDFA(dfa));
+        fullCompileMs += timer.elapsedMs();
+    }
+    fullCompileMs += lazyCompileMs;
+    reportAllocations("编译");
+
+    // 惰性乘积：遇到第一个公共字符串即停止
+    BenchTimer timer;
+    size_t lazyOverlaps = 0, lazyStates = 0;
+    for (size_t i = 0; i < rules.size(); i++)
+    {
+        for (size_t j = i + 1; j < rules.size(); j++)
+        {
+            ProductDFA product(lazyTables[i], lazyTables[j], ProductOperation::Intersection);
+            std::string witness;
+            if (product.findWitness(witness))
+            {
+                lazyOverlaps++;
+            }
+            lazyStates += product.getStateCount();
+        }
+    }
+    double lazyMs = timer.elapsedMs();
+    reportAllocations("惰性乘积");
+
+    // 完整乘积：不剪枝，展开全部可达状态后再判断是否存在接受状态
+    timer.reset();
+    size_t fullOverlaps = 0, fullStates = 0;
+    for (size_t i = 0; i < rules.size(); i++)
+    {
+        for (size_t j = i + 1; j < rules.size(); j++)
+        {
+            size_t states;
+            if (fullProductIntersects(minimizedTables[i], minimizedTables[j], states))
+            {
+                fullOverlaps++;
+            }
+            fullStates += states;
+        }
+    }
+    double fullMs = timer.elapsedMs();
+    reportAllocations("完整乘积");
+
+    std::cout << "惰性乘积: 编译 " << lazyCompileMs << " ms, 检测 " << lazyMs << " ms, 生成状态 "
+              << lazyStates << ", 相交 " << lazyOverlaps << "\n";
+    std::cout << "完整乘积: 编译 " << fullCompileMs << " ms, 检测 " << fullMs << " ms, 生成状态 "
+              << fullStates << ", 相交 " << fullOverlaps << "\n";
+
+    if (lazyOverlaps != fullOverlaps)
+    {
+        std::cerr << "结果不一致!" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,132 @@
+// 文本搜索测试
+// 1. 随机生成正则表达式和短文本，把Searcher::findAll和search的结果与暴力的最左最长实现比较：
+//    从每个位置起用锚定DFA逐个检查所有子串，取最长的匹配，匹配之后从终点继续（空匹配之后前进一个字节）。
+// 2. 在每个位置都有匹配、但每次匹配之后的前瞻都延续到文本末尾的模式（如 b|b*c 之于 bbbb…）上，
+//    报告不同文本长度下findAll的吞吐量，吞吐量不随长度下降说明整个搜索是线性的。
+// 以-DREGEXP_ALLOC_STATS=ON构建并设置REGEXP_ALLOC_REPORT时，两部分之后各输出一次内存分配统计。
+//
+// 用法: search_bench [--patterns N] [--inputs N] [--length N] [--seed N]
+
+#include "bench_util.h"
+#include "dfa.h"
+#include "dfa_table.h"
+#include "nfa.h"
+#include "search.h"
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+    // 暴力的最左最长搜索，table为锚定的最小化DFA
+    std::vector<MatchSpan> bruteForceFindAll(const DFATable &table, const std::string &text)
+    {
+        std::vector<MatchSpan> matches;
+        size_t position = 0;
+        while (position <= text.size())
+        {
+            long long longest = -1;
+            for (size_t end = position; end <= text.size(); end++)
+            {
+                if (table.match(text.substr(position, end - position)))
+                {
+                    longest = static_cast<long long>(end);
+                }
+            }
+            if (longest < 0)
+            {
+                position++;
+                continue;
+            }
+            size_t end = static_cast<size_t>(longest);
+            matches.push_back({position, end});
+            position = end > position ? end : position + 1;
+        }
+        return matches;
+    }
+
+    std::string formatSpans(const std::vector<MatchSpan> &spans)
+    {
+        std::string out;
+        for (const MatchSpan &span : spans)
+        {
+            out += "[" + std::to_string(span.start) + "," + std::to_string(span.end) + ")";
+        }
+        return out.empty() ? "(无)" : out;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t patternCount = 300;
+    size_t inputCount = 30;
+    size_t maxLength = 24;
+    unsigned seed = 42;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--patterns" && i + 1 < argc)
+            patternCount = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--inputs" && i + 1 < argc)
+            inputCount = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--length" && i + 1 < argc)
+            maxLength = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--seed" && i + 1 < argc)
+            seed = static_cast<unsigned>(std::atoi(argv[++i]));
+    }
+
+    std::mt19937 rng(seed);
+    size_t checked = 0, mismatches = 0;
+    const size_t reportLimit = 10;
+    for (size_t p = 0; p < patternCount; p++)
+    {
+        std::string pattern = randomPattern(rng, "abc", 4);
+        NFABuilder nfaBuilder;
+        DFABuilder dfaBuilder;
+        auto nfa = nfaBuilder.buildNFA(pattern);
+        DFATable table(dfaBuilder.minimizeDFA(dfaBuilder.buildDFA(nfa)));
+        Searcher searcher(nfa);
+        for (size_t k = 0; k < inputCount; k++)
+        {
+            std::string text = randomInput(rng, "abcd", rng() % (maxLength + 1));
+            std::vector<MatchSpan> expected = bruteForceFindAll(table, text);
+            std::vector<MatchSpan> actual = searcher.findAll(text);
+            MatchSpan first{0, 0};
+            bool found = searcher.search(text, first);
+            bool same = actual.size() == expected.size() && found == !expected.empty() &&
+                        (!found || (first.start == expected[0].start && first.end == expected[0].end));
+            for (size_t m = 0; same && m < actual.size(); m++)
+            {
+                same = actual[m].start == expected[m].start && actual[m].end == expected[m].end;
+            }
+            checked++;
+            if (!same && mismatches++ < reportLimit)
+            {
+                std::cout << "不一致: 模式 \"" << pattern << "\" 文本 \"" << text << "\" findAll "
+                          << formatSpans(actual) << ", 暴力 " << formatSpans(expected) << "\n";
+            }
+        }
+    }
+    std::cout << "随机模式 " << patternCount << " 个, 文本 " << checked << " 个, 与暴力实现不一致 " << mismatches
+              << "\n";
+    reportAllocations("随机模式");
+
+    // 每次匹配之后的前瞻都延续到文本末尾
+    const std::pair<const char *, char> lookaheadCases[] = {{"b|b*c", 'b'}, {"a|(aa)*b", 'a'}, {"x(y|x*z)?", 'x'}};
+    for (const auto &lookahead : lookaheadCases)
+    {
+        Searcher searcher{std::string(lookahead.first)};
+        std::cout << "模式 " << lookahead.first << ":";
+        for (size_t length : {10000, 100000, 1000000})
+        {
+            std::string text(length, lookahead.second);
+            BenchTimer timer;
+            size_t count = searcher.findAll(text).size();
+            double ms = timer.elapsedMs();
+            std::cout << " " << length << " 字节 " << count << " 个匹配 " << (length / 1048576.0) / (ms / 1000.0)
+                      << " MB/s;";
+        }
+        std::cout << "\n";
+    }
+    reportAllocations("前瞻吞吐量");
+    return mismatches == 0 ? 0 : 1;
+}
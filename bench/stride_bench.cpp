@@ -0,0 +1,198 @@
+// 双字节步长转换表测试
+// 对几种常见的模式（最小化DFA），比较一字节稠密表与双字节表的整串匹配吞吐量，
+// 输入分为日志行长度（约80字节）和长输入（约4KB）两组，并检查两者的整串匹配结果
+// 以及最长前缀匹配（含奇数长度、两步之间接受的情况）一致，Matcher::useStride后的结果也一并检查。
+// 以-DREGEXP_ALLOC_STATS=ON构建并设置REGEXP_ALLOC_REPORT时，每种模式构造之后输出内存分配统计。
+//
+// 用法: stride_bench [--count N] [--limit BYTES] [--seed N]
+
+#include "bench_util.h"
+#include "dfa.h"
+#include "dfa_table.h"
+#include "matcher.h"
+#include "nfa.h"
+#include "stride_table.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+    struct Case
+    {
+        const char *name;
+        const char *pattern;
+        std::string (*generate)(std::mt19937 &rng, size_t length);
+    };
+
+    std::string makeIdentifier(std::mt19937 &rng, size_t length)
+    {
+        return randomInput(rng, "abcdefghijklmnopqrstuvwxyz_", 1) +
+               randomInput(rng, "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789", length - 1);
+    }
+
+    std::string makeNumbers(std::mt19937 &rng, size_t length)
+    {
+        std::string input;
+        while (input.size() < length)
+        {
+            input += randomInput(rng, "0123456789", 1 + rng() % 6) + (rng() % 2 ? "." : "e") +
+                     randomInput(rng, "0123456789", 1 + rng() % 3) + ",";
+        }
+        input.resize(length);
+        return input;
+    }
+
+    std::string makeLogLine(std::mt19937 &rng, size_t length)
+    {
+        static const char *levels[] = {"INFO", "WARN", "ERROR"};
+        std::string input = "2024-05-17 12:34:56 " + std::string(levels[rng() % 3]) + " ";
+        if (input.size() < length)
+        {
+            input += randomInput(rng, "abcdefghijklmnopqrstuvwxyz     ", length - input.size());
+        }
+        return input;
+    }
+
+    std::string makeText(std::mt19937 &rng, size_t length)
+    {
+        std::string input = randomInput(rng, "abcdefghijklmnopqrstuvwxyz   ", length);
+        if (rng() % 2 && length > 8)
+        {
+            input.replace(rng() % (length - 8), 5, rng() % 2 ? "error" : "fail ");
+        }
+        return input;
+    }
+
+    std::string makeBase64(std::mt19937 &rng, size_t length)
+    {
+        std::string input =
+            randomInput(rng, "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/", length);
+        if (rng() % 2)
+        {
+            input.back() = '=';
+        }
+        return input;
+    }
+
+    // 用一字节表逐字节求最长前缀，作为参照
+    long long longestPrefix(const DFATable &table, const std::string &input)
+    {
+        int state = table.getInitialState();
+        long long last = table.isAccept(state) ? 0 : -1;
+        for (size_t i = 0; i < input.size(); i++)
+        {
+            state = table.getNextState(state, static_cast<unsigned char>(input[i]));
+            if (state == table.getDeadState())
+                break;
+            if (table.isAccept(state))
+                last = static_cast<long long>(i) + 1;
+        }
+        return last;
+    }
+
+    // 对比吞吐量时取多次运行中最快的一次
+    const int REPEAT = 3;
+
+    template <typename Match>
+    double throughput(const std::vector<std::string> &inputs, size_t totalBytes, Match &&match, size_t &accepted)
+    {
+        double best = 0;
+        for (int r = 0; r < REPEAT; r++)
+        {
+            BenchTimer timer;
+            accepted = 0;
+            for (const auto &input : inputs)
+            {
+                accepted += match(input);
+            }
+            best = std::max(best, (totalBytes / 1048576.0) / (timer.elapsedMs() / 1000.0));
+        }
+        return best;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t count = 200000;
+    size_t limit = STRIDE_TABLE_LIMIT;
+    unsigned seed = 42;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--count" && i + 1 < argc)
+            count = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--limit" && i + 1 < argc)
+            limit = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--seed" && i + 1 < argc)
+            seed = static_cast<unsigned>(std::atoi(argv[++i]));
+    }
+
+    const Case cases[] = {
+        {"标识符", "[a-zA-Z_][a-zA-Z_0-9]*", makeIdentifier},
+        {"数值列表", "(-?[0-9]+(\\.[0-9]+)?(e[-+]?[0-9]+)?,)*", makeNumbers},
+        {"日志行", "[0-9]+-[0-9]+-[0-9]+ [0-9]+:[0-9]+:[0-9]+ (INFO|WARN|ERROR) [a-z ]*", makeLogLine},
+        {"含关键词", "[a-z ]*(error|fail)[a-z ]*", makeText},
+        {"Base64", "[A-Za-z0-9+/]*=?=?", makeBase64},
+    };
+    const size_t lengths[] = {80, 4096};
+
+    std::mt19937 rng(seed);
+    size_t mismatches = 0;
+    for (const Case &c : cases)
+    {
+        NFABuilder nfaBuilder;
+        DFABuilder dfaBuilder;
+        DFATable table(dfaBuilder.minimizeDFA(dfaBuilder.buildDFA(nfaBuilder.buildNFA(c.pattern))));
+        std::cout << c.name << ": " << c.pattern << "\n  " << table.getStateCount() << " 状态, "
+                  << table.getClassCount() << " 等价类, 双字节表 " << StrideDFATable::estimateMemory(table) / 1024.0
+                  << " KB";
+        if (StrideDFATable::estimateMemory(table) > limit)
+        {
+            std::cout << ", 超出上限, 跳过\n";
+            continue;
+        }
+        BenchTimer timer;
+        StrideDFATable stride(table, limit);
+        std::cout << ", 构造 " << timer.elapsedMs() << " ms";
+        Matcher matcher(c.pattern);
+        matcher.useStride(limit);
+        std::cout << ", Matcher选择 " << matcher.getEngineName() << "\n";
+        reportAllocations(c.name);
+
+        for (size_t length : lengths)
+        {
+            // 长度在目标附近浮动，奇偶都有
+            std::vector<std::string> inputs;
+            size_t totalBytes = 0;
+            size_t n = std::max<size_t>(1, count * 80 / length);
+            for (size_t i = 0; i < n; i++)
+            {
+                inputs.push_back(c.generate(rng, length - length / 8 + rng() % (length / 4)));
+                totalBytes += inputs.back().size();
+            }
+
+            size_t byteAccepted, strideAccepted;
+            double byteSpeed = throughput(inputs, totalBytes, [&table](const std::string &input)
+                                          { return table.match(input); }, byteAccepted);
+            double strideSpeed = throughput(inputs, totalBytes, [&stride](const std::string &input)
+                                            { return stride.match(input); }, strideAccepted);
+
+            size_t differ = 0;
+            for (const auto &input : inputs)
+            {
+                bool expected = table.match(input);
+                differ += stride.match(input) != expected || matcher.match(input) != expected;
+                // 截短到随机长度，覆盖在两步之间接受的前缀
+                std::string prefix = input.substr(0, rng() % (input.size() + 1));
+                differ += longestPrefix(table, prefix) != stride.longestPrefix(prefix.data(), prefix.size());
+            }
+            mismatches += differ;
+            std::cout << "  约" << length << "字节 × " << n << ": 一字节 " << byteSpeed << " MB/s, 双字节 "
+                      << strideSpeed << " MB/s, 加速 " << strideSpeed / byteSpeed << "x, 接受 " << strideAccepted
+                      << "/" << byteAccepted << ", 不一致 " << differ << "\n";
+        }
+    }
+    std::cout << "结果不一致: " << mismatches << "\n";
+    return mismatches == 0 ? 0 : 1;
+}
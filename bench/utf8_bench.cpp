@@ -0,0 +1,71 @@
+// UTF-8字符类的编译规模检查
+// 对常见文字的码点范围统计NFA/DFA状态数与编译时间，检查最小化DFA不超过预期规模，
+// 并用各文字的示例文本验证匹配结果；另有几项检查字节'$'在字符类、\p{Any}和转义中与其他字节一样可以匹配。
+// 以-DREGEXP_ALLOC_STATS=ON构建并设置REGEXP_ALLOC_REPORT时，每一项之后输出其编译的内存分配统计。
+//
+// 用法: utf8_bench
+
+#include "bench_util.h"
+#include "dfa.h"
+#include "dfa_table.h"
+#include "nfa.h"
+#include <iostream>
+
+struct ScriptCase
+{
+    const char *name;
+    std::string regex;
+    int maxStates;        // 最小化DFA状态数上限（不含死状态）
+    std::string accepted; // 应被接受的示例
+    std::string rejected; // 应被拒绝的示例
+};
+
+int main()
+{
+    std::vector<ScriptCase> cases = {
+        {"ASCII", "[\\u{0}-\\u{7F}]+", 2, "hello, world", "héllo"},
+        {"拉丁字母", "[\\u{0}-\\u{24F}]+", 4, "Ærøskøbing café", "日本"},
+        {"希腊字母", "[\\u{370}-\\u{3FF}]+", 4, "αβγδ", "abc"},
+        {"西里尔字母", "[\\u{400}-\\u{4FF}]+", 4, "привет", "hello"},
+        {"阿拉伯字母", "[\\u{600}-\\u{6FF}]+", 4, "مرحبا", "שלום"},
+        {"天城文", "[\\u{900}-\\u{97F}]+", 4, "नमस्ते", "hello"},
+        {"中日韩统一表意文字", "[\\u{4E00}-\\u{9FFF}]+", 6, "中文字符", "かな"},
+        {"平假名与片假名", "[\\u{3040}-\\u{30FF}]+", 5, "ひらがなカタカナ", "漢字"},
+        {"韩文音节", "[\\u{AC00}-\\u{D7A3}]+", 8, "한국어", "中文"},
+        {"表情符号", "[\\u{1F600}-\\u{1F64F}]+", 6, "😀😃", "☺"},
+        {"任意码点", "\\p{Any}+", 9, "mixed 中文 😀 ß", "\xff"},
+        {"否定类", "[^a-z]+", 10, "ABC中文", "abc"},
+        // 字节'$'是普通符号，只有未转义的'$'表示ε
+        {"否定类中的$", "[^a]", 10, "$", "a"},
+        {"任意码点中的$", "\\p{Any}", 10, "$", "$$"},
+        {"转义的$", "a\\$b", 4, "a$b", "ab"},
+        {"码点转义的$", "\\u{24}+", 2, "$$", "a"},
+        {"未转义的$", "a$b", 3, "ab", "a$b"},
+    };
+
+    bool ok = true;
+    NFABuilder nfaBuilder;
+    DFABuilder dfaBuilder;
+    for (const auto &c : cases)
+    {
+        BenchTimer timer;
+        auto nfa = nfaBuilder.buildNFA(c.regex);
+        auto dfa = dfaBuilder.buildDFA(nfa);
+        auto minDfa = dfaBuilder.minimizeDFA(dfa);
+        DFATable table(minDfa);
+        double ms = timer.elapsedMs();
+
+        int states = static_cast<int>(minDfa->getAllStates().size());
+        bool matchOk = table.match(c.accepted) && !table.match(c.rejected);
+        bool sizeOk = states <= c.maxStates;
+        ok = ok && matchOk && sizeOk;
+
+        std::cout << c.name << ": NFA " << nfa->getAllStates().size() << " 状态/" << nfa->getEdges().size()
+                  << " 边, DFA " << dfa->getAllStates().size() << " 状态, 最小化DFA " << states
+                  << " 状态 (上限 " << c.maxStates << "), 等价类 " << table.getClassCount()
+                  << ", 转换表 " << table.memoryUsage() << " 字节, 编译 " << ms << " ms"
+                  << (matchOk ? "" : " [匹配错误]") << (sizeOk ? "" : " [超出规模]") << "\n";
+        reportAllocations(c.name);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+// 计数的全局operator new/delete
+//
+// 只在以-DREGEXP_ALLOC_STATS=ON构建时作为目标文件链接进regexp_to_dfa和基准测试程序，
+// 不进入regexp_core静态库和regexp动态库。每个分配块前放一个16字节的头，记下大小、
+// 记入的统计槽位和到malloc返回地址的偏移，释放时据此扣减未释放的字节数。
+
+#include "alloc_stats.h"
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    struct AllocHeader
+    {
+        uint64_t size;
+        uint16_t slot;
+        uint16_t phaseSlot;
+        uint32_t offset; // 用户地址到malloc返回地址的字节数
+    };
+    static_assert(sizeof(AllocHeader) == 16, "分配头应为16字节");
+
+    void *allocate(size_t size, size_t alignment) noexcept
+    {
+        // 头紧挨在用户地址之前，用户地址按alignment（至少16）对齐
+        size_t align = alignment < sizeof(AllocHeader) ? sizeof(AllocHeader) : alignment;
+        size_t extra = sizeof(AllocHeader) + align;
+        if (size > SIZE_MAX - extra)
+        {
+            return nullptr;
+        }
+        char *raw = static_cast<char *>(std::malloc(size + extra));
+        if (!raw)
+        {
+            return nullptr;
+        }
+        uintptr_t user = (reinterpret_cast<uintptr_t>(raw) + sizeof(AllocHeader) + align - 1) & ~(uintptr_t(align) - 1);
+        AllocHeader *header = reinterpret_cast<AllocHeader *>(user) - 1;
+        header->size = size;
+        header->offset = static_cast<uint32_t>(user - reinterpret_cast<uintptr_t>(raw));
+        recordAllocation(size, header->slot, header->phaseSlot);
+        return reinterpret_cast<void *>(user);
+    }
+
+    void *allocateOrThrow(size_t size, size_t alignment)
+    {
+        void *pointer = allocate(size, alignment);
+        if (!pointer)
+        {
+            throw std::bad_alloc();
+        }
+        return pointer;
+    }
+
+    void release(void *pointer) noexcept
+    {
+        if (!pointer)
+        {
+            return;
+        }
+        AllocHeader *header = static_cast<AllocHeader *>(pointer) - 1;
+        recordFree(static_cast<size_t>(header->size), header->slot, header->phaseSlot);
+        std::free(static_cast<char *>(pointer) - header->offset);
+    }
+
+    // 链接了本文件即表示统计可用
+    struct HookInstaller
+    {
+        HookInstaller()
+        {
+            markAllocHookInstalled();
+        }
+    } installer;
+}
+
+void *operator new(size_t size)
+{
+    return allocateOrThrow(size, 0);
+}
+
+void *operator new[](size_t size)
+{
+    return allocateOrThrow(size, 0);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    return allocate(size, 0);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return allocate(size, 0);
+}
+
+void *operator new(size_t size, std::align_val_t alignment)
+{
+    return allocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void *operator new[](size_t size, std::align_val_t alignment)
+{
+    return allocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void *operator new(size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return allocate(size, static_cast<size_t>(alignment));
+}
+
+void *operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return allocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void *pointer) noexcept
+{
+    release(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    release(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+    release(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept
+{
+    release(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept
+{
+    release(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept
+{
+    release(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t) noexcept
+{
+    release(pointer);
+}
+
+void operator delete[](void *pointer, std::align_val_t) noexcept
+{
+    release(pointer);
+}
+
+void operator delete(void *pointer, size_t, std::align_val_t) noexcept
+{
+    release(pointer);
+}
+
+void operator delete[](void *pointer, size_t, std::align_val_t) noexcept
+{
+    release(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    release(pointer);
+}
+
+void operator delete[](void *pointer, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    release(pointer);
+}
@@ -0,0 +1,271 @@
+#include "alloc_stats.h"
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+// 统计槽位的数量上限，用完后新的(阶段, 数据结构)记入槽位0
+const size_t MAX_ALLOC_SLOTS = 1024;
+
+namespace
+{
+    // 阶段合计所用的数据结构标记，只按指针比较
+    const char PHASE_TOTAL[] = "*";
+
+    // 一个(阶段, 数据结构)的计数；phase与category在发布槽位之前写入，之后不再改变
+    struct AllocSlot
+    {
+        const char *phase;
+        const char *category;
+        std::atomic<size_t> allocations;
+        std::atomic<size_t> bytes;
+        std::atomic<size_t> live;
+        std::atomic<size_t> peak;
+    };
+
+    // 槽位0记录没有阶段标记的分配，同时也是槽位用完后的去处
+    AllocSlot slots[MAX_ALLOC_SLOTS];
+    std::atomic<size_t> slotCount(1);
+    std::mutex slotMutex;
+    std::atomic<bool> hookInstalled(false);
+
+    // 全部分配的合计
+    AllocSlot total;
+
+    // 当前线程的标记；dirty表示标记变了，下一次分配时重新查找槽位
+    thread_local const char *currentPhase = nullptr;
+    thread_local const char *currentCategory = nullptr;
+    thread_local bool dirty = true;
+    thread_local uint16_t cachedSlot = 0;
+    thread_local uint16_t cachedPhaseSlot = 0;
+
+    // 同一个名字的字面量在不同的编译单元中可能有不同的地址
+    bool sameName(const char *a, const char *b)
+    {
+        if (a == b)
+            return true;
+        if (!a || !b || a == PHASE_TOTAL || b == PHASE_TOTAL)
+            return false;
+        return std::strcmp(a, b) == 0;
+    }
+
+    // 查找或登记槽位；查找不加锁，只有登记新槽位时加锁，其中不分配内存
+    uint16_t findSlot(const char *phase, const char *category)
+    {
+        if (!phase)
+        {
+            return 0;
+        }
+        size_t count = slotCount.load(std::memory_order_acquire);
+        for (size_t i = 1; i < count; i++)
+        {
+            if (sameName(slots[i].phase, phase) && sameName(slots[i].category, category))
+            {
+                return static_cast<uint16_t>(i);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(slotMutex);
+        size_t current = slotCount.load(std::memory_order_relaxed);
+        for (size_t i = count; i < current; i++)
+        {
+            if (sameName(slots[i].phase, phase) && sameName(slots[i].category, category))
+            {
+                return static_cast<uint16_t>(i);
+            }
+        }
+        if (current == MAX_ALLOC_SLOTS)
+        {
+            return 0;
+        }
+        slots[current].phase = phase;
+        slots[current].category = category;
+        slotCount.store(current + 1, std::memory_order_release);
+        return static_cast<uint16_t>(current);
+    }
+
+    void add(AllocSlot &slot, size_t size)
+    {
+        slot.allocations.fetch_add(1, std::memory_order_relaxed);
+        slot.bytes.fetch_add(size, std::memory_order_relaxed);
+        size_t live = slot.live.fetch_add(size, std::memory_order_relaxed) + size;
+        size_t peak = slot.peak.load(std::memory_order_relaxed);
+        while (live > peak && !slot.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void reset(AllocSlot &slot)
+    {
+        slot.allocations.store(0, std::memory_order_relaxed);
+        slot.bytes.store(0, std::memory_order_relaxed);
+        slot.peak.store(slot.live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    AllocRecord toRecord(const AllocSlot &slot, const char *phase, const char *category)
+    {
+        return {phase, category, slot.allocations.load(std::memory_order_relaxed),
+                slot.bytes.load(std::memory_order_relaxed), slot.live.load(std::memory_order_relaxed),
+                slot.peak.load(std::memory_order_relaxed)};
+    }
+
+    // 终端中的显示宽度：三字节的UTF-8字符（中文）占两列，其余字符占一列
+    size_t displayWidth(const std::string &text)
+    {
+        size_t width = 0;
+        for (unsigned char c : text)
+        {
+            if ((c & 0xC0) != 0x80)
+            {
+                width += (c & 0xF0) == 0xE0 ? 2 : 1;
+            }
+        }
+        return width;
+    }
+
+    // 按显示宽度补齐到width列，left为true时左对齐
+    std::string pad(const std::string &text, size_t width, bool left)
+    {
+        size_t used = displayWidth(text);
+        std::string spaces(used < width ? width - used : 0, ' ');
+        return left ? text + spaces : spaces + text;
+    }
+
+    std::string formatBytes(size_t bytes)
+    {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(1);
+        if (bytes >= (1u << 20))
+            out << bytes / 1048576.0 << " MB";
+        else if (bytes >= 1024)
+            out << bytes / 1024.0 << " KB";
+        else
+            out << bytes << " B";
+        return out.str();
+    }
+}
+
+AllocPhase::AllocPhase(const char *name) : previousPhase(currentPhase), previousCategory(currentCategory)
+{
+    currentPhase = name;
+    currentCategory = nullptr;
+    dirty = true;
+}
+
+AllocPhase::~AllocPhase()
+{
+    currentPhase = previousPhase;
+    currentCategory = previousCategory;
+    dirty = true;
+}
+
+AllocCategory::AllocCategory(const char *name) : previous(currentCategory)
+{
+    currentCategory = name;
+    dirty = true;
+}
+
+AllocCategory::~AllocCategory()
+{
+    currentCategory = previous;
+    dirty = true;
+}
+
+bool allocStatsEnabled()
+{
+    return hookInstalled.load(std::memory_order_relaxed);
+}
+
+void markAllocHookInstalled()
+{
+    hookInstalled.store(true, std::memory_order_relaxed);
+}
+
+void recordAllocation(size_t size, uint16_t &slot, uint16_t &phaseSlot)
+{
+    if (dirty)
+    {
+        cachedSlot = findSlot(currentPhase, currentCategory);
+        cachedPhaseSlot = currentPhase ? findSlot(currentPhase, PHASE_TOTAL) : 0;
+        dirty = false;
+    }
+    slot = cachedSlot;
+    phaseSlot = cachedPhaseSlot;
+    add(slots[slot], size);
+    if (phaseSlot != slot)
+    {
+        add(slots[phaseSlot], size);
+    }
+    add(total, size);
+}
+
+void recordFree(size_t size, uint16_t slot, uint16_t phaseSlot)
+{
+    slots[slot].live.fetch_sub(size, std::memory_order_relaxed);
+    if (phaseSlot != slot)
+    {
+        slots[phaseSlot].live.fetch_sub(size, std::memory_order_relaxed);
+    }
+    total.live.fetch_sub(size, std::memory_order_relaxed);
+}
+
+void resetAllocStats()
+{
+    size_t count = slotCount.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; i++)
+    {
+        reset(slots[i]);
+    }
+    reset(total);
+}
+
+std::vector<AllocRecord> allocStatsSnapshot()
+{
+    size_t count = slotCount.load(std::memory_order_acquire);
+    std::vector<AllocRecord> records;
+    for (size_t i = 1; i < count; i++)
+    {
+        if (slots[i].category != PHASE_TOTAL)
+        {
+            continue;
+        }
+        const char *phase = slots[i].phase;
+        records.push_back(toRecord(slots[i], phase, ""));
+        for (size_t j = 1; j < count; j++)
+        {
+            if (j != i && slots[j].category != PHASE_TOTAL && sameName(slots[j].phase, phase))
+            {
+                records.push_back(toRecord(slots[j], phase, slots[j].category ? slots[j].category : "(其他)"));
+            }
+        }
+    }
+    records.push_back(toRecord(slots[0], "(未标记)", ""));
+    records.push_back(toRecord(total, "", ""));
+    return records;
+}
+
+void writeAllocReport(std::ostream &out, const std::string &indent)
+{
+    std::vector<AllocRecord> records = allocStatsSnapshot();
+    if (!allocStatsEnabled())
+    {
+        out << indent << "分配统计未启用（需要以 -DREGEXP_ALLOC_STATS=ON 构建）\n";
+        return;
+    }
+    out << indent << pad("阶段/数据结构", 32, true) << pad("次数", 12, false) << pad("字节", 14, false)
+        << pad("未释放", 14, false) << pad("峰值", 14, false) << "\n";
+    for (const AllocRecord &record : records)
+    {
+        if (record.allocations == 0 && record.liveBytes == 0 && !record.phase.empty())
+        {
+            continue;
+        }
+        std::string name = record.phase.empty()      ? "总计"
+                           : record.category.empty() ? record.phase
+                                                     : "  " + record.category;
+        out << indent << pad(name, 32, true) << pad(std::to_string(record.allocations), 12, false)
+            << pad(formatBytes(record.bytes), 14, false) << pad(formatBytes(record.liveBytes), 14, false)
+            << pad(formatBytes(record.peakBytes), 14, false) << "\n";
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef ALLOC_STATS_H
+#define ALLOC_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 按阶段和数据结构统计内存分配
+//
+// 构造过程用AllocPhase标出所处的阶段（buildNFA、buildDFA、minimizeDFA……），
+// 用AllocCategory标出正在增长的数据结构（stateSetToId、processedStates、Graph……），
+// 两者都只在当前线程内生效，离开作用域时恢复外层的标记。
+//
+// 计数由替换全局operator new/delete的alloc_hook.cpp完成，它只在以
+// -DREGEXP_ALLOC_STATS=ON构建时链接进可执行文件，未链接时allocStatsEnabled()返回false，统计全部为0。
+// 构造过程中的标记写成REGEXP_ALLOC_PHASE/REGEXP_ALLOC_CATEGORY，只在定义了宏REGEXP_ALLOC_STATS
+// （同名的CMake选项打开时由regexp_core传给所有使用者）时生成对象，默认构建中展开为空，
+// 子集构造等热循环里不留下线程局部变量的写入。
+// 标记名必须是字符串字面量或生命期足够长的字符串，统计中只保存指针。
+
+// 标记当前线程接下来的分配所属的阶段，同时清除数据结构标记
+class AllocPhase
+{
+public:
+    explicit AllocPhase(const char *name);
+    ~AllocPhase();
+
+    AllocPhase(const AllocPhase &) = delete;
+    AllocPhase &operator=(const AllocPhase &) = delete;
+
+private:
+    const char *previousPhase;
+    const char *previousCategory;
+};
+
+// 标记当前线程接下来的分配所属的数据结构
+class AllocCategory
+{
+public:
+    explicit AllocCategory(const char *name);
+    ~AllocCategory();
+
+    AllocCategory(const AllocCategory &) = delete;
+    AllocCategory &operator=(const AllocCategory &) = delete;
+
+private:
+    const char *previous;
+};
+
+#ifdef REGEXP_ALLOC_STATS
+#define REGEXP_ALLOC_CONCAT_IMPL(a, b) a##b
+#define REGEXP_ALLOC_CONCAT(a, b) REGEXP_ALLOC_CONCAT_IMPL(a, b)
+// 在当前作用域内标记阶段或数据结构，离开作用域时恢复
+#define REGEXP_ALLOC_PHASE(name) AllocPhase REGEXP_ALLOC_CONCAT(allocPhase, __LINE__)(name)
+#define REGEXP_ALLOC_CATEGORY(name) AllocCategory REGEXP_ALLOC_CONCAT(allocCategory, __LINE__)(name)
+#else
+#define REGEXP_ALLOC_PHASE(name)
+#define REGEXP_ALLOC_CATEGORY(name)
+#endif
+
+// 一行统计，category为空表示整个阶段的合计
+struct AllocRecord
+{
+    std::string phase;
+    std::string category;
+    size_t allocations; // 分配次数
+    size_t bytes;       // 分配的总字节数
+    size_t liveBytes;   // 尚未释放的字节数
+    size_t peakBytes;   // 尚未释放的字节数的峰值
+};
+
+// 计数的operator new/delete是否已经链接进程序
+bool allocStatsEnabled();
+// 清零分配次数与字节数，峰值从当前尚未释放的字节数重新开始
+void resetAllocStats();
+// 按阶段首次出现的顺序给出统计，每个阶段先是合计，再是其中的各个数据结构；
+// 最后一行的阶段为空，是全部分配的合计
+std::vector<AllocRecord> allocStatsSnapshot();
+// 以表格形式输出allocStatsSnapshot()中自上次清零以来有分配或仍未释放的行，每行以indent开头
+void writeAllocReport(std::ostream &out, const std::string &indent = "");
+
+// 以下供alloc_hook.cpp调用：记录一次分配，返回要保存在分配块中、释放时交回的两个统计槽位
+void recordAllocation(size_t size, uint16_t &slot, uint16_t &phaseSlot);
+void recordFree(size_t size, uint16_t slot, uint16_t phaseSlot);
+void markAllocHookInstalled();
+
+#endif // ALLOC_STATS_H
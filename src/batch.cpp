@@ -0,0 +1,315 @@
+#include "batch.h"
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define REGEXP_PREFETCH(address) __builtin_prefetch(address)
+#elif defined(_MSC_VER)
+#include <xmmintrin.h>
+#define REGEXP_PREFETCH(address) _mm_prefetch(reinterpret_cast<const char *>(address), _MM_HINT_T0)
+#else
+#define REGEXP_PREFETCH(address) ((void)0)
+#endif
+
+namespace
+{
+    // 转换表超过该大小（约为L2缓存）时才做软件预取
+    const size_t PREFETCH_THRESHOLD = 256 * 1024;
+
+    // 一路输入的匹配进度
+    struct Lane
+    {
+        const unsigned char *cursor;
+        const unsigned char *end;
+        int state;
+        size_t index;
+    };
+
+    // 依次取出待匹配的输入，空输入直接得到结果
+    // 输入既可以是字符串数组，也可以是指针与长度数组
+    class InputQueue
+    {
+    public:
+        InputQueue(const DFATable &table, const std::string *strings, size_t count, char *results)
+            : table(table), strings(strings), data(nullptr), lengths(nullptr),
+              count(count), results(results), next(0) {}
+        InputQueue(const DFATable &table, const char *const *data, const size_t *lengths,
+                   size_t count, char *results)
+            : table(table), strings(nullptr), data(data), lengths(lengths),
+              count(count), results(results), next(0) {}
+
+        bool refill(Lane &lane)
+        {
+            while (next < count)
+            {
+                size_t i = next++;
+                const char *begin = strings ? strings[i].data() : data[i];
+                size_t length = strings ? strings[i].size() : lengths[i];
+                if (length == 0)
+                {
+                    results[i] = table.isAccept(table.getInitialState());
+                    continue;
+                }
+                lane.cursor = reinterpret_cast<const unsigned char *>(begin);
+                lane.end = lane.cursor + length;
+                lane.state = table.getInitialState();
+                lane.index = i;
+                return true;
+            }
+            return false;
+        }
+
+        void finish(const Lane &lane, int state)
+        {
+            results[lane.index] = state != table.getDeadState() && table.isAccept(state);
+        }
+
+        // 逐个匹配剩余的全部输入
+        void matchRemaining()
+        {
+            for (; next < count; next++)
+            {
+                results[next] = strings ? table.match(strings[next]) : table.match(data[next], lengths[next]);
+            }
+        }
+
+    private:
+        const DFATable &table;
+        const std::string *strings;
+        const char *const *data;
+        const size_t *lengths;
+        size_t count;
+        char *results;
+        size_t next;
+    };
+
+    // 逐路推进直到读完或进入死状态，用于收尾
+    void drainLane(const DFATable &table, InputQueue &queue, Lane &lane)
+    {
+        int state = lane.state;
+        while (lane.cursor != lane.end && state != table.getDeadState())
+        {
+            state = table.getNextState(state, *lane.cursor++);
+        }
+        queue.finish(lane, state);
+    }
+
+    // 标量交错推进：Width路轮流各走一步，各路的查表互不依赖，可以被处理器重叠执行。
+    // 某一路读完或进入死状态时立即结算并换入下一个输入，这一分支很少发生，预测代价很低。
+    // 输入不足以填满所有路之后，剩余的路逐个收尾
+    template <size_t Width>
+    void runScalar(const DFATable &table, InputQueue &queue)
+    {
+        const int *transitions = table.getTransitions().data();
+        const uint8_t *classes = table.getByteClasses().data();
+        const size_t classCount = static_cast<size_t>(table.getClassCount());
+        const int deadState = table.getDeadState();
+        const bool prefetch = table.memoryUsage() > PREFETCH_THRESHOLD;
+
+        // 各路的进度分开存放在数组中，内层循环只访问这几个数组
+        const unsigned char *cursors[Width];
+        const unsigned char *ends[Width];
+        int states[Width];
+        size_t indices[Width];
+        Lane lane;
+        auto load = [&](size_t k)
+        {
+            if (!queue.refill(lane))
+            {
+                return false;
+            }
+            cursors[k] = lane.cursor;
+            ends[k] = lane.end;
+            states[k] = lane.state;
+            indices[k] = lane.index;
+            return true;
+        };
+        auto store = [&](size_t k)
+        {
+            lane.cursor = cursors[k];
+            lane.end = ends[k];
+            lane.state = states[k];
+            lane.index = indices[k];
+            return lane;
+        };
+
+        size_t active = 0;
+        while (active < Width && load(active))
+        {
+            active++;
+        }
+        if (active < Width)
+        {
+            for (size_t k = 0; k < active; k++)
+            {
+                Lane pending = store(k);
+                drainLane(table, queue, pending);
+            }
+            return;
+        }
+
+        size_t exhausted = Width; // 第一个无法换入新输入的路
+        while (exhausted == Width)
+        {
+            for (size_t k = 0; k < Width; k++)
+            {
+                int state = transitions[static_cast<size_t>(states[k]) * classCount + classes[*cursors[k]++]];
+                states[k] = state;
+                if (cursors[k] == ends[k] || state == deadState)
+                {
+                    queue.finish(store(k), state);
+                    if (!load(k))
+                    {
+                        exhausted = k;
+                        break;
+                    }
+                }
+                else if (prefetch)
+                {
+                    // 转换表放不进缓存时，下一步要读的表项此时已经确定，提前预取
+                    REGEXP_PREFETCH(&transitions[static_cast<size_t>(state) * classCount + classes[*cursors[k]]]);
+                }
+            }
+        }
+
+        for (size_t k = 0; k < Width; k++)
+        {
+            if (k != exhausted)
+            {
+                Lane pending = store(k);
+                drainLane(table, queue, pending);
+            }
+        }
+    }
+
+#if defined(__AVX2__)
+    // AVX2路径：8路状态放在一个向量中，每步用一次gather完成8次查表。
+    // 返回时lanes前若干路仍在进行，由调用方逐个收尾
+    size_t runGather(const DFATable &table, InputQueue &queue, Lane *lanes)
+    {
+        const int *transitions = table.getTransitions().data();
+        const uint8_t *classes = table.getByteClasses().data();
+        const __m256i classCount = _mm256_set1_epi32(table.getClassCount());
+        const int deadState = table.getDeadState();
+        const size_t width = 8;
+
+        for (size_t k = 0; k < width; k++)
+        {
+            if (!queue.refill(lanes[k]))
+            {
+                return k;
+            }
+        }
+
+        alignas(32) int states[8];
+        alignas(32) int symbols[8];
+        for (size_t k = 0; k < width; k++)
+        {
+            states[k] = lanes[k].state;
+        }
+        __m256i stateVector = _mm256_load_si256(reinterpret_cast<const __m256i *>(states));
+        while (true)
+        {
+            for (size_t k = 0; k < width; k++)
+            {
+                symbols[k] = classes[*lanes[k].cursor++];
+            }
+            __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(stateVector, classCount),
+                                             _mm256_load_si256(reinterpret_cast<const __m256i *>(symbols)));
+            stateVector = _mm256_i32gather_epi32(transitions, index, 4);
+            _mm256_store_si256(reinterpret_cast<__m256i *>(states), stateVector);
+
+            bool changed = false;
+            for (size_t k = 0; k < width; k++)
+            {
+                if (lanes[k].cursor == lanes[k].end || states[k] == deadState)
+                {
+                    queue.finish(lanes[k], states[k]);
+                    if (!queue.refill(lanes[k]))
+                    {
+                        // 输入不足8路：已结算的路与最后一路交换，其余的逐个收尾
+                        for (size_t j = 0; j < width; j++)
+                        {
+                            lanes[j].state = states[j];
+                        }
+                        std::swap(lanes[k], lanes[width - 1]);
+                        return width - 1;
+                    }
+                    states[k] = lanes[k].state;
+                    changed = true;
+                }
+            }
+            if (changed)
+            {
+                stateVector = _mm256_load_si256(reinterpret_cast<const __m256i *>(states));
+            }
+        }
+    }
+#endif
+
+    void runBatch(const DFATable &table, InputQueue &queue, size_t count)
+    {
+        if (!batchInterleaves(table, count))
+        {
+            queue.matchRemaining();
+            return;
+        }
+#if defined(__AVX2__)
+        // gather路径结束时输入已经取完，剩余的路逐个收尾
+        Lane lanes[8];
+        size_t active = runGather(table, queue, lanes);
+        for (size_t k = 0; k < active; k++)
+        {
+            drainLane(table, queue, lanes[k]);
+        }
+#else
+        runScalar<BATCH_LANES>(table, queue);
+#endif
+    }
+}
+
+bool batchInterleaves(const DFATable &table, size_t count)
+{
+    return count >= BATCH_LANES && table.memoryUsage() > BATCH_INTERLEAVE_MIN_TABLE_BYTES;
+}
+
+void matchBatch(const DFATable &table, const std::vector<std::string> &inputs, std::vector<char> &results)
+{
+    results.assign(inputs.size(), 0);
+    InputQueue queue(table, inputs.data(), inputs.size(), results.data());
+    runBatch(table, queue, inputs.size());
+}
+
+void matchBatch(const DFATable &table, const char *const *data, const size_t *lengths,
+                size_t count, char *results)
+{
+    InputQueue queue(table, data, lengths, count, results);
+    runBatch(table, queue, count);
+}
+
+void matchBatchParallel(const DFATable &table, const std::vector<std::string> &inputs,
+                        std::vector<char> &results, ThreadPool &pool)
+{
+    results.assign(inputs.size(), 0);
+
+    // 每个线程分得若干片，片数多于线程数以平衡不同长度的输入
+    size_t shardCount = std::max<size_t>(1, std::min(inputs.size() / 1024, pool.size() * 4));
+    size_t shardSize = (inputs.size() + shardCount - 1) / shardCount;
+    std::vector<std::future<void>> pending;
+    for (size_t begin = 0; begin < inputs.size(); begin += shardSize)
+    {
+        size_t count = std::min(shardSize, inputs.size() - begin);
+        pending.push_back(pool.submit([&table, &inputs, &results, begin, count]
+                                      {
+                                          InputQueue queue(table, inputs.data() + begin, count, results.data() + begin);
+                                          runBatch(table, queue, count); }));
+    }
+    for (auto &future : pending)
+    {
+        future.get();
+    }
+}
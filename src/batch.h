@@ -0,0 +1,37 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "dfa_table.h"
+#include "thread_pool.h"
+#include <string>
+#include <vector>
+
+// 多路交错的批量匹配
+//
+// 单个字符串的匹配每读一个字节都要等待一次依赖于上一步结果的查表，
+// 受限于访存延迟。这里同时推进 BATCH_LANES 个互不相关的输入，
+// 各路的查表相互独立，可以被处理器并行发出；每一步还会预取下一步要访问的表行。
+// 某一路结束后立即换入下一个输入，因此各输入长度不同也不会空转。
+// 使用 -mavx2 编译（REGEXP_ENABLE_AVX2）时，长度足够的部分改用AVX2 gather一次推进8路。
+//
+// 转换表能放进L1数据缓存时查表只需几个周期，交错带来的换入换出与分支开销抵消了重叠的收益
+// （bench/batch_bench中11个状态的表两者的吞吐量相同，4097个状态约48KB的表交错快约12%，
+// 65537个状态的表快约40%）；输入不足BATCH_LANES个时也填不满各路。这两种情况下退回逐个匹配。
+
+const size_t BATCH_LANES = 16;
+// 转换表（含字节类与接受标记）不超过该大小时不交错，约为L1数据缓存的大小
+const size_t BATCH_INTERLEAVE_MIN_TABLE_BYTES = 32 * 1024;
+
+// 对count个输入批量匹配时是否交错推进
+bool batchInterleaves(const DFATable &table, size_t count);
+
+// results[i]为1表示inputs[i]被完整接受
+void matchBatch(const DFATable &table, const std::vector<std::string> &inputs, std::vector<char> &results);
+void matchBatch(const DFATable &table, const char *const *data, const size_t *lengths,
+                size_t count, char *results);
+
+// 将大批量输入分片到线程池的各个线程上
+void matchBatchParallel(const DFATable &table, const std::vector<std::string> &inputs,
+                        std::vector<char> &results, ThreadPool &pool);
+
+#endif // BATCH_H
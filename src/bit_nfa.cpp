@@ -0,0 +1,310 @@
+#include "bit_nfa.h"
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    // 每个字分成8组，每组8位
+    const int CHUNK_BITS = 8;
+    const int CHUNKS_PER_WORD = 64 / CHUNK_BITS;
+    // 分组follow表的大小上限（字节），位置数不超过512时可以建表
+    const size_t FOLLOW_TABLE_LIMIT = 1 << 20;
+
+    int countTrailingZeros(uint64_t value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(value);
+#elif defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return static_cast<int>(index);
+#else
+        int count = 0;
+        while ((value & 1) == 0)
+        {
+            value >>= 1;
+            count++;
+        }
+        return count;
+#endif
+    }
+}
+
+BitNFA::BitNFA()
+    : positionCount(0), wordCount(1), acceptsEmpty(false),
+      firstMask(1, 0), acceptMask(1, 0), byteMasks(256, 0), followTable(CHUNKS_PER_WORD * 256, 0)
+{
+}
+
+BitNFA::BitNFA(const std::shared_ptr<Graph> &nfa)
+{
+    // 将NFA状态重新编号为连续的整数
+    std::unordered_map<int, int> stateMap;
+    for (int state : nfa->getAllStates())
+    {
+        stateMap.emplace(state, static_cast<int>(stateMap.size()));
+    }
+    for (const Edge &edge : nfa->getEdges())
+    {
+        stateMap.emplace(edge.u, static_cast<int>(stateMap.size()));
+        stateMap.emplace(edge.v, static_cast<int>(stateMap.size()));
+    }
+    size_t stateCount = stateMap.size();
+
+    // 每一对以非ε边相连的状态是一个位置，收集ε边的邻接表
+    std::vector<std::vector<int>> epsilonEdges(stateCount);
+    std::map<std::pair<int, int>, int> positionIndex;
+    std::vector<std::pair<int, int>> positions;
+    std::vector<std::vector<unsigned char>> positionBytes;
+    for (const Edge &edge : nfa->getEdges())
+    {
+        int u = stateMap[edge.u];
+        int v = stateMap[edge.v];
+        if (edge.epsilon)
+        {
+            epsilonEdges[u].push_back(v);
+            continue;
+        }
+        auto it = positionIndex.find({u, v});
+        if (it == positionIndex.end())
+        {
+            it = positionIndex.emplace(std::make_pair(u, v), static_cast<int>(positions.size())).first;
+            positions.emplace_back(u, v);
+            positionBytes.emplace_back();
+        }
+        positionBytes[it->second].push_back(static_cast<unsigned char>(edge.w));
+    }
+    positionCount = positions.size();
+    wordCount = std::max<size_t>(1, (positionCount + 63) / 64);
+
+    std::vector<std::vector<int>> positionsFrom(stateCount);
+    for (size_t p = 0; p < positionCount; p++)
+    {
+        positionsFrom[positions[p].first].push_back(static_cast<int>(p));
+    }
+    std::vector<char> isAccept(stateCount, 0);
+    for (int state : nfa->getAcceptStates())
+    {
+        if (stateMap.count(state))
+        {
+            isAccept[stateMap[state]] = 1;
+        }
+    }
+
+    // 计算从state出发的ε闭包可以到达的位置集合，写入bits；返回闭包中是否有接受状态
+    std::vector<int> visited(stateCount, -1);
+    std::vector<int> stack;
+    int stamp = 0;
+    auto closure = [&](int state, uint64_t *bits)
+    {
+        bool accept = false;
+        stamp++;
+        stack.assign(1, state);
+        visited[state] = stamp;
+        while (!stack.empty())
+        {
+            int current = stack.back();
+            stack.pop_back();
+            accept = accept || isAccept[current];
+            for (int p : positionsFrom[current])
+            {
+                bits[p / 64] |= uint64_t(1) << (p % 64);
+            }
+            for (int next : epsilonEdges[current])
+            {
+                if (visited[next] != stamp)
+                {
+                    visited[next] = stamp;
+                    stack.push_back(next);
+                }
+            }
+        }
+        return accept;
+    };
+
+    firstMask.assign(wordCount, 0);
+    acceptMask.assign(wordCount, 0);
+    acceptsEmpty = stateMap.count(nfa->getInitialState()) &&
+                   closure(stateMap[nfa->getInitialState()], firstMask.data());
+
+    // 终点相同的位置follow集合相同，每个终点只计算一次闭包
+    follow.assign(positionCount * wordCount, 0);
+    std::unordered_map<int, size_t> closureOfTarget;
+    for (size_t p = 0; p < positionCount; p++)
+    {
+        uint64_t *bits = &follow[p * wordCount];
+        auto it = closureOfTarget.find(positions[p].second);
+        bool accept;
+        if (it != closureOfTarget.end())
+        {
+            std::copy(&follow[it->second * wordCount], &follow[(it->second + 1) * wordCount], bits);
+            accept = (acceptMask[it->second / 64] >> (it->second % 64)) & 1;
+        }
+        else
+        {
+            accept = closure(positions[p].second, bits);
+            closureOfTarget.emplace(positions[p].second, p);
+        }
+        if (accept)
+        {
+            acceptMask[p / 64] |= uint64_t(1) << (p % 64);
+        }
+    }
+
+    byteMasks.assign(256 * wordCount, 0);
+    for (size_t p = 0; p < positionCount; p++)
+    {
+        for (unsigned char c : positionBytes[p])
+        {
+            byteMasks[c * wordCount + p / 64] |= uint64_t(1) << (p % 64);
+        }
+    }
+
+    // 预先计算每组8位的所有取值对应的follow并集，表的大小随字数平方增长，超过上限时不建表
+    size_t tableWords = CHUNKS_PER_WORD * wordCount * 256 * wordCount;
+    if (tableWords * sizeof(uint64_t) <= FOLLOW_TABLE_LIMIT)
+    {
+        followTable.assign(tableWords, 0);
+        for (size_t chunk = 0; chunk < CHUNKS_PER_WORD * wordCount; chunk++)
+        {
+            uint64_t *table = &followTable[chunk * 256 * wordCount];
+            for (int value = 1; value < 256; value++)
+            {
+                // 由去掉最低位的取值递推
+                size_t p = chunk * CHUNK_BITS + countTrailingZeros(static_cast<uint64_t>(value));
+                const uint64_t *previous = &table[(value & (value - 1)) * wordCount];
+                uint64_t *current = &table[value * wordCount];
+                for (size_t w = 0; w < wordCount; w++)
+                {
+                    current[w] = previous[w] | (p < positionCount ? follow[p * wordCount + w] : 0);
+                }
+            }
+        }
+    }
+}
+
+bool BitNFA::match(const std::string &input) const
+{
+    return match(input.data(), input.size());
+}
+
+bool BitNFA::match(const char *data, size_t length) const
+{
+    if (length == 0)
+    {
+        return acceptsEmpty;
+    }
+    return wordCount == 1 ? matchSingle(data, length) : matchMulti(data, length);
+}
+
+bool BitNFA::matchSingle(const char *data, size_t length) const
+{
+    const uint64_t *masks = byteMasks.data();
+    const uint64_t *table = followTable.data();
+    const int chunks = static_cast<int>((positionCount + CHUNK_BITS - 1) / CHUNK_BITS);
+
+    uint64_t active = firstMask[0] & masks[static_cast<unsigned char>(data[0])];
+    for (size_t i = 1; i < length; i++)
+    {
+        if (active == 0)
+        {
+            return false;
+        }
+        uint64_t reach = 0;
+        for (int chunk = 0; chunk < chunks; chunk++)
+        {
+            reach |= table[chunk * 256 + ((active >> (chunk * CHUNK_BITS)) & 0xFF)];
+        }
+        active = reach & masks[static_cast<unsigned char>(data[i])];
+    }
+    return (active & acceptMask[0]) != 0;
+}
+
+bool BitNFA::matchMulti(const char *data, size_t length) const
+{
+    const size_t words = wordCount;
+    std::vector<uint64_t> active(words);
+    std::vector<uint64_t> reach(words);
+
+    const uint64_t *mask = &byteMasks[static_cast<unsigned char>(data[0]) * words];
+    for (size_t w = 0; w < words; w++)
+    {
+        active[w] = firstMask[w] & mask[w];
+    }
+    const bool useTable = !followTable.empty();
+    for (size_t i = 1; i < length; i++)
+    {
+        std::fill(reach.begin(), reach.end(), 0);
+        bool any = false;
+        for (size_t w = 0; w < words; w++)
+        {
+            if (active[w] == 0)
+                continue;
+            any = true;
+            if (useTable)
+            {
+                // 按8位一组查表，每组得到一个完整的follow并集
+                for (int k = 0; k < CHUNKS_PER_WORD; k++)
+                {
+                    size_t chunk = w * CHUNKS_PER_WORD + k;
+                    const uint64_t *row = &followTable[(chunk * 256 + ((active[w] >> (k * CHUNK_BITS)) & 0xFF)) * words];
+                    for (size_t j = 0; j < words; j++)
+                    {
+                        reach[j] |= row[j];
+                    }
+                }
+            }
+            else
+            {
+                // 表太大时逐个取出活跃位置合并follow集合
+                for (uint64_t bits = active[w]; bits != 0; bits &= bits - 1)
+                {
+                    const uint64_t *row = &follow[(w * 64 + countTrailingZeros(bits)) * words];
+                    for (size_t j = 0; j < words; j++)
+                    {
+                        reach[j] |= row[j];
+                    }
+                }
+            }
+        }
+        if (!any)
+        {
+            return false;
+        }
+        mask = &byteMasks[static_cast<unsigned char>(data[i]) * words];
+        for (size_t w = 0; w < words; w++)
+        {
+            active[w] = reach[w] & mask[w];
+        }
+    }
+    for (size_t w = 0; w < words; w++)
+    {
+        if (active[w] & acceptMask[w])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t BitNFA::getPositionCount() const
+{
+    return positionCount;
+}
+
+size_t BitNFA::getWordCount() const
+{
+    return wordCount;
+}
+
+size_t BitNFA::memoryUsage() const
+{
+    return sizeof(*this) + (firstMask.capacity() + acceptMask.capacity() + byteMasks.capacity() +
+                            follow.capacity() + followTable.capacity()) *
+                               sizeof(uint64_t);
+}
@@ -0,0 +1,52 @@
+#ifndef BIT_NFA_H
+#define BIT_NFA_H
+
+#include "graph.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 位并行NFA模拟
+//
+// 不做确定化，直接以位向量表示NFA的当前状态集合，用于子集构造超出资源上限的模式。
+// 采用Glushkov形式：Thompson NFA中每一对以非ε边相连的状态(u, v)是一个“位置”，
+// 边上的全部字节构成该位置的字节集合。位向量D记录刚刚读过的字节可能对应的位置，
+// 读入字节c时
+//   D' = (D == 初始 ? first : ∪ follow(p), p ∈ D) & mask[c]
+// 其中follow(p)为从v出发经ε闭包可以到达的位置，mask[c]为字节集合含c的位置。
+// follow的并集按D的每8位一组预先制表，每组一次查表。
+// 位置数不超过64时D是一个64位整数，每个字节至多8次查表；
+// 更多的位置使用多字位向量，表的大小随字数平方增长，超过上限时改为逐个取出D中的位合并follow。
+// 匹配时间与输入长度成线性，内存只与位置数有关。
+class BitNFA
+{
+public:
+    BitNFA();
+    explicit BitNFA(const std::shared_ptr<Graph> &nfa);
+
+    // 判断整个输入是否被接受
+    bool match(const std::string &input) const;
+    bool match(const char *data, size_t length) const;
+
+    // 位置数与位向量的字数
+    size_t getPositionCount() const;
+    size_t getWordCount() const;
+    // 占用的字节数
+    size_t memoryUsage() const;
+
+private:
+    bool matchSingle(const char *data, size_t length) const;
+    bool matchMulti(const char *data, size_t length) const;
+
+    size_t positionCount;              // 位置数
+    size_t wordCount;                  // 位向量的64位字数
+    bool acceptsEmpty;                 // 是否接受空串
+    std::vector<uint64_t> firstMask;   // 可以作为第一个字节的位置
+    std::vector<uint64_t> acceptMask;  // 读完后可以接受的位置
+    std::vector<uint64_t> byteMasks;   // 每个字节对应的位置集合，256 × wordCount
+    std::vector<uint64_t> follow;      // 每个位置的follow集合，positionCount × wordCount
+    std::vector<uint64_t> followTable; // 按8位分组的follow并集，(8 × wordCount) × 256 × wordCount
+};
+
+#endif // BIT_NFA_H
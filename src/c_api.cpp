@@ -0,0 +1,272 @@
+#include "c_api.h"
+#include "nfa.h"
+#include "dfa.h"
+#include "lexer.h"
+#include <algorithm>
+#include <limits>
+#include <new>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+    // 一个自动机的扁平表示
+    struct FlatAutomaton
+    {
+        int initialState = -1;
+        std::vector<int> states;
+        std::vector<int> edges; // 每条边三个int：起点、终点、符号
+        std::vector<int> accepts;
+    };
+
+    FlatAutomaton flatten(const std::shared_ptr<Graph> &graph)
+    {
+        FlatAutomaton flat;
+        flat.initialState = graph->getInitialState();
+        auto states = graph->getAllStates();
+        flat.states.assign(states.begin(), states.end());
+        flat.accepts.assign(graph->getAcceptStates().begin(), graph->getAcceptStates().end());
+
+        // 边按(起点, 符号, 终点)排序并去重，输出与构造过程中的加边顺序无关
+        std::vector<std::tuple<int, int, int>> edges;
+        edges.reserve(graph->getEdges().size());
+        for (const auto &edge : graph->getEdges())
+        {
+            int symbol = edge.epsilon ? REGEXP_EPSILON : static_cast<unsigned char>(edge.w);
+            edges.emplace_back(edge.u, symbol, edge.v);
+        }
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+        flat.edges.reserve(edges.size() * 3);
+        for (const auto &edge : edges)
+        {
+            flat.edges.push_back(std::get<0>(edge));
+            flat.edges.push_back(std::get<2>(edge));
+            flat.edges.push_back(std::get<1>(edge));
+        }
+        return flat;
+    }
+}
+
+struct regexp_result
+{
+    std::string error;
+    bool failed = false;
+    FlatAutomaton automata[3];
+};
+
+namespace
+{
+    const FlatAutomaton *getAutomaton(const regexp_result *result, int kind)
+    {
+        if (!result || result->failed || kind < REGEXP_NFA || kind > REGEXP_MIN_DFA)
+        {
+            return nullptr;
+        }
+        return &result->automata[kind];
+    }
+}
+
+int regexp_api_version(void)
+{
+    return REGEXP_API_VERSION;
+}
+
+regexp_result *regexp_compile(const char *pattern, size_t length)
+{
+    regexp_result *result = new (std::nothrow) regexp_result;
+    if (!result)
+    {
+        return nullptr;
+    }
+    try
+    {
+        std::string regex(pattern ? pattern : "", pattern ? length : 0);
+        NFABuilder nfaBuilder;
+        auto nfa = nfaBuilder.buildNFA(regex);
+        DFABuilder dfaBuilder;
+        auto dfa = dfaBuilder.buildDFA(nfa);
+        auto minDfa = dfaBuilder.minimizeDFA(dfa);
+
+        result->automata[REGEXP_NFA] = flatten(nfa);
+        result->automata[REGEXP_DFA] = flatten(dfa);
+        result->automata[REGEXP_MIN_DFA] = flatten(minDfa);
+    }
+    catch (const std::bad_alloc &)
+    {
+        delete result;
+        return nullptr;
+    }
+    catch (const std::exception &e)
+    {
+        result->failed = true;
+        result->error = e.what();
+    }
+    catch (...)
+    {
+        result->failed = true;
+        result->error = "unknown error";
+    }
+    return result;
+}
+
+void regexp_free(regexp_result *result)
+{
+    delete result;
+}
+
+const char *regexp_error(const regexp_result *result)
+{
+    if (!result)
+    {
+        return "null result";
+    }
+    return result->failed ? result->error.c_str() : nullptr;
+}
+
+int regexp_initial_state(const regexp_result *result, int kind)
+{
+    const FlatAutomaton *automaton = getAutomaton(result, kind);
+    return automaton ? automaton->initialState : -1;
+}
+
+size_t regexp_state_count(const regexp_result *result, int kind)
+{
+    const FlatAutomaton *automaton = getAutomaton(result, kind);
+    return automaton ? automaton->states.size() : 0;
+}
+
+const int *regexp_states(const regexp_result *result, int kind)
+{
+    const FlatAutomaton *automaton = getAutomaton(result, kind);
+    return automaton && !automaton->states.empty() ? automaton->states.data() : nullptr;
+}
+
+size_t regexp_edge_count(const regexp_result *result, int kind)
+{
+    const FlatAutomaton *automaton = getAutomaton(result, kind);
+    return automaton ? automaton->edges.size() / 3 : 0;
+}
+
+const int *regexp_edges(const regexp_result *result, int kind)
+{
+    const FlatAutomaton *automaton = getAutomaton(result, kind);
+    return automaton && !automaton->edges.empty() ? automaton->edges.data() : nullptr;
+}
+
+size_t regexp_accept_count(const regexp_result *result, int kind)
+{
+    const FlatAutomaton *automaton = getAutomaton(result, kind);
+    return automaton ? automaton->accepts.size() : 0;
+}
+
+const int *regexp_accepts(const regexp_result *result, int kind)
+{
+    const FlatAutomaton *automaton = getAutomaton(result, kind);
+    return automaton && !automaton->accepts.empty() ? automaton->accepts.data() : nullptr;
+}
+
+struct regexp_lexer
+{
+    std::string error;
+    bool failed = false;
+    Lexer lexer;
+};
+
+// 记号逐个字段复制到调用方的数组，regexp_token的各字段必须容得下LexToken的取值
+static_assert(std::numeric_limits<decltype(regexp_token::rule)>::max() >=
+                      std::numeric_limits<decltype(LexToken::rule)>::max() &&
+                  std::numeric_limits<decltype(regexp_token::rule)>::min() <=
+                      std::numeric_limits<decltype(LexToken::rule)>::min(),
+              "regexp_token::rule容纳不下规则号");
+static_assert(std::numeric_limits<decltype(regexp_token::offset)>::max() >=
+                      std::numeric_limits<decltype(LexToken::offset)>::max() &&
+                  std::numeric_limits<decltype(regexp_token::length)>::max() >=
+                      std::numeric_limits<decltype(LexToken::length)>::max(),
+              "regexp_token容纳不下记号的偏移和长度");
+
+regexp_lexer *regexp_lexer_compile(const char *const *rules, const size_t *lengths, size_t count)
+{
+    regexp_lexer *result = new (std::nothrow) regexp_lexer;
+    if (!result)
+    {
+        return nullptr;
+    }
+    try
+    {
+        std::vector<std::string> patterns;
+        for (size_t i = 0; i < count; i++)
+        {
+            patterns.emplace_back(rules && rules[i] ? rules[i] : "", rules && rules[i] && lengths ? lengths[i] : 0);
+        }
+        result->lexer = Lexer(patterns);
+    }
+    catch (const std::bad_alloc &)
+    {
+        delete result;
+        return nullptr;
+    }
+    catch (const std::exception &e)
+    {
+        result->failed = true;
+        result->error = e.what();
+    }
+    catch (...)
+    {
+        result->failed = true;
+        result->error = "unknown error";
+    }
+    return result;
+}
+
+void regexp_lexer_free(regexp_lexer *lexer)
+{
+    delete lexer;
+}
+
+const char *regexp_lexer_error(const regexp_lexer *lexer)
+{
+    if (!lexer)
+    {
+        return "null lexer";
+    }
+    return lexer->failed ? lexer->error.c_str() : nullptr;
+}
+
+size_t regexp_lexer_tokenize(const regexp_lexer *lexer, const char *data, size_t length,
+                             regexp_token *tokens, size_t capacity, size_t *consumed)
+{
+    size_t done = 0;
+    size_t count = 0;
+    if (lexer && !lexer->failed && (data || length == 0) && (tokens || capacity == 0))
+    {
+        // regexp_token与LexToken布局相同但类型不同，不能互相别名访问：
+        // 分段切分到栈上的LexToken数组，再逐个字段复制到调用方的数组，过程中不分配内存
+        LexToken chunk[256];
+        const size_t chunkCapacity = sizeof(chunk) / sizeof(chunk[0]);
+        while (count < capacity)
+        {
+            size_t limit = std::min(chunkCapacity, capacity - count);
+            size_t chunkDone = 0;
+            size_t produced = lexer->lexer.tokenize(data + done, length - done, chunk, limit, chunkDone);
+            for (size_t i = 0; i < produced; i++)
+            {
+                tokens[count + i].rule = chunk[i].rule;
+                tokens[count + i].offset = done + chunk[i].offset;
+                tokens[count + i].length = chunk[i].length;
+            }
+            count += produced;
+            done += chunkDone;
+            if (produced < limit)
+            {
+                break;
+            }
+        }
+    }
+    if (consumed)
+    {
+        *consumed = done;
+    }
+    return count;
+}
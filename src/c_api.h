@@ -0,0 +1,94 @@
+#ifndef C_API_H
+#define C_API_H
+
+#include <stddef.h>
+
+// 稳定的C接口，供Python(ctypes)等其他语言在进程内调用
+//
+// 一次编译得到NFA、DFA、最小化DFA三个自动机，每个自动机以扁平数组的形式给出：
+//   状态：升序排列的状态号
+//   边：每条边占三个int，依次为起点、终点、符号；符号为0-255的字节值，ε转换为REGEXP_EPSILON
+//   接受状态：升序排列的状态号
+// 返回的数组归结果对象所有，在regexp_free之前一直有效。
+// 所有函数都不会抛出异常。
+
+#if defined(_WIN32)
+#if defined(REGEXP_BUILDING_SHARED)
+#define REGEXP_API __declspec(dllexport)
+#else
+#define REGEXP_API __declspec(dllimport)
+#endif
+#elif defined(__GNUC__) || defined(__clang__)
+#define REGEXP_API __attribute__((visibility("default")))
+#else
+#define REGEXP_API
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// 接口版本号，不兼容的修改时递增
+#define REGEXP_API_VERSION 1
+
+// ε转换在边数组中的符号值
+#define REGEXP_EPSILON (-1)
+
+// 自动机的种类
+#define REGEXP_NFA 0
+#define REGEXP_DFA 1
+#define REGEXP_MIN_DFA 2
+
+    // 编译结果，内部结构不对外公开
+    typedef struct regexp_result regexp_result;
+
+    REGEXP_API int regexp_api_version(void);
+
+    // 编译长度为length的正则表达式（不要求以'\0'结尾）。
+    // 只有内存不足时返回NULL；正则表达式有误时返回的结果带有错误信息
+    REGEXP_API regexp_result *regexp_compile(const char *pattern, size_t length);
+    REGEXP_API void regexp_free(regexp_result *result);
+
+    // 编译成功时返回NULL，否则返回UTF-8编码的错误信息
+    REGEXP_API const char *regexp_error(const regexp_result *result);
+
+    // 以下函数的kind为REGEXP_NFA、REGEXP_DFA或REGEXP_MIN_DFA；
+    // kind无效或编译失败时计数为0、数组为NULL、初始状态为-1
+    REGEXP_API int regexp_initial_state(const regexp_result *result, int kind);
+    REGEXP_API size_t regexp_state_count(const regexp_result *result, int kind);
+    REGEXP_API const int *regexp_states(const regexp_result *result, int kind);
+    REGEXP_API size_t regexp_edge_count(const regexp_result *result, int kind);
+    REGEXP_API const int *regexp_edges(const regexp_result *result, int kind);
+    REGEXP_API size_t regexp_accept_count(const regexp_result *result, int kind);
+    REGEXP_API const int *regexp_accepts(const regexp_result *result, int kind);
+
+    // 词法分析器：按优先级排列的一组记号规则，最长匹配，长度相同时前面的规则优先
+    typedef struct regexp_lexer regexp_lexer;
+
+    // 一个记号：规则下标与字节范围
+    typedef struct regexp_token
+    {
+        int rule;
+        size_t offset;
+        size_t length;
+    } regexp_token;
+
+    // 编译count条规则，第i条规则为rules[i]开始的lengths[i]个字节。
+    // 只有内存不足时返回NULL；规则有误时返回的对象带有错误信息
+    REGEXP_API regexp_lexer *regexp_lexer_compile(const char *const *rules, const size_t *lengths, size_t count);
+    REGEXP_API void regexp_lexer_free(regexp_lexer *lexer);
+    // 编译成功时返回NULL，否则返回UTF-8编码的错误信息
+    REGEXP_API const char *regexp_lexer_error(const regexp_lexer *lexer);
+
+    // 从data开头切分记号，写入调用方分配的tokens，最多capacity个。
+    // 返回写入的记号数，consumed（可为NULL）为这些记号覆盖的字节数；
+    // 返回值小于capacity且consumed小于length时，consumed处没有规则能够匹配。编译失败时返回0
+    REGEXP_API size_t regexp_lexer_tokenize(const regexp_lexer *lexer, const char *data, size_t length,
+                                            regexp_token *tokens, size_t capacity, size_t *consumed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // C_API_H
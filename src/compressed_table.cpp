@@ -0,0 +1,429 @@
+#include "compressed_table.h"
+#include "layout.h"
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace
+{
+    // 为一行寻找位移时最多尝试的位置数
+    const size_t PACK_SEARCH_LIMIT = 1024;
+}
+
+CompressedDFATable::CompressedDFATable()
+    : classCount(1), stateCount(1), initialState(0), deadState(0), narrow(true), usedSlots(0),
+      base(1, 0), acceptStates(1, 0)
+{
+    byteClasses.fill(0);
+    narrowRows.defaults.assign(1, 0);
+    narrowRows.slots.assign(1, Slot<uint16_t>{0, std::numeric_limits<uint16_t>::max()});
+}
+
+CompressedDFATable::CompressedDFATable(const std::shared_ptr<Graph> &dfa)
+    : narrow(true), usedSlots(0)
+{
+    // 将图中的状态重新编号为连续的整数，死状态放在最后
+    std::unordered_map<int, int> stateMap;
+    int counter = 0;
+    for (int state : dfa->getAllStates())
+    {
+        stateMap[state] = counter++;
+    }
+    deadState = counter;
+    stateCount = counter + 1;
+    initialState = stateMap.count(dfa->getInitialState()) ? stateMap[dfa->getInitialState()] : deadState;
+
+    acceptStates.assign(stateCount, 0);
+    for (int state : dfa->getAcceptStates())
+    {
+        acceptStates[stateMap[state]] = 1;
+    }
+
+    // 每个字节的转换列只记录非死的表项，边数远小于 状态数 × 字节数
+    std::vector<std::vector<std::pair<int, int>>> columns(256);
+    for (const Edge &edge : dfa->getEdges())
+    {
+        columns[static_cast<unsigned char>(edge.w)].emplace_back(stateMap[edge.u], stateMap[edge.v]);
+    }
+
+    // 合并转换列完全相同的字节。有字节的列为空（全部转向死状态）时等价类0保留给这些字节，
+    // 否则等价类从0开始编号，256个字节各占一类时也不超过256个
+    std::map<std::vector<std::pair<int, int>>, int> columnToClass;
+    std::vector<int> classColumn; // 每个等价类取一个字节的列，-1表示全部转向死状态
+    for (auto &column : columns)
+    {
+        std::sort(column.begin(), column.end());
+        column.erase(std::unique(column.begin(), column.end()), column.end());
+    }
+    if (std::any_of(columns.begin(), columns.end(), [](const std::vector<std::pair<int, int>> &column)
+                    { return column.empty(); }))
+    {
+        columnToClass[{}] = 0;
+        classColumn.push_back(-1);
+    }
+    for (int b = 0; b < 256; b++)
+    {
+        const auto &column = columns[b];
+        auto it = columnToClass.find(column);
+        if (it == columnToClass.end())
+        {
+            it = columnToClass.emplace(column, static_cast<int>(classColumn.size())).first;
+            classColumn.push_back(b);
+        }
+        byteClasses[b] = static_cast<uint8_t>(it->second);
+    }
+    classCount = static_cast<int>(classColumn.size());
+    if (classCount > 256)
+    {
+        throw std::runtime_error("字节等价类超过256个");
+    }
+
+    std::vector<std::vector<std::pair<int, int>>> rows(stateCount);
+    for (int cls = 0; cls < classCount; cls++)
+    {
+        if (classColumn[cls] < 0)
+        {
+            continue;
+        }
+        for (const auto &entry : columns[classColumn[cls]])
+        {
+            rows[entry.first].emplace_back(cls, entry.second);
+        }
+    }
+    pack(rows);
+}
+
+CompressedDFATable::CompressedDFATable(const DFATable &dense)
+    : byteClasses(dense.getByteClasses()), classCount(dense.getClassCount()),
+      stateCount(dense.getStateCount()), initialState(dense.getInitialState()),
+      deadState(dense.getDeadState()), narrow(true), usedSlots(0)
+{
+    acceptStates.resize(stateCount);
+    std::vector<std::vector<std::pair<int, int>>> rows(stateCount);
+    for (int s = 0; s < stateCount; s++)
+    {
+        acceptStates[s] = dense.isAccept(s);
+        for (int cls = 0; cls < classCount; cls++)
+        {
+            int next = dense.getNextStateByClass(s, cls);
+            if (next != deadState)
+            {
+                rows[s].emplace_back(cls, next);
+            }
+        }
+    }
+    pack(rows);
+}
+
+void CompressedDFATable::pack(const std::vector<std::vector<std::pair<int, int>>> &rows)
+{
+    // 16位状态号需要留出最大值作为空槽位标记
+    narrow = stateCount < std::numeric_limits<uint16_t>::max();
+    if (narrow)
+    {
+        packRows(rows, narrowRows);
+    }
+    else
+    {
+        packRows(rows, wideRows);
+    }
+}
+
+template <typename T>
+void CompressedDFATable::packRows(const std::vector<std::vector<std::pair<int, int>>> &rows, Rows<T> &packed)
+{
+    const T empty = std::numeric_limits<T>::max();
+    packed.defaults.assign(stateCount, static_cast<T>(deadState));
+    base.assign(stateCount, 0);
+
+    // 选出每个状态的默认转换，剩下的表项作为例外
+    std::vector<std::vector<std::pair<int, int>>> exceptions(stateCount);
+    std::unordered_map<int, int> frequency;
+    for (int s = 0; s < stateCount; s++)
+    {
+        const auto &row = rows[s];
+        frequency.clear();
+        for (const auto &entry : row)
+        {
+            frequency[entry.second]++;
+        }
+        // 未列出的等价类都转向死状态，次数相同时优先以死状态为默认
+        int defaultState = deadState;
+        int best = classCount - static_cast<int>(row.size());
+        for (const auto &item : frequency)
+        {
+            if (item.second > best || (item.second == best && item.first < defaultState))
+            {
+                defaultState = item.first;
+                best = item.second;
+            }
+        }
+        packed.defaults[s] = static_cast<T>(defaultState);
+
+        size_t k = 0;
+        for (int cls = 0; cls < classCount; cls++)
+        {
+            int next = deadState;
+            if (k < row.size() && row[k].first == cls)
+            {
+                next = row[k++].second;
+            }
+            if (next != defaultState)
+            {
+                exceptions[s].emplace_back(cls, next);
+            }
+        }
+    }
+
+    // 例外多的行先放，首次适应地寻找所有表项都落在空闲槽位上的位移
+    std::vector<int> order(stateCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&exceptions](int a, int b)
+                     { return exceptions[a].size() > exceptions[b].size(); });
+
+    // nextFree沿空闲槽位链跳过已占用的槽位：nextFree[i] == i 表示槽位i空闲，
+    // 否则指向其后某个位置，查找时做路径减半
+    std::vector<size_t> nextFree;
+    auto findFree = [&nextFree](size_t slot)
+    {
+        while (slot < nextFree.size() && nextFree[slot] != slot)
+        {
+            size_t next = nextFree[slot];
+            if (next < nextFree.size())
+            {
+                nextFree[slot] = nextFree[next];
+            }
+            slot = nextFree[slot];
+        }
+        return slot;
+    };
+
+    usedSlots = 0;
+    for (int s : order)
+    {
+        const auto &row = exceptions[s];
+        if (row.empty())
+        {
+            break;
+        }
+
+        // 只在行首表项能落入空闲槽位的位移中寻找
+        size_t lowest = static_cast<size_t>(row.front().first);
+        size_t slot = findFree(lowest);
+        size_t offset;
+        for (size_t probes = 0;; probes++)
+        {
+            // 前部剩下的零散空洞可能容不下较满的行，尝试次数超过上限后直接放到已占用区域之后
+            if (probes == PACK_SEARCH_LIMIT)
+            {
+                offset = std::max(nextFree.size(), lowest) - lowest;
+                break;
+            }
+            offset = slot - lowest;
+            bool fits = true;
+            for (const auto &entry : row)
+            {
+                size_t target = offset + entry.first;
+                if (target < nextFree.size() && nextFree[target] != target)
+                {
+                    fits = false;
+                    break;
+                }
+            }
+            if (fits)
+                break;
+            slot = findFree(slot + 1);
+        }
+
+        base[s] = static_cast<uint32_t>(offset);
+        size_t end = offset + classCount;
+        while (nextFree.size() < end)
+        {
+            nextFree.push_back(nextFree.size());
+            packed.slots.push_back(Slot<T>{0, empty});
+        }
+        for (const auto &entry : row)
+        {
+            size_t target = offset + entry.first;
+            nextFree[target] = target + 1;
+            packed.slots[target] = Slot<T>{static_cast<T>(entry.second), static_cast<T>(s)};
+        }
+        usedSlots += row.size();
+    }
+
+    // 没有例外的状态位移为0，数组至少要容纳一整行
+    if (packed.slots.size() < static_cast<size_t>(classCount))
+    {
+        packed.slots.resize(classCount, Slot<T>{0, empty});
+    }
+    packed.slots.shrink_to_fit();
+}
+
+template <typename T>
+bool CompressedDFATable::matchRows(const Rows<T> &packed, const char *data, size_t length) const
+{
+    const Slot<T> *slots = packed.slots.data();
+    const T *defaults = packed.defaults.data();
+    const uint32_t *offsets = base.data();
+    const T dead = static_cast<T>(deadState);
+    T state = static_cast<T>(initialState);
+    for (size_t i = 0; i < length; i++)
+    {
+        const Slot<T> &slot = slots[offsets[state] + byteClasses[static_cast<unsigned char>(data[i])]];
+        state = slot.check == state ? slot.next : defaults[state];
+        if (state == dead)
+        {
+            return false;
+        }
+    }
+    return acceptStates[state] != 0;
+}
+
+template <typename T>
+bool CompressedDFATable::matchRowsProfiled(const Rows<T> &packed, const char *data, size_t length,
+                                           std::vector<uint64_t> &visits) const
+{
+    if (visits.size() < static_cast<size_t>(stateCount))
+    {
+        visits.resize(stateCount, 0);
+    }
+    const Slot<T> *slots = packed.slots.data();
+    const T *defaults = packed.defaults.data();
+    const uint32_t *offsets = base.data();
+    const T dead = static_cast<T>(deadState);
+    T state = static_cast<T>(initialState);
+    visits[state]++;
+    for (size_t i = 0; i < length; i++)
+    {
+        const Slot<T> &slot = slots[offsets[state] + byteClasses[static_cast<unsigned char>(data[i])]];
+        state = slot.check == state ? slot.next : defaults[state];
+        visits[state]++;
+        if (state == dead)
+        {
+            return false;
+        }
+    }
+    return acceptStates[state] != 0;
+}
+
+bool CompressedDFATable::match(const std::string &input) const
+{
+    return match(input.data(), input.size());
+}
+
+bool CompressedDFATable::match(const char *data, size_t length) const
+{
+    return narrow ? matchRows(narrowRows, data, length) : matchRows(wideRows, data, length);
+}
+
+bool CompressedDFATable::matchProfiled(const char *data, size_t length, std::vector<uint64_t> &visits) const
+{
+    return narrow ? matchRowsProfiled(narrowRows, data, length, visits)
+                  : matchRowsProfiled(wideRows, data, length, visits);
+}
+
+int CompressedDFATable::getNextState(int state, unsigned char c) const
+{
+    return getNextStateByClass(state, byteClasses[c]);
+}
+
+int CompressedDFATable::getNextStateByClass(int state, int symbolClass) const
+{
+    size_t slot = base[state] + symbolClass;
+    if (narrow)
+    {
+        const auto &entry = narrowRows.slots[slot];
+        return entry.check == state ? entry.next : narrowRows.defaults[state];
+    }
+    const auto &entry = wideRows.slots[slot];
+    return entry.check == static_cast<uint32_t>(state) ? static_cast<int>(entry.next)
+                                                        : static_cast<int>(wideRows.defaults[state]);
+}
+
+int CompressedDFATable::getStateCount() const
+{
+    return stateCount;
+}
+
+int CompressedDFATable::getClassCount() const
+{
+    return classCount;
+}
+
+int CompressedDFATable::getInitialState() const
+{
+    return initialState;
+}
+
+int CompressedDFATable::getDeadState() const
+{
+    return deadState;
+}
+
+int CompressedDFATable::getByteClass(unsigned char c) const
+{
+    return byteClasses[c];
+}
+
+size_t CompressedDFATable::getSlotCount() const
+{
+    return narrow ? narrowRows.slots.size() : wideRows.slots.size();
+}
+
+size_t CompressedDFATable::getUsedSlotCount() const
+{
+    return usedSlots;
+}
+
+bool CompressedDFATable::usesNarrowStates() const
+{
+    return narrow;
+}
+
+size_t CompressedDFATable::denseMemoryUsage() const
+{
+    return sizeof(DFATable) + static_cast<size_t>(stateCount) * classCount * sizeof(int) + acceptStates.size() +
+           static_cast<size_t>(classCount);
+}
+
+CompressedDFATable CompressedDFATable::renumbered(const std::vector<int> &order) const
+{
+    std::vector<int> newId = invertLayout(order, stateCount, deadState);
+
+    CompressedDFATable result;
+    result.byteClasses = byteClasses;
+    result.classCount = classCount;
+    result.stateCount = stateCount;
+    result.initialState = newId[initialState];
+    result.deadState = newId[deadState];
+    result.acceptStates.assign(stateCount, 0);
+    result.narrowRows = Rows<uint16_t>();
+
+    std::vector<std::vector<std::pair<int, int>>> rows(stateCount);
+    for (int s = 0; s < stateCount; s++)
+    {
+        result.acceptStates[newId[s]] = acceptStates[s];
+        for (int cls = 0; cls < classCount; cls++)
+        {
+            int next = getNextStateByClass(s, cls);
+            if (next != deadState)
+            {
+                rows[newId[s]].emplace_back(cls, newId[next]);
+            }
+        }
+    }
+    result.pack(rows);
+    return result;
+}
+
+size_t CompressedDFATable::memoryUsage() const
+{
+    size_t rows = narrow ? narrowRows.defaults.capacity() * sizeof(uint16_t) +
+                               narrowRows.slots.capacity() * sizeof(Slot<uint16_t>)
+                         : wideRows.defaults.capacity() * sizeof(uint32_t) +
+                               wideRows.slots.capacity() * sizeof(Slot<uint32_t>);
+    return sizeof(*this) + rows + base.capacity() * sizeof(uint32_t) + acceptStates.capacity();
+}
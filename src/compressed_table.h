@@ -0,0 +1,96 @@
+#ifndef COMPRESSED_TABLE_H
+#define COMPRESSED_TABLE_H
+
+#include "dfa_table.h"
+#include "graph.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 压缩DFA转换表（lex风格的行位移压缩）
+//
+// 每个状态取出现最多的目标作为默认转换，只有与默认转换不同的表项需要存储。
+// 各状态剩余的稀疏行以不同的位移base[s]交错放入同一个一维数组（梳状压缩），
+// 每个槽位记录它属于哪个状态(check)以及目标状态(next)：
+//   slot = base[s] + class
+//   next = slots[slot].check == s ? slots[slot].next : defaults[s]
+// 查表仍是常数时间，不需要沿默认链回溯。
+// 状态数小于65535时状态号用16位存储，否则用32位。
+// 与DFATable相同，死状态显式存在并放在最后。
+class CompressedDFATable
+{
+public:
+    CompressedDFATable();
+    // 直接从Graph形式的DFA构造，不经过稠密表，适合状态数很多的DFA
+    explicit CompressedDFATable(const std::shared_ptr<Graph> &dfa);
+    explicit CompressedDFATable(const DFATable &dense);
+
+    // 判断整个输入是否被接受
+    bool match(const std::string &input) const;
+    bool match(const char *data, size_t length) const;
+    // 同match，并把经过的每个状态（含初始状态）的访问次数累加到visits中
+    bool matchProfiled(const char *data, size_t length, std::vector<uint64_t> &visits) const;
+
+    // 单步转换
+    int getNextState(int state, unsigned char c) const;
+    int getNextStateByClass(int state, int symbolClass) const;
+    bool isAccept(int state) const { return acceptStates[state] != 0; }
+
+    int getStateCount() const;
+    int getClassCount() const;
+    int getInitialState() const;
+    int getDeadState() const;
+    int getByteClass(unsigned char c) const;
+    // 压缩数组的槽位数与其中被占用的槽位数
+    size_t getSlotCount() const;
+    size_t getUsedSlotCount() const;
+    // 是否使用16位状态号
+    bool usesNarrowStates() const;
+    // 同样的状态数与等价类数下稠密表占用的字节数
+    size_t denseMemoryUsage() const;
+    // 压缩表占用的字节数
+    size_t memoryUsage() const;
+
+    // 按order重新编号状态后重新压缩，order的含义与DFATable::renumbered相同
+    CompressedDFATable renumbered(const std::vector<int> &order) const;
+
+private:
+    template <typename T>
+    struct Slot
+    {
+        T next;  // 目标状态
+        T check; // 槽位所属的状态，空槽位为T的最大值
+    };
+
+    template <typename T>
+    struct Rows
+    {
+        std::vector<T> defaults;      // 每个状态的默认转换
+        std::vector<Slot<T>> slots;   // 交错存放的例外表项
+    };
+
+    // rows[s]为状态s的全部非死转换(等价类, 目标)，按等价类升序
+    void pack(const std::vector<std::vector<std::pair<int, int>>> &rows);
+    template <typename T>
+    void packRows(const std::vector<std::vector<std::pair<int, int>>> &rows, Rows<T> &packed);
+    template <typename T>
+    bool matchRows(const Rows<T> &packed, const char *data, size_t length) const;
+    template <typename T>
+    bool matchRowsProfiled(const Rows<T> &packed, const char *data, size_t length, std::vector<uint64_t> &visits) const;
+
+    std::array<uint8_t, 256> byteClasses; // 字节到等价类的映射
+    int classCount;                       // 等价类数量
+    int stateCount;                       // 状态数量（包含死状态）
+    int initialState;                     // 初始状态
+    int deadState;                        // 死状态
+    bool narrow;                          // 是否使用16位状态号
+    size_t usedSlots;                     // 被占用的槽位数
+    std::vector<uint32_t> base;           // 每个状态的行位移
+    std::vector<char> acceptStates;       // 接受状态标记
+    Rows<uint16_t> narrowRows;            // 16位状态号的压缩表
+    Rows<uint32_t> wideRows;              // 32位状态号的压缩表
+};
+
+#endif // COMPRESSED_TABLE_H
@@ -1,20 +1,93 @@
 #include "dfa.h"
+#include "alloc_stats.h"
+#include "thread_pool.h"
 #include <queue>
 #include <stack>
 #include <algorithm>
+#include <cstdint>
+#include <unordered_map>
 
-#define EPSILON_CHAR '$' // 使用$作为epsilon转换的符号
+// 估计子集构造内存占用时使用的单位大小（字节）
+// 每个DFA状态的NFA状态集合保存在processedStates、stateSetToId和待处理队列中，
+// 集合的每个元素是一个红黑树结点；每条边保存在Graph的边表和转换表中
+const size_t SET_NODE_BYTES = 40;
+const size_t STATE_OVERHEAD_BYTES = 192;
+const size_t EDGE_BYTES = 96;
 
-DFABuilder::DFABuilder() : stateCounter(0) {}
+// 每隔多少次检查读取一次时钟
+const unsigned CLOCK_CHECK_INTERVAL = 64;
+
+// 并行最小化时每个线程至少分到的状态数，状态较少时减少线程以免调度开销超过收益
+const size_t MIN_STATES_PER_THREAD = 4096;
+
+DFABuilder::DFABuilder()
+    : stateCounter(0), interruptCheckCounter(0), minimizeMode(MinimizeMode::Sequential), minimizeThreads(0)
+{
+}
 
 DFABuilder::~DFABuilder() {}
 
+void DFABuilder::setLimits(const DFALimits &newLimits)
+{
+    limits = newLimits;
+}
+
+const DFALimits &DFABuilder::getLimits() const
+{
+    return limits;
+}
+
+void DFABuilder::setMinimizeMode(MinimizeMode mode, size_t threads)
+{
+    minimizeMode = mode;
+    minimizeThreads = threads;
+}
+
+MinimizeMode DFABuilder::getMinimizeMode() const
+{
+    return minimizeMode;
+}
+
+void DFABuilder::checkLimits(size_t stateCount, size_t memoryBytes)
+{
+    if (limits.maxStates != 0 && stateCount > limits.maxStates)
+    {
+        throw DFALimitExceeded("DFA状态数超过上限 " + std::to_string(limits.maxStates),
+                               DFALimitKind::States, stateCount, memoryBytes);
+    }
+    if (limits.maxMemoryBytes != 0 && memoryBytes > limits.maxMemoryBytes)
+    {
+        throw DFALimitExceeded("DFA构造内存超过上限 " + std::to_string(limits.maxMemoryBytes) + " 字节",
+                               DFALimitKind::Memory, stateCount, memoryBytes);
+    }
+    checkInterrupted(stateCount, memoryBytes);
+}
+
+void DFABuilder::checkInterrupted(size_t stateCount, size_t memoryBytes, bool readClock)
+{
+    if (limits.cancelled && limits.cancelled->load(std::memory_order_relaxed))
+    {
+        throw DFALimitExceeded("DFA构造已被取消", DFALimitKind::Cancelled, stateCount, memoryBytes);
+    }
+    // 读取时钟比检查标记昂贵，每隔若干次才检查一次截止时间
+    if (limits.deadline != std::chrono::steady_clock::time_point::max() &&
+        (++interruptCheckCounter % CLOCK_CHECK_INTERVAL == 0 || readClock) &&
+        std::chrono::steady_clock::now() > limits.deadline)
+    {
+        throw DFALimitExceeded("DFA构造超过截止时间", DFALimitKind::Deadline, stateCount, memoryBytes);
+    }
+}
+
 std::shared_ptr<Graph> DFABuilder::buildDFA(const std::shared_ptr<Graph> &nfa)
 {
+    REGEXP_ALLOC_PHASE("buildDFA");
+
     // 重置状态计数器
     stateCounter = 0;
     stateSetToId.clear();
 
+    // 各数据结构的内存分别统计，状态集合每次复制进容器时都记入该容器
+    REGEXP_ALLOC_CATEGORY("closure");
     auto dfa = std::make_shared<Graph>();
     std::queue<std::set<int>> unprocessedStates;
     std::set<std::set<int>> processedStates;
@@ -23,10 +96,21 @@ std::shared_ptr<Graph> DFABuilder::buildDFA(const std::shared_ptr<Graph> &nfa)
     std::set<int> initialState = epsilonClosure(nfa, nfa->getInitialState());
     int initialStateId = getStateId(initialState);
 
-    dfa->addState(initialStateId);
-    dfa->setInitialState(initialStateId);
-    unprocessedStates.push(initialState);
-    processedStates.insert(initialState);
+    {
+        REGEXP_ALLOC_CATEGORY("Graph");
+        dfa->addState(initialStateId);
+        dfa->setInitialState(initialStateId);
+    }
+    {
+        REGEXP_ALLOC_CATEGORY("queue");
+        unprocessedStates.push(initialState);
+    }
+    {
+        REGEXP_ALLOC_CATEGORY("processedStates");
+        processedStates.insert(initialState);
+    }
+    size_t memoryBytes = STATE_OVERHEAD_BYTES + initialState.size() * SET_NODE_BYTES * 3;
+    checkLimits(processedStates.size(), memoryBytes);
 
     // 如果初始状态包含NFA的接受状态，则将其设为DFA的接受状态
     for (int state : initialState)
@@ -38,9 +122,8 @@ std::shared_ptr<Graph> DFABuilder::buildDFA(const std::shared_ptr<Graph> &nfa)
         }
     }
 
-    // 获取完整的字母表（不包括epsilon）
+    // 获取完整的字母表（getAlphabet不包括epsilon）
     std::set<char> fullAlphabet = nfa->getAlphabet();
-    fullAlphabet.erase(EPSILON_CHAR);
 
     // 处理所有未处理的状态
     while (!unprocessedStates.empty())
@@ -63,6 +146,7 @@ std::shared_ptr<Graph> DFABuilder::buildDFA(const std::shared_ptr<Graph> &nfa)
             // 如果是新状态，添加到DFA中
             if (processedStates.find(nextStates) == processedStates.end())
             {
+                REGEXP_ALLOC_CATEGORY("Graph");
                 dfa->addState(nextStateId);
 
                 // 检查是否包含接受状态
@@ -75,76 +159,185 @@ std::shared_ptr<Graph> DFABuilder::buildDFA(const std::shared_ptr<Graph> &nfa)
                     }
                 }
 
-                unprocessedStates.push(nextStates);
-                processedStates.insert(nextStates);
+                {
+                    REGEXP_ALLOC_CATEGORY("queue");
+                    unprocessedStates.push(nextStates);
+                }
+                {
+                    REGEXP_ALLOC_CATEGORY("processedStates");
+                    processedStates.insert(nextStates);
+                }
+                memoryBytes += STATE_OVERHEAD_BYTES + nextStates.size() * SET_NODE_BYTES * 3;
             }
 
             // 添加转换边
-            dfa->addEdge(currentStateId, nextStateId, symbol);
+            {
+                REGEXP_ALLOC_CATEGORY("Graph");
+                dfa->addEdge(currentStateId, nextStateId, symbol);
+            }
+            memoryBytes += EDGE_BYTES;
+            checkLimits(processedStates.size(), memoryBytes);
         }
     }
 
     return dfa;
 }
 
-std::shared_ptr<Graph> DFABuilder::minimizeDFA(const std::shared_ptr<Graph> &dfa)
+std::shared_ptr<Graph> DFABuilder::buildDFA(const std::shared_ptr<Graph> &nfa, const std::map<int, int> &acceptTags,
+                                            std::map<int, int> &dfaTags)
 {
-    // 计算初始划分
-    std::vector<std::set<int>> partition = computeInitialPartition(dfa);
+    auto dfa = buildDFA(nfa);
+    dfaTags.clear();
+    for (const auto &entry : stateSetToId)
+    {
+        int best = -1;
+        for (int state : entry.first)
+        {
+            auto it = acceptTags.find(state);
+            if (it != acceptTags.end() && (best < 0 || it->second < best))
+            {
+                best = it->second;
+            }
+        }
+        if (best >= 0)
+        {
+            dfaTags[entry.second] = best;
+        }
+    }
+    return dfa;
+}
 
-    // 细化划分直到不能再细化
-    refinePartition(dfa, partition);
+std::shared_ptr<Graph> DFABuilder::minimizeDFA(const std::shared_ptr<Graph> &dfa)
+{
+    return minimize(dfa, nullptr, nullptr);
+}
 
-    // 构建最小化DFA
-    auto minDfa = std::make_shared<Graph>();
-    std::map<int, int> oldToNewState;
-    int newStateId = 0;
+std::shared_ptr<Graph> DFABuilder::minimizeDFA(const std::shared_ptr<Graph> &dfa, const std::map<int, int> &acceptTags,
+                                               std::map<int, int> &minTags)
+{
+    minTags.clear();
+    return minimize(dfa, &acceptTags, &minTags);
+}
 
-    // 为每个等价类分配新的状态ID
-    for (const auto &group : partition)
+std::shared_ptr<Graph> DFABuilder::minimize(const std::shared_ptr<Graph> &dfa, const std::map<int, int> *tags,
+                                            std::map<int, int> *newTags)
+{
+    REGEXP_ALLOC_PHASE("minimizeDFA");
+
+    // 状态按编号升序展开为下标，转换表按下标展开为平坦数组
+    REGEXP_ALLOC_CATEGORY("flatTable");
+    std::set<int> stateSet = dfa->getAllStates();
+    std::vector<int> states(stateSet.begin(), stateSet.end());
+    std::unordered_map<int, int> indexOf;
+    indexOf.reserve(states.size());
+    for (size_t i = 0; i < states.size(); i++)
+    {
+        indexOf[states[i]] = static_cast<int>(i);
+    }
+    std::set<char> alphabetSet = dfa->getAlphabet();
+    std::vector<char> alphabet(alphabetSet.begin(), alphabetSet.end());
+    std::vector<int> symbolIndex(256, -1);
+    for (size_t a = 0; a < alphabet.size(); a++)
+    {
+        symbolIndex[static_cast<unsigned char>(alphabet[a])] = static_cast<int>(a);
+    }
+    const size_t k = alphabet.size();
+    std::vector<int> next(states.size() * k, -1);
+    for (const auto &edge : dfa->getEdges())
     {
-        for (int state : group)
+        int a = symbolIndex[static_cast<unsigned char>(edge.w)];
+        int &target = next[indexOf[edge.u] * k + a];
+        int to = indexOf[edge.v];
+        // 与getNextStates().begin()一致，取编号最小的目标
+        if (target < 0 || to < target)
         {
-            oldToNewState[state] = newStateId;
+            target = to;
         }
-        minDfa->addState(newStateId);
+    }
 
-        // 如果组包含原DFA的接受状态，则新状态也是接受状态
-        for (int state : group)
+    std::vector<int> blockOf(states.size(), -1);
+    REGEXP_ALLOC_CATEGORY("partition");
+    std::vector<std::set<int>> partition = computeInitialPartition(dfa, tags);
+    if (minimizeMode == MinimizeMode::Parallel)
+    {
+        for (size_t b = 0; b < partition.size(); b++)
         {
-            if (dfa->getAcceptStates().count(state))
+            for (int state : partition[b])
             {
-                minDfa->addAcceptState(newStateId);
-                break;
+                blockOf[indexOf[state]] = static_cast<int>(b);
             }
         }
-
-        // 如果组包含原DFA的初始状态，则新状态也是初始状态
-        for (int state : group)
+        blockOf = refineBySignature(k, next, std::move(blockOf), partition.size());
+    }
+    else
+    {
+        // 细化划分直到不能再细化
+        refinePartition(dfa, partition);
+        for (size_t b = 0; b < partition.size(); b++)
         {
-            if (state == dfa->getInitialState())
+            for (int state : partition[b])
             {
-                minDfa->setInitialState(newStateId);
-                break;
+                blockOf[indexOf[state]] = static_cast<int>(b);
             }
         }
+    }
+
+    REGEXP_ALLOC_CATEGORY("Graph");
+    return buildMinimized(dfa, states, alphabet, next, blockOf, tags, newTags);
+}
+
+std::shared_ptr<Graph> DFABuilder::buildMinimized(const std::shared_ptr<Graph> &dfa, const std::vector<int> &states,
+                                                  const std::vector<char> &alphabet, const std::vector<int> &next,
+                                                  const std::vector<int> &blockOf, const std::map<int, int> *tags,
+                                                  std::map<int, int> *newTags)
+{
+    // 组按其中最小的原状态排序编号，结果只取决于划分本身，与求出划分的方式无关
+    std::vector<int> newId(states.size(), -1);
+    std::vector<int> representative;
+    for (size_t i = 0; i < states.size(); i++)
+    {
+        if (newId[blockOf[i]] < 0)
+        {
+            newId[blockOf[i]] = static_cast<int>(representative.size());
+            representative.push_back(static_cast<int>(i));
+        }
+    }
 
-        newStateId++;
+    auto minDfa = std::make_shared<Graph>();
+    for (size_t id = 0; id < representative.size(); id++)
+    {
+        minDfa->addState(static_cast<int>(id));
     }
 
-    // 添加转换边
-    for (const auto &group : partition)
+    // 组中含原DFA的接受状态时新状态也是接受状态，同一组的接受状态规则号相同
+    const std::set<int> &acceptStates = dfa->getAcceptStates();
+    for (size_t i = 0; i < states.size(); i++)
     {
-        int representativeState = *group.begin();
-        int fromState = oldToNewState[representativeState];
+        int id = newId[blockOf[i]];
+        if (acceptStates.count(states[i]) && !minDfa->getAcceptStates().count(id))
+        {
+            minDfa->addAcceptState(id);
+            if (tags && tags->count(states[i]))
+            {
+                (*newTags)[id] = tags->at(states[i]);
+            }
+        }
+        if (states[i] == dfa->getInitialState())
+        {
+            minDfa->setInitialState(id);
+        }
+    }
 
-        for (char symbol : dfa->getAlphabet())
+    // 添加转换边，同一组的状态转换目标所在的组相同，取代表状态的转换
+    const size_t k = alphabet.size();
+    for (size_t id = 0; id < representative.size(); id++)
+    {
+        const int *row = &next[representative[id] * k];
+        for (size_t a = 0; a < k; a++)
         {
-            auto nextStates = dfa->getNextStates(representativeState, symbol);
-            if (!nextStates.empty())
+            if (row[a] >= 0)
             {
-                int toState = oldToNewState[*nextStates.begin()];
-                minDfa->addEdge(fromState, toState, symbol);
+                minDfa->addEdge(static_cast<int>(id), newId[blockOf[row[a]]], alphabet[a]);
             }
         }
     }
@@ -152,6 +345,179 @@ std::shared_ptr<Graph> DFABuilder::minimizeDFA(const std::shared_ptr<Graph> &dfa
     return minDfa;
 }
 
+namespace
+{
+    // 64位混合函数（splitmix64的最后一步）
+    uint64_t mixHash(uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+}
+
+std::vector<int> DFABuilder::refineBySignature(size_t symbolCount, const std::vector<int> &next,
+                                               std::vector<int> blockOf, size_t blockCount)
+{
+    REGEXP_ALLOC_CATEGORY("signatures");
+    const size_t stateCount = blockOf.size();
+    size_t threadCount = minimizeThreads ? minimizeThreads : std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::max<size_t>(1, std::min(threadCount, stateCount / MIN_STATES_PER_THREAD));
+    // 线程池跨调用复用，线程不够时才重新创建
+    ThreadPool *pool = nullptr;
+    if (threadCount > 1)
+    {
+        if (!minimizePool || minimizePool->size() < threadCount)
+        {
+            minimizePool = std::make_shared<ThreadPool>(threadCount);
+        }
+        pool = minimizePool.get();
+    }
+
+    // 把task(0..threadCount-1)分给各线程执行，等待全部完成后再传出异常
+    auto runParallel = [&](const std::function<void(size_t)> &task)
+    {
+        if (!pool)
+        {
+            task(0);
+            return;
+        }
+        std::vector<std::future<void>> futures;
+        for (size_t t = 0; t < threadCount; t++)
+        {
+            // 工作线程上的分配同样记入本阶段
+            futures.push_back(pool->submit([&task, t]()
+                                           {
+                REGEXP_ALLOC_PHASE("minimizeDFA");
+                REGEXP_ALLOC_CATEGORY("signatures");
+                task(t); }));
+        }
+        for (auto &future : futures)
+        {
+            future.wait();
+        }
+        for (auto &future : futures)
+        {
+            future.get();
+        }
+    };
+
+    // 两个状态的签名是否相同：所在组相同，且每个符号的目标所在组相同（缺失的转换记为-1）
+    auto sameSignature = [&](size_t x, size_t y)
+    {
+        if (blockOf[x] != blockOf[y])
+        {
+            return false;
+        }
+        const int *rowX = &next[x * symbolCount];
+        const int *rowY = &next[y * symbolCount];
+        for (size_t a = 0; a < symbolCount; a++)
+        {
+            int targetX = rowX[a] < 0 ? -1 : blockOf[rowX[a]];
+            int targetY = rowY[a] < 0 ? -1 : blockOf[rowY[a]];
+            if (targetX != targetY)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::vector<uint64_t> hashes(stateCount);
+    std::vector<int> newBlockOf(stateCount);
+    std::vector<int> chain(stateCount);
+    std::vector<size_t> localCounts(threadCount);
+    while (true)
+    {
+        // 最小化没有状态数上限，只响应取消和截止时间；每一轮耗时较长，每次都读取时钟
+        checkInterrupted(blockCount, 0, true);
+
+        // 第一步：按状态区间并行计算签名的哈希
+        runParallel([&](size_t t)
+                    {
+            size_t begin = stateCount * t / threadCount;
+            size_t end = stateCount * (t + 1) / threadCount;
+            for (size_t i = begin; i < end; i++)
+            {
+                uint64_t h = mixHash(static_cast<uint64_t>(blockOf[i]));
+                const int *row = &next[i * symbolCount];
+                for (size_t a = 0; a < symbolCount; a++)
+                {
+                    h = mixHash(h ^ static_cast<uint64_t>(static_cast<int64_t>(row[a] < 0 ? -1 : blockOf[row[a]])));
+                }
+                hashes[i] = h;
+            } });
+        checkInterrupted(blockCount, 0, true);
+
+        // 第二步：按哈希分给各线程，每个线程为哈希归自己的状态分配局部组号。
+        // 相同签名的哈希必然相同，因此同一个新组的状态都由同一个线程处理；
+        // 哈希相同而签名不同的代表状态经chain串起，逐个比较完整的签名
+        runParallel([&](size_t t)
+                    {
+            std::unordered_map<uint64_t, int> firstWithHash;
+            int count = 0;
+            for (size_t i = 0; i < stateCount; i++)
+            {
+                if (hashes[i] % threadCount != t)
+                {
+                    continue;
+                }
+                auto inserted = firstWithHash.emplace(hashes[i], static_cast<int>(i));
+                int id = -1;
+                if (!inserted.second)
+                {
+                    int rep = inserted.first->second;
+                    for (; rep >= 0; rep = chain[rep])
+                    {
+                        if (sameSignature(i, static_cast<size_t>(rep)))
+                        {
+                            id = newBlockOf[rep];
+                            break;
+                        }
+                    }
+                }
+                if (id < 0)
+                {
+                    // 新的代表状态插到链表头部
+                    id = count++;
+                    chain[i] = inserted.second ? -1 : inserted.first->second;
+                    inserted.first->second = static_cast<int>(i);
+                }
+                newBlockOf[i] = id;
+            }
+            localCounts[t] = static_cast<size_t>(count); });
+
+        size_t newBlockCount = 0;
+        std::vector<int> offsets(threadCount);
+        for (size_t t = 0; t < threadCount; t++)
+        {
+            offsets[t] = static_cast<int>(newBlockCount);
+            newBlockCount += localCounts[t];
+        }
+        // 新划分是旧划分的细化，组数不变说明已经稳定
+        if (newBlockCount == blockCount)
+        {
+            break;
+        }
+
+        // 第三步：局部组号加上各线程的偏移得到全局组号
+        runParallel([&](size_t t)
+                    {
+            size_t begin = stateCount * t / threadCount;
+            size_t end = stateCount * (t + 1) / threadCount;
+            for (size_t i = begin; i < end; i++)
+            {
+                newBlockOf[i] += offsets[hashes[i] % threadCount];
+            } });
+        blockOf.swap(newBlockOf);
+        blockCount = newBlockCount;
+    }
+    return blockOf;
+}
+
 std::set<int> DFABuilder::epsilonClosure(const std::shared_ptr<Graph> &nfa, int state)
 {
     std::set<int> closure{state};
@@ -163,7 +529,7 @@ std::set<int> DFABuilder::epsilonClosure(const std::shared_ptr<Graph> &nfa, int
         int current = stack.top();
         stack.pop();
 
-        auto nextStates = nfa->getNextStates(current, EPSILON_CHAR);
+        auto nextStates = nfa->getEpsilonStates(current);
         for (int next : nextStates)
         {
             if (closure.insert(next).second)
@@ -206,20 +572,38 @@ int DFABuilder::getStateId(const std::set<int> &states)
         return it->second;
     }
     int newId = stateCounter++;
+    REGEXP_ALLOC_CATEGORY("stateSetToId");
     stateSetToId[states] = newId;
     return newId;
 }
 
-std::vector<std::set<int>> DFABuilder::computeInitialPartition(const std::shared_ptr<Graph> &dfa)
+std::vector<std::set<int>> DFABuilder::computeInitialPartition(const std::shared_ptr<Graph> &dfa,
+                                                                const std::map<int, int> *tags)
 {
     std::vector<std::set<int>> partition;
     std::set<int> acceptStates = dfa->getAcceptStates();
     std::set<int> nonAcceptStates;
 
+    // 带规则号时接受状态按规则号分组，没有规则号的接受状态单独成组
+    if (tags)
+    {
+        std::map<int, std::set<int>> byTag;
+        for (int state : acceptStates)
+        {
+            auto it = tags->find(state);
+            byTag[it == tags->end() ? -1 : it->second].insert(state);
+        }
+        for (const auto &entry : byTag)
+        {
+            partition.push_back(entry.second);
+        }
+        acceptStates.clear();
+    }
+
     // 将状态分为接受状态和非接受状态两组
     for (int state : dfa->getAllStates())
     {
-        if (acceptStates.count(state))
+        if (dfa->getAcceptStates().count(state))
         {
             continue;
         }
@@ -243,6 +627,8 @@ void DFABuilder::refinePartition(const std::shared_ptr<Graph> &dfa, std::vector<
     bool changed;
     do
     {
+        // 最小化没有状态数上限，只响应取消和截止时间；每一轮检查一次，一轮可能很长，每次都读取时钟
+        checkInterrupted(partition.size(), 0, true);
         changed = false;
         std::vector<std::set<int>> newPartition;
 
@@ -315,11 +701,8 @@ bool DFABuilder::canSplit(const std::shared_ptr<Graph> &dfa, const std::set<int>
     for (int state : group)
     {
         auto nextStates = dfa->getNextStates(state, symbol);
-        if (nextStates.empty())
-            continue;
-
-        int nextState = *nextStates.begin();
-        if (splitter.count(nextState))
+        // 缺失的转换等价于转向隐含的死状态，它不属于任何分组
+        if (!nextStates.empty() && splitter.count(*nextStates.begin()))
         {
             foundInSplitter = true;
         }
@@ -335,4 +718,4 @@ bool DFABuilder::canSplit(const std::shared_ptr<Graph> &dfa, const std::set<int>
     }
 
     return false;
-}
\ No newline at end of file
+}
@@ -7,6 +7,55 @@
 #include <set>
 #include <vector>
 #include <string>
+#include <stdexcept>
+#include <atomic>
+#include <chrono>
+
+// DFA构造的资源上限，0表示不限制
+// 截止时间与取消标记在buildDFA和minimizeDFA中都会被周期性地检查，NFABuilder::setLimits之后buildNFA也会检查
+struct DFALimits
+{
+    size_t maxStates = 0;      // DFA状态数上限
+    size_t maxMemoryBytes = 0; // 构造过程占用内存的估计上限（字节）
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max(); // 截止时间
+    const std::atomic<bool> *cancelled = nullptr; // 由其他线程置为true时中止构造
+};
+
+// 超出的是哪一项上限
+enum class DFALimitKind
+{
+    States,
+    Memory,
+    Deadline,
+    Cancelled
+};
+
+// DFA构造超出DFALimits时抛出
+class DFALimitExceeded : public std::runtime_error
+{
+public:
+    DFALimitExceeded(const std::string &message, DFALimitKind kind, size_t stateCount, size_t memoryBytes)
+        : std::runtime_error(message), kind(kind), stateCount(stateCount), memoryBytes(memoryBytes) {}
+
+    DFALimitKind getKind() const { return kind; }
+    // 放弃构造时已经得到的状态数与内存估计
+    size_t getStateCount() const { return stateCount; }
+    size_t getMemoryBytes() const { return memoryBytes; }
+
+private:
+    DFALimitKind kind;
+    size_t stateCount;
+    size_t memoryBytes;
+};
+
+class ThreadPool;
+
+// 最小化方式，两种方式得到的最小化DFA完全相同
+enum class MinimizeMode
+{
+    Sequential, // 逐组寻找分割者的划分细化
+    Parallel    // 按签名逐轮细化，每一轮在多个线程上并行
+};
 
 // DFA构造器类
 class DFABuilder
@@ -15,13 +64,43 @@ public:
     DFABuilder();
     ~DFABuilder();
 
+    // 设置资源上限，超出时buildDFA或minimizeDFA抛出DFALimitExceeded
+    void setLimits(const DFALimits &limits);
+    const DFALimits &getLimits() const;
+
+    // 设置最小化方式，threads为并行方式使用的线程数，0表示使用硬件并发数。
+    // 并行方式的线程池在第一次需要时创建，同一个构造器（及其副本）之后的最小化复用它
+    void setMinimizeMode(MinimizeMode mode, size_t threads = 0);
+    MinimizeMode getMinimizeMode() const;
+
     // 使用子集构造法从NFA构造DFA
     std::shared_ptr<Graph> buildDFA(const std::shared_ptr<Graph> &nfa);
 
-    // 使用Hopcroft算法最小化DFA
+    // 最小化DFA，新状态按各等价类中最小的原状态号依次编号
     std::shared_ptr<Graph> minimizeDFA(const std::shared_ptr<Graph> &dfa);
 
+    // 带接受标记的构造，用于词法分析：acceptTags为接受状态到规则号的映射，规则号越小优先级越高。
+    // 子集构造得到的接受状态取其NFA状态集合中最小的规则号，写入dfaTags
+    std::shared_ptr<Graph> buildDFA(const std::shared_ptr<Graph> &nfa, const std::map<int, int> &acceptTags,
+                                    std::map<int, int> &dfaTags);
+    // 规则号不同的接受状态不会被合并，最小化后的规则号写入minTags
+    std::shared_ptr<Graph> minimizeDFA(const std::shared_ptr<Graph> &dfa, const std::map<int, int> &acceptTags,
+                                       std::map<int, int> &minTags);
+
 private:
+    // tags非空时按规则号划分接受状态，并把最小化后的规则号写入newTags
+    std::shared_ptr<Graph> minimize(const std::shared_ptr<Graph> &dfa, const std::map<int, int> *tags,
+                                    std::map<int, int> *newTags);
+    // 按最终划分构造最小化DFA：states为升序的原状态，next为按states下标展开的转换表
+    // （每个状态alphabet.size()项，缺失为-1），blockOf为每个状态所在的组
+    std::shared_ptr<Graph> buildMinimized(const std::shared_ptr<Graph> &dfa, const std::vector<int> &states,
+                                          const std::vector<char> &alphabet, const std::vector<int> &next,
+                                          const std::vector<int> &blockOf, const std::map<int, int> *tags,
+                                          std::map<int, int> *newTags);
+    // 并行签名细化：每一轮用(所在组, 每个符号的目标所在组)作为签名重新分组，直到组数不再增加
+    std::vector<int> refineBySignature(size_t symbolCount, const std::vector<int> &next, std::vector<int> blockOf,
+                                       size_t blockCount);
+
     // 计算ε闭包
     std::set<int> epsilonClosure(const std::shared_ptr<Graph> &nfa, const std::set<int> &states);
     std::set<int> epsilonClosure(const std::shared_ptr<Graph> &nfa, int state);
@@ -33,13 +112,24 @@ private:
     int getStateId(const std::set<int> &states);
 
     // Hopcroft算法辅助函数
-    std::vector<std::set<int>> computeInitialPartition(const std::shared_ptr<Graph> &dfa);
+    std::vector<std::set<int>> computeInitialPartition(const std::shared_ptr<Graph> &dfa, const std::map<int, int> *tags);
     void refinePartition(const std::shared_ptr<Graph> &dfa, std::vector<std::set<int>> &partition);
     bool canSplit(const std::shared_ptr<Graph> &dfa, const std::set<int> &group,
                   const std::set<int> &splitter, char symbol);
 
+    // 检查子集构造是否超出资源上限
+    void checkLimits(size_t stateCount, size_t memoryBytes);
+    // 检查是否已被取消或超过截止时间
+    // readClock为true时每次都检查截止时间，用于两次检查之间间隔较长的场合
+    void checkInterrupted(size_t stateCount, size_t memoryBytes, bool readClock = false);
+
     std::map<std::set<int>, int> stateSetToId; // 状态集合到状态ID的映射
     int stateCounter;                          // 状态计数器
+    DFALimits limits;                          // 资源上限
+    unsigned interruptCheckCounter;            // 控制读取时钟的频率
+    MinimizeMode minimizeMode;                 // 最小化方式
+    size_t minimizeThreads;                    // 并行最小化的线程数，0表示硬件并发数
+    std::shared_ptr<ThreadPool> minimizePool;  // 并行最小化复用的线程池
 };
 
 #endif // DFA_H
\ No newline at end of file
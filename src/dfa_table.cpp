@@ -0,0 +1,355 @@
+#include "dfa_table.h"
+#include "alloc_stats.h"
+#include "layout.h"
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+
+DFATable::DFATable()
+    : classCount(1), stateCount(1), initialState(0), deadState(0),
+      transitions(1, 0), acceptStates(1, 0)
+{
+    byteClasses.fill(0);
+    classRepresentatives.push_back(0);
+}
+
+DFATable::DFATable(const std::shared_ptr<Graph> &dfa)
+{
+    REGEXP_ALLOC_PHASE("DFATable");
+
+    // 将图中的状态重新编号为连续的整数，死状态放在最后
+    std::unordered_map<int, int> stateMap;
+    int counter = 0;
+    for (int state : dfa->getAllStates())
+    {
+        stateMap[state] = counter++;
+    }
+    deadState = counter;
+    stateCount = counter + 1;
+    initialState = stateMap.count(dfa->getInitialState()) ? stateMap[dfa->getInitialState()] : deadState;
+
+    acceptStates.assign(stateCount, 0);
+    for (int state : dfa->getAcceptStates())
+    {
+        acceptStates[stateMap[state]] = 1;
+    }
+
+    // 先按字母表中的每个符号建立一列
+    std::vector<unsigned char> symbols;
+    int symbolIndex[256];
+    std::fill(symbolIndex, symbolIndex + 256, -1);
+    for (char c : dfa->getAlphabet())
+    {
+        symbolIndex[static_cast<unsigned char>(c)] = static_cast<int>(symbols.size());
+        symbols.push_back(static_cast<unsigned char>(c));
+    }
+    size_t symbolCount = symbols.size();
+    std::vector<int> columns(symbolCount * stateCount, deadState);
+    for (const Edge &edge : dfa->getEdges())
+    {
+        int k = symbolIndex[static_cast<unsigned char>(edge.w)];
+        columns[k * stateCount + stateMap[edge.u]] = stateMap[edge.v];
+    }
+
+    // 合并转换列完全相同的符号。有字节在每个状态下都转向死状态（不在字母表中或整列为死状态）时，
+    // 等价类0保留给这些字节；256个字节的列各不相同时没有这样的字节，等价类从0开始编号
+    const std::vector<int> deadColumn(stateCount, deadState);
+    bool hasDeadBytes = symbolCount < 256;
+    for (size_t k = 0; k < symbolCount && !hasDeadBytes; k++)
+    {
+        hasDeadBytes = std::equal(deadColumn.begin(), deadColumn.end(), columns.begin() + k * stateCount);
+    }
+    byteClasses.fill(0);
+    classRepresentatives.clear();
+    std::map<std::vector<int>, int> columnToClass;
+    if (hasDeadBytes)
+    {
+        columnToClass[deadColumn] = 0;
+        classRepresentatives.push_back(0);
+    }
+    std::vector<int> symbolClass(symbolCount);
+    for (size_t k = 0; k < symbolCount; k++)
+    {
+        std::vector<int> column(columns.begin() + k * stateCount, columns.begin() + (k + 1) * stateCount);
+        auto it = columnToClass.find(column);
+        if (it == columnToClass.end())
+        {
+            it = columnToClass.emplace(std::move(column), static_cast<int>(classRepresentatives.size())).first;
+            classRepresentatives.push_back(symbols[k]);
+        }
+        symbolClass[k] = it->second;
+    }
+    classCount = static_cast<int>(classRepresentatives.size());
+    if (classCount > 256)
+    {
+        throw std::runtime_error("字节等价类超过256个");
+    }
+
+    // 每个等价类的代表取其中最小的字节
+    std::vector<char> seen(classCount, 0);
+    for (int b = 0; b < 256; b++)
+    {
+        int k = symbolIndex[b];
+        int cls = k < 0 ? 0 : symbolClass[k];
+        byteClasses[b] = static_cast<uint8_t>(cls);
+        if (!seen[cls])
+        {
+            seen[cls] = 1;
+            classRepresentatives[cls] = static_cast<unsigned char>(b);
+        }
+    }
+
+    transitions.assign(static_cast<size_t>(stateCount) * classCount, deadState);
+    for (size_t k = 0; k < symbolCount; k++)
+    {
+        int cls = symbolClass[k];
+        for (int s = 0; s < stateCount; s++)
+        {
+            transitions[static_cast<size_t>(s) * classCount + cls] = columns[k * stateCount + s];
+        }
+    }
+}
+
+DFATable::DFATable(const std::array<uint8_t, 256> &byteClasses, int classCount, int initialState,
+                   std::vector<int> transitions, std::vector<char> acceptStates)
+    : byteClasses(byteClasses), classCount(classCount), stateCount(static_cast<int>(acceptStates.size())),
+      initialState(initialState), deadState(stateCount - 1), transitions(std::move(transitions)),
+      acceptStates(std::move(acceptStates))
+{
+    if (classCount <= 0 || stateCount <= 0 || initialState < 0 || initialState >= stateCount ||
+        this->transitions.size() != static_cast<size_t>(stateCount) * classCount)
+    {
+        throw std::invalid_argument("转换表的尺寸与状态数、等价类数不符");
+    }
+    // 等价类的代表取其中最小的字节
+    classRepresentatives.assign(classCount, 0);
+    std::vector<char> seen(classCount, 0);
+    for (int b = 0; b < 256; b++)
+    {
+        int cls = byteClasses[b];
+        if (cls >= classCount)
+        {
+            throw std::invalid_argument("字节等价类超出等价类数");
+        }
+        if (!seen[cls])
+        {
+            seen[cls] = 1;
+            classRepresentatives[cls] = static_cast<unsigned char>(b);
+        }
+    }
+}
+
+bool DFATable::match(const std::string &input) const
+{
+    return match(input.data(), input.size());
+}
+
+bool DFATable::match(const char *data, size_t length) const
+{
+    const int *table = transitions.data();
+    int state = initialState;
+    for (size_t i = 0; i < length; i++)
+    {
+        state = table[static_cast<size_t>(state) * classCount + byteClasses[static_cast<unsigned char>(data[i])]];
+        if (state == deadState)
+        {
+            return false;
+        }
+    }
+    return acceptStates[state] != 0;
+}
+
+bool DFATable::matchProfiled(const char *data, size_t length, std::vector<uint64_t> &visits) const
+{
+    if (visits.size() < static_cast<size_t>(stateCount))
+    {
+        visits.resize(stateCount, 0);
+    }
+    const int *table = transitions.data();
+    int state = initialState;
+    visits[state]++;
+    for (size_t i = 0; i < length; i++)
+    {
+        state = table[static_cast<size_t>(state) * classCount + byteClasses[static_cast<unsigned char>(data[i])]];
+        visits[state]++;
+        if (state == deadState)
+        {
+            return false;
+        }
+    }
+    return acceptStates[state] != 0;
+}
+
+int DFATable::getStateCount() const
+{
+    return stateCount;
+}
+
+int DFATable::getClassCount() const
+{
+    return classCount;
+}
+
+int DFATable::getInitialState() const
+{
+    return initialState;
+}
+
+int DFATable::getDeadState() const
+{
+    return deadState;
+}
+
+int DFATable::getByteClass(unsigned char c) const
+{
+    return byteClasses[c];
+}
+
+unsigned char DFATable::getClassRepresentative(int symbolClass) const
+{
+    return classRepresentatives[symbolClass];
+}
+
+const std::array<uint8_t, 256> &DFATable::getByteClasses() const
+{
+    return byteClasses;
+}
+
+const std::vector<int> &DFATable::getTransitions() const
+{
+    return transitions;
+}
+
+DFATable DFATable::complement() const
+{
+    DFATable result = *this;
+    for (char &accept : result.acceptStates)
+    {
+        accept = !accept;
+    }
+    // 死状态变成接受状态后不再是“死”的，用一个不存在的编号使match不再提前退出
+    result.deadState = -1;
+    return result;
+}
+
+DFATable DFATable::unanchored() const
+{
+    // 对本表的状态做子集构造，每个子集都包含初始状态
+    DFATable result;
+    result.byteClasses = byteClasses;
+    result.classRepresentatives = classRepresentatives;
+    result.classCount = classCount;
+    result.transitions.clear();
+    result.acceptStates.clear();
+
+    std::map<std::vector<int>, int> subsetToId;
+    std::vector<std::vector<int>> subsets;
+    auto getSubsetId = [&](std::vector<int> subset)
+    {
+        subset.push_back(initialState);
+        std::sort(subset.begin(), subset.end());
+        subset.erase(std::unique(subset.begin(), subset.end()), subset.end());
+        subset.erase(std::remove(subset.begin(), subset.end(), deadState), subset.end());
+        auto it = subsetToId.find(subset);
+        if (it != subsetToId.end())
+        {
+            return it->second;
+        }
+        int id = static_cast<int>(subsets.size());
+        subsetToId.emplace(subset, id);
+        subsets.push_back(std::move(subset));
+        return id;
+    };
+
+    result.initialState = getSubsetId({});
+    std::vector<int> next;
+    for (size_t current = 0; current < subsets.size(); current++)
+    {
+        for (int c = 0; c < classCount; c++)
+        {
+            next.clear();
+            for (int s : subsets[current])
+            {
+                next.push_back(getNextStateByClass(s, c));
+            }
+            int nextId = getSubsetId(next);
+            result.transitions.push_back(nextId);
+        }
+        bool accept = false;
+        for (int s : subsets[current])
+        {
+            accept = accept || acceptStates[s];
+        }
+        result.acceptStates.push_back(accept);
+    }
+
+    // 子集总是包含初始状态因而不会死亡，仍然追加一个不可达的死状态以保持表的约定
+    result.deadState = static_cast<int>(subsets.size());
+    result.stateCount = result.deadState + 1;
+    result.transitions.resize(static_cast<size_t>(result.stateCount) * classCount, result.deadState);
+    result.acceptStates.push_back(0);
+    return result;
+}
+
+DFATable DFATable::renumbered(const std::vector<int> &order) const
+{
+    std::vector<int> newId = invertLayout(order, stateCount, deadState);
+
+    DFATable result = *this;
+    result.initialState = newId[initialState];
+    if (deadState >= 0)
+    {
+        result.deadState = newId[deadState];
+    }
+    for (int s = 0; s < stateCount; s++)
+    {
+        int target = newId[s];
+        result.acceptStates[target] = acceptStates[s];
+        for (int c = 0; c < classCount; c++)
+        {
+            result.transitions[static_cast<size_t>(target) * classCount + c] = newId[getNextStateByClass(s, c)];
+        }
+    }
+    return result;
+}
+
+std::shared_ptr<Graph> DFATable::toGraph() const
+{
+    auto graph = std::make_shared<Graph>();
+    for (int s = 0; s < stateCount; s++)
+    {
+        if (s == deadState)
+            continue;
+        graph->addState(s);
+        if (acceptStates[s])
+        {
+            graph->addAcceptState(s);
+        }
+    }
+    if (initialState != deadState)
+    {
+        graph->setInitialState(initialState);
+    }
+
+    for (int s = 0; s < stateCount; s++)
+    {
+        if (s == deadState)
+            continue;
+        for (int b = 0; b < 256; b++)
+        {
+            int next = getNextState(s, static_cast<unsigned char>(b));
+            if (next != deadState)
+            {
+                graph->addEdge(s, next, static_cast<char>(b));
+            }
+        }
+    }
+    return graph;
+}
+
+size_t DFATable::memoryUsage() const
+{
+    return sizeof(*this) + transitions.capacity() * sizeof(int) +
+           acceptStates.capacity() + classRepresentatives.capacity();
+}
@@ -0,0 +1,74 @@
+#ifndef DFA_TABLE_H
+#define DFA_TABLE_H
+
+#include "graph.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 稠密DFA转换表
+// 将Graph形式的DFA按字节等价类压缩成 状态数 × 等价类数 的二维数组，
+// 缺失的转换统一指向一个显式的死状态，因此转换表是完全的
+class DFATable
+{
+public:
+    DFATable();
+    explicit DFATable(const std::shared_ptr<Graph> &dfa);
+    // 由现成的转换表构造：共acceptStates.size()个状态，最后一个是死状态，
+    // transitions按行存储 状态数 × classCount 项；尺寸不符时抛出std::invalid_argument
+    DFATable(const std::array<uint8_t, 256> &byteClasses, int classCount, int initialState,
+             std::vector<int> transitions, std::vector<char> acceptStates);
+
+    // 判断整个输入是否被接受
+    bool match(const std::string &input) const;
+    bool match(const char *data, size_t length) const;
+    // 同match，并把经过的每个状态（含初始状态）的访问次数累加到visits中，visits不足状态数时先扩展
+    bool matchProfiled(const char *data, size_t length, std::vector<uint64_t> &visits) const;
+
+    // 单步转换
+    int getNextState(int state, unsigned char c) const
+    {
+        return transitions[static_cast<size_t>(state) * classCount + byteClasses[c]];
+    }
+    int getNextStateByClass(int state, int symbolClass) const
+    {
+        return transitions[static_cast<size_t>(state) * classCount + symbolClass];
+    }
+    bool isAccept(int state) const { return acceptStates[state] != 0; }
+
+    int getStateCount() const;
+    int getClassCount() const;
+    int getInitialState() const;
+    int getDeadState() const;
+    int getByteClass(unsigned char c) const;
+    // 获取等价类中最小的字节，用于构造示例字符串
+    unsigned char getClassRepresentative(int symbolClass) const;
+    const std::array<uint8_t, 256> &getByteClasses() const;
+    const std::vector<int> &getTransitions() const;
+
+    // 在全部256个字节上取补
+    DFATable complement() const;
+    // 构造识别 Σ*L 的非锚定DFA，用于在文本任意位置开始匹配
+    DFATable unanchored() const;
+    // 按order重新编号状态：新状态i为原状态order[i]，order须是全部非死状态的一个排列，死状态仍在最后
+    // 语言不变，只改变状态在转换表中的位置，用于让经常一起访问的行相邻（见layout.h）
+    DFATable renumbered(const std::vector<int> &order) const;
+    // 转换回Graph形式（省略死状态及指向它的边）
+    std::shared_ptr<Graph> toGraph() const;
+    // 转换表占用的字节数
+    size_t memoryUsage() const;
+
+private:
+    std::array<uint8_t, 256> byteClasses;      // 字节到等价类的映射
+    std::vector<unsigned char> classRepresentatives; // 每个等价类的代表字节
+    int classCount;                            // 等价类数量
+    int stateCount;                            // 状态数量（包含死状态）
+    int initialState;                          // 初始状态
+    int deadState;                             // 死状态
+    std::vector<int> transitions;              // 转换表，按行存储
+    std::vector<char> acceptStates;            // 接受状态标记
+};
+
+#endif // DFA_TABLE_H
@@ -0,0 +1,343 @@
+#include "equivalence.h"
+#include "dfa.h"
+#include "nfa.h"
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <set>
+#include <stack>
+#include <unordered_map>
+
+namespace
+{
+    // DFATable的适配器
+    class TableAutomaton
+    {
+    public:
+        explicit TableAutomaton(const DFATable &table) : table(table) {}
+
+        int getInitialState() { return table.getInitialState(); }
+        int getNextState(int state, unsigned char c) { return table.getNextState(state, c); }
+        bool isAccept(int state) { return table.isAccept(state); }
+        int getByteClass(unsigned char c) const { return table.getByteClass(c); }
+
+    private:
+        const DFATable &table;
+    };
+
+    // 从NFA按需进行子集构造的DFA
+    class LazySubsetAutomaton
+    {
+    public:
+        explicit LazySubsetAutomaton(const std::shared_ptr<Graph> &nfa) : nfa(nfa)
+        {
+            // 字母表中的每个符号单独成一类，其余字节共用等价类0
+            std::fill(byteClasses, byteClasses + 256, 0);
+            symbols.push_back(0);
+            for (char c : nfa->getAlphabet())
+            {
+                byteClasses[static_cast<unsigned char>(c)] = static_cast<int>(symbols.size());
+                symbols.push_back(c);
+            }
+            initialState = getStateId(epsilonClosure(std::set<int>{nfa->getInitialState()}));
+        }
+
+        int getInitialState() { return initialState; }
+
+        int getNextState(int state, unsigned char c)
+        {
+            int cls = byteClasses[c];
+            size_t index = static_cast<size_t>(state) * symbols.size() + cls;
+            if (transitions[index] != -1)
+            {
+                return transitions[index];
+            }
+            std::set<int> next;
+            if (cls != 0)
+            {
+                next = epsilonClosure(nfa->getNextStates(subsets[state], static_cast<char>(c)));
+            }
+            int nextId = getStateId(next);
+            transitions[static_cast<size_t>(state) * symbols.size() + cls] = nextId;
+            return nextId;
+        }
+
+        bool isAccept(int state) { return accepting[state] != 0; }
+        int getByteClass(unsigned char c) const { return byteClasses[c]; }
+
+    private:
+        std::set<int> epsilonClosure(const std::set<int> &states) const
+        {
+            std::set<int> closure = states;
+            std::stack<int> stack;
+            for (int s : states)
+            {
+                stack.push(s);
+            }
+            while (!stack.empty())
+            {
+                int current = stack.top();
+                stack.pop();
+                for (int next : nfa->getEpsilonStates(current))
+                {
+                    if (closure.insert(next).second)
+                    {
+                        stack.push(next);
+                    }
+                }
+            }
+            return closure;
+        }
+
+        int getStateId(const std::set<int> &states)
+        {
+            auto it = subsetToId.find(states);
+            if (it != subsetToId.end())
+            {
+                return it->second;
+            }
+            int id = static_cast<int>(subsets.size());
+            subsetToId.emplace(states, id);
+            subsets.push_back(states);
+            bool accept = false;
+            for (int s : states)
+            {
+                if (nfa->getAcceptStates().count(s))
+                {
+                    accept = true;
+                    break;
+                }
+            }
+            accepting.push_back(accept);
+            transitions.resize(subsets.size() * symbols.size(), -1);
+            return id;
+        }
+
+        std::shared_ptr<Graph> nfa;
+        int byteClasses[256];
+        std::vector<char> symbols;
+        std::map<std::set<int>, int> subsetToId;
+        std::vector<std::set<int>> subsets;
+        std::vector<char> accepting;
+        std::vector<int> transitions; // -1表示尚未计算
+        int initialState;
+    };
+
+    // 并查集，节点按需添加
+    class UnionFind
+    {
+    public:
+        int add()
+        {
+            parent.push_back(static_cast<int>(parent.size()));
+            return parent.back();
+        }
+
+        int find(int x)
+        {
+            while (parent[x] != x)
+            {
+                parent[x] = parent[parent[x]];
+                x = parent[x];
+            }
+            return x;
+        }
+
+        void unite(int x, int y)
+        {
+            parent[find(x)] = find(y);
+        }
+
+    private:
+        std::vector<int> parent;
+    };
+
+    // 将状态映射为并查集节点
+    int getNode(std::vector<int> &nodes, int state, UnionFind &sets)
+    {
+        if (static_cast<size_t>(state) >= nodes.size())
+        {
+            nodes.resize(state + 1, -1);
+        }
+        if (nodes[state] < 0)
+        {
+            nodes[state] = sets.add();
+        }
+        return nodes[state];
+    }
+
+    template <typename AutomatonA, typename AutomatonB>
+    bool hopcroftKarp(AutomatonA &a, AutomatonB &b, std::string *witness)
+    {
+        // 按(A的等价类, B的等价类)对选出需要尝试的代表字节
+        std::vector<unsigned char> symbols;
+        std::set<std::pair<int, int>> seen;
+        for (int c = 0; c < 256; c++)
+        {
+            auto key = std::make_pair(a.getByteClass(static_cast<unsigned char>(c)),
+                                      b.getByteClass(static_cast<unsigned char>(c)));
+            if (seen.insert(key).second)
+            {
+                symbols.push_back(static_cast<unsigned char>(c));
+            }
+        }
+
+        struct Record
+        {
+            int stateA;
+            int stateB;
+            int parent;          // 前驱记录下标
+            unsigned char symbol; // 从前驱到达时读入的字节
+        };
+        std::vector<Record> records;
+        UnionFind sets;
+        std::vector<int> nodesA, nodesB;
+
+        int mismatch = -1;
+        int initialA = a.getInitialState();
+        int initialB = b.getInitialState();
+        records.push_back({initialA, initialB, -1, 0});
+        if (a.isAccept(initialA) != b.isAccept(initialB))
+        {
+            mismatch = 0;
+        }
+        else
+        {
+            sets.unite(getNode(nodesA, initialA, sets), getNode(nodesB, initialB, sets));
+        }
+
+        // 按广度优先顺序处理，得到的区分字符串通常较短
+        for (size_t head = 0; head < records.size() && mismatch < 0; head++)
+        {
+            for (unsigned char c : symbols)
+            {
+                int nextA = a.getNextState(records[head].stateA, c);
+                int nextB = b.getNextState(records[head].stateB, c);
+                int nodeA = getNode(nodesA, nextA, sets);
+                int nodeB = getNode(nodesB, nextB, sets);
+                if (sets.find(nodeA) == sets.find(nodeB))
+                    continue;
+
+                records.push_back({nextA, nextB, static_cast<int>(head), c});
+                if (a.isAccept(nextA) != b.isAccept(nextB))
+                {
+                    mismatch = static_cast<int>(records.size()) - 1;
+                    break;
+                }
+                sets.unite(nodeA, nodeB);
+            }
+        }
+
+        if (mismatch < 0)
+        {
+            return true;
+        }
+        if (witness)
+        {
+            witness->clear();
+            for (int r = mismatch; records[r].parent >= 0; r = records[r].parent)
+            {
+                witness->push_back(static_cast<char>(records[r].symbol));
+            }
+            std::reverse(witness->begin(), witness->end());
+        }
+        return false;
+    }
+
+    // 计算按长度再按字典序最小的被接受字符串，作为语言的不变量
+    std::string shortlexWitness(const DFATable &table)
+    {
+        // 每个等价类的代表是其中最小的字节，按代表排序即可保证字典序
+        std::vector<int> classes(table.getClassCount());
+        for (int c = 0; c < table.getClassCount(); c++)
+        {
+            classes[c] = c;
+        }
+        std::sort(classes.begin(), classes.end(), [&table](int x, int y)
+                  { return table.getClassRepresentative(x) < table.getClassRepresentative(y); });
+
+        std::vector<int> parent(table.getStateCount(), -1);
+        std::vector<int> parentClass(table.getStateCount(), -1);
+        std::vector<char> visited(table.getStateCount(), 0);
+        std::queue<int> queue;
+        queue.push(table.getInitialState());
+        visited[table.getInitialState()] = 1;
+        while (!queue.empty())
+        {
+            int current = queue.front();
+            queue.pop();
+            if (table.isAccept(current))
+            {
+                std::string result = "+";
+                for (int s = current; s != table.getInitialState(); s = parent[s])
+                {
+                    result.push_back(static_cast<char>(table.getClassRepresentative(parentClass[s])));
+                }
+                std::reverse(result.begin() + 1, result.end());
+                return result;
+            }
+            for (int c : classes)
+            {
+                int next = table.getNextStateByClass(current, c);
+                if (!visited[next])
+                {
+                    visited[next] = 1;
+                    parent[next] = current;
+                    parentClass[next] = c;
+                    queue.push(next);
+                }
+            }
+        }
+        // 空语言
+        return "-";
+    }
+}
+
+bool areEquivalent(const DFATable &a, const DFATable &b, std::string *witness)
+{
+    TableAutomaton left(a), right(b);
+    return hopcroftKarp(left, right, witness);
+}
+
+bool areEquivalent(const std::shared_ptr<Graph> &nfaA, const std::shared_ptr<Graph> &nfaB,
+                   std::string *witness)
+{
+    LazySubsetAutomaton left(nfaA), right(nfaB);
+    return hopcroftKarp(left, right, witness);
+}
+
+std::vector<std::vector<size_t>> groupEquivalentPatterns(const std::vector<std::string> &patterns)
+{
+    NFABuilder nfaBuilder;
+    DFABuilder dfaBuilder;
+    std::vector<DFATable> tables;
+    tables.reserve(patterns.size());
+    for (const auto &pattern : patterns)
+    {
+        tables.emplace_back(dfaBuilder.buildDFA(nfaBuilder.buildNFA(pattern)));
+    }
+
+    // 先按不变量分桶，只在同一桶内做两两比较
+    std::vector<std::vector<size_t>> groups;
+    std::unordered_map<std::string, std::vector<size_t>> buckets; // 不变量到组下标
+    for (size_t i = 0; i < tables.size(); i++)
+    {
+        auto &candidates = buckets[shortlexWitness(tables[i])];
+        bool placed = false;
+        for (size_t groupIndex : candidates)
+        {
+            if (areEquivalent(tables[groups[groupIndex].front()], tables[i]))
+            {
+                groups[groupIndex].push_back(i);
+                placed = true;
+                break;
+            }
+        }
+        if (!placed)
+        {
+            candidates.push_back(groups.size());
+            groups.push_back({i});
+        }
+    }
+    return groups;
+}
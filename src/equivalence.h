@@ -0,0 +1,21 @@
+#ifndef EQUIVALENCE_H
+#define EQUIVALENCE_H
+
+#include "dfa_table.h"
+#include "graph.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// 使用Hopcroft-Karp并查集算法判断两个DFA是否等价
+// 不需要先最小化，复杂度接近线性；不等价时witness返回一个区分两者的字符串
+bool areEquivalent(const DFATable &a, const DFATable &b, std::string *witness = nullptr);
+
+// 直接在两个NFA上判断等价，子集构造只在访问到的状态上惰性进行
+bool areEquivalent(const std::shared_ptr<Graph> &nfaA, const std::shared_ptr<Graph> &nfaB,
+                   std::string *witness = nullptr);
+
+// 将正则表达式列表划分为等价类，每组为原列表中的下标，按首次出现的顺序排列
+std::vector<std::vector<size_t>> groupEquivalentPatterns(const std::vector<std::string> &patterns);
+
+#endif // EQUIVALENCE_H
@@ -16,6 +16,24 @@ void Graph::addEdge(int u, int v, char w)
     transitions[u][w].insert(v);
 }
 
+void Graph::addEpsilonEdge(int u, int v)
+{
+    edges.emplace_back(u, v, 0, true);
+    epsilonTransitions[u].insert(v);
+}
+
+void Graph::addEdge(int u, int v, const Edge &edge)
+{
+    if (edge.epsilon)
+    {
+        addEpsilonEdge(u, v);
+    }
+    else
+    {
+        addEdge(u, v, edge.w);
+    }
+}
+
 void Graph::setInitialState(int state)
 {
     initialState = state;
@@ -48,6 +66,16 @@ std::set<int> Graph::getNextStates(const std::set<int> &S, char c) const
     return result;
 }
 
+std::set<int> Graph::getEpsilonStates(int s) const
+{
+    auto it = epsilonTransitions.find(s);
+    if (it != epsilonTransitions.end())
+    {
+        return it->second;
+    }
+    return std::set<int>();
+}
+
 std::set<int> Graph::getAllStates() const
 {
     return states;
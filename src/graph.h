@@ -6,16 +6,19 @@
 #include <set>
 #include <string>
 
+// ε转换单独标记，不占用0-255中的任何字节，'$'等所有字节都可以作为普通符号。
+// ε转换的w固定为'$'，只在按符号排序输出时使用
 struct Edge
 {
-    int u;  // 起始状态
-    int v;  // 目标状态
-    char w; // 转换字符
+    int u;        // 起始状态
+    int v;        // 目标状态
+    char w;       // 转换字符
+    bool epsilon; // 是否为ε转换
 
-    Edge(int _u, int _v, char _w) : u(_u), v(_v), w(_w) {}
+    Edge(int _u, int _v, char _w, bool _epsilon = false) : u(_u), v(_v), w(_epsilon ? '$' : _w), epsilon(_epsilon) {}
     bool operator==(const Edge &other) const
     {
-        return u == other.u && v == other.v && w == other.w;
+        return u == other.u && v == other.v && w == other.w && epsilon == other.epsilon;
     }
 };
 
@@ -29,6 +32,10 @@ public:
     void addState(int state);
     // 添加边（转换）
     void addEdge(int u, int v, char w);
+    // 添加ε转换
+    void addEpsilonEdge(int u, int v);
+    // 添加一条与edge的符号相同（同为ε或同一字节）的边
+    void addEdge(int u, int v, const Edge &edge);
     // 设置初始状态
     void setInitialState(int state);
     // 添加接受状态
@@ -37,9 +44,11 @@ public:
     std::set<int> getNextStates(int s, char c) const;
     // 获取从状态集合S出发，接受字符c的所有目标状态
     std::set<int> getNextStates(const std::set<int> &S, char c) const;
+    // 获取从状态s出发，经一条ε转换到达的所有目标状态
+    std::set<int> getEpsilonStates(int s) const;
     // 获取所有状态
     std::set<int> getAllStates() const;
-    // 获取所有转换字符
+    // 获取所有转换字符（不包括ε）
     std::set<char> getAlphabet() const;
     // 获取初始状态
     int getInitialState() const;
@@ -57,6 +66,7 @@ private:
     std::unordered_map<int,
                        std::unordered_map<char, std::set<int>>>
         transitions; // 转换函数
+    std::unordered_map<int, std::set<int>> epsilonTransitions; // ε转换
 };
 
 #endif // GRAPH_H
\ No newline at end of file
@@ -0,0 +1,353 @@
+#include "keyword_trie.h"
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+namespace
+{
+    // 字面选择式中可以出现的转义：控制字符或ASCII标点
+    bool parseEscapedByte(char c, char &byte)
+    {
+        if (c == 'n' || c == 't' || c == 'r')
+        {
+            byte = c == 'n' ? '\n' : (c == 't' ? '\t' : '\r');
+            return true;
+        }
+        unsigned char u = static_cast<unsigned char>(c);
+        if (u < 0x80 && u > 0x20 && !std::isalnum(u))
+        {
+            byte = c;
+            return true;
+        }
+        return false;
+    }
+}
+
+KeywordTrie::KeywordTrie()
+    : keywordCount(0), childBegin(2, 0), failure(1, 0), outputLength(1, 0), terminal(1, 0)
+{
+}
+
+KeywordTrie::KeywordTrie(std::vector<std::string> keywords)
+{
+    std::sort(keywords.begin(), keywords.end());
+    keywords.erase(std::unique(keywords.begin(), keywords.end()), keywords.end());
+    if (!keywords.empty() && keywords.front().empty())
+    {
+        throw std::invalid_argument("关键词不能为空串");
+    }
+    keywordCount = keywords.size();
+
+    // 按字典序插入：与上一个关键词的公共前缀已在树中，其余字符依次新建结点，
+    // 因此同一结点的子结点按字节升序产生，结点号为前序编号
+    struct TrieEdge
+    {
+        int parent;
+        unsigned char byte;
+    };
+    std::vector<TrieEdge> edges(1, TrieEdge{-1, 0}); // 下标为子结点号，根结点没有入边
+    std::vector<int> path(1, 0);                     // 上一个关键词经过的结点
+    std::vector<int> depth(1, 0);
+    terminal.assign(1, 0);
+    const std::string *previous = nullptr;
+    for (const std::string &keyword : keywords)
+    {
+        size_t common = 0;
+        if (previous)
+        {
+            size_t limit = std::min(previous->size(), keyword.size());
+            while (common < limit && (*previous)[common] == keyword[common])
+            {
+                common++;
+            }
+        }
+        path.resize(common + 1);
+        for (size_t i = common; i < keyword.size(); i++)
+        {
+            int node = static_cast<int>(edges.size());
+            edges.push_back({path.back(), static_cast<unsigned char>(keyword[i])});
+            depth.push_back(static_cast<int>(i) + 1);
+            terminal.push_back(0);
+            path.push_back(node);
+        }
+        terminal[path.back()] = 1;
+        previous = &keyword;
+    }
+
+    // 按父结点计数排序成CSR，同一父结点的边保持产生顺序（字节升序）
+    const int nodeCount = static_cast<int>(edges.size());
+    childBegin.assign(nodeCount + 1, 0);
+    for (int node = 1; node < nodeCount; node++)
+    {
+        childBegin[edges[node].parent + 1]++;
+    }
+    for (int node = 0; node < nodeCount; node++)
+    {
+        childBegin[node + 1] += childBegin[node];
+    }
+    childBytes.resize(nodeCount - 1);
+    childNodes.resize(nodeCount - 1);
+    std::vector<uint32_t> fill(childBegin.begin(), childBegin.end() - 1);
+    for (int node = 1; node < nodeCount; node++)
+    {
+        uint32_t slot = fill[edges[node].parent]++;
+        childBytes[slot] = edges[node].byte;
+        childNodes[slot] = node;
+    }
+    edges.clear();
+    edges.shrink_to_fit();
+
+    // 按广度优先顺序计算失败链接，父结点的失败链接总是先于子结点算出
+    failure.assign(nodeCount, 0);
+    outputLength.assign(nodeCount, 0);
+    std::vector<int> queue;
+    queue.reserve(nodeCount);
+    queue.push_back(0);
+    for (size_t head = 0; head < queue.size(); head++)
+    {
+        int node = queue[head];
+        for (uint32_t k = childBegin[node]; k < childBegin[node + 1]; k++)
+        {
+            int next = childNodes[k];
+            failure[next] = node == 0 ? 0 : step(failure[node], childBytes[k]);
+            outputLength[next] = terminal[next] ? depth[next] : outputLength[failure[next]];
+            queue.push_back(next);
+        }
+    }
+}
+
+bool KeywordTrie::parseAlternation(const std::string &regex, std::vector<std::string> &keywords)
+{
+    keywords.clear();
+    std::string current;
+    for (size_t i = 0; i < regex.size(); i++)
+    {
+        char c = regex[i];
+        if (c == '|')
+        {
+            if (current.empty())
+            {
+                return false;
+            }
+            keywords.push_back(std::move(current));
+            current.clear();
+        }
+        else if (c == '\\')
+        {
+            char byte;
+            if (i + 1 >= regex.size() || !parseEscapedByte(regex[++i], byte))
+            {
+                return false;
+            }
+            current.push_back(byte);
+        }
+        else if (c == '.' || c == '*' || c == '+' || c == '?' || c == '(' || c == ')' || c == '[' || c == '$')
+        {
+            // 未转义的'$'表示ε转换，交给一般的构造过程
+            return false;
+        }
+        else
+        {
+            // 多字节UTF-8字符在NFA中同样按原字节序列展开
+            current.push_back(c);
+        }
+    }
+    if (current.empty() || keywords.empty())
+    {
+        return false;
+    }
+    keywords.push_back(std::move(current));
+    return true;
+}
+
+int KeywordTrie::child(int node, unsigned char c) const
+{
+    const unsigned char *begin = childBytes.data() + childBegin[node];
+    const unsigned char *end = childBytes.data() + childBegin[node + 1];
+    if (end - begin <= 8)
+    {
+        for (const unsigned char *p = begin; p < end; p++)
+        {
+            if (*p == c)
+            {
+                return childNodes[p - childBytes.data()];
+            }
+        }
+        return -1;
+    }
+    const unsigned char *p = std::lower_bound(begin, end, c);
+    return p != end && *p == c ? childNodes[p - childBytes.data()] : -1;
+}
+
+int KeywordTrie::step(int node, unsigned char c) const
+{
+    while (true)
+    {
+        int next = child(node, c);
+        if (next >= 0)
+        {
+            return next;
+        }
+        if (node == 0)
+        {
+            return 0;
+        }
+        node = failure[node];
+    }
+}
+
+bool KeywordTrie::contains(const char *data, size_t length) const
+{
+    int node = 0;
+    for (size_t i = 0; i < length && node >= 0; i++)
+    {
+        node = child(node, static_cast<unsigned char>(data[i]));
+    }
+    return node >= 0 && terminal[node];
+}
+
+bool KeywordTrie::find(const char *data, size_t length, MatchSpan &match) const
+{
+    int node = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        node = step(node, static_cast<unsigned char>(data[i]));
+        if (outputLength[node] > 0)
+        {
+            match.end = i + 1;
+            match.start = match.end - outputLength[node];
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<MatchSpan> KeywordTrie::findAll(const char *data, size_t length) const
+{
+    std::vector<MatchSpan> matches;
+    size_t position = 0;
+    MatchSpan match;
+    while (position < length && find(data + position, length - position, match))
+    {
+        matches.push_back({position + match.start, position + match.end});
+        position += match.end;
+    }
+    return matches;
+}
+
+std::shared_ptr<Graph> KeywordTrie::toGraph() const
+{
+    auto graph = std::make_shared<Graph>();
+    const int nodeCount = getNodeCount();
+    for (int node = 0; node < nodeCount; node++)
+    {
+        graph->addState(node);
+        if (terminal[node])
+        {
+            graph->addAcceptState(node);
+        }
+    }
+    graph->setInitialState(0);
+    for (int node = 0; node < nodeCount; node++)
+    {
+        for (uint32_t k = childBegin[node]; k < childBegin[node + 1]; k++)
+        {
+            graph->addEdge(node, childNodes[k], static_cast<char>(childBytes[k]));
+        }
+    }
+    return graph;
+}
+
+int KeywordTrie::buildByteClasses(std::array<uint8_t, 256> &byteClasses) const
+{
+    bool used[256] = {false};
+    for (unsigned char c : childBytes)
+    {
+        used[c] = true;
+    }
+    // 关键词用到了全部256个字节时没有死的等价类，从0开始编号
+    byteClasses.fill(0);
+    int classCount = std::count(used, used + 256, true) == 256 ? 0 : 1;
+    for (int b = 0; b < 256; b++)
+    {
+        if (used[b])
+        {
+            byteClasses[b] = static_cast<uint8_t>(classCount++);
+        }
+    }
+    return classCount;
+}
+
+DFATable KeywordTrie::toTable() const
+{
+    std::array<uint8_t, 256> byteClasses;
+    const size_t classCount = buildByteClasses(byteClasses);
+    const int nodeCount = getNodeCount();
+    std::vector<int> transitions((nodeCount + 1) * classCount, nodeCount);
+    for (int node = 0; node < nodeCount; node++)
+    {
+        for (uint32_t k = childBegin[node]; k < childBegin[node + 1]; k++)
+        {
+            transitions[node * classCount + byteClasses[childBytes[k]]] = childNodes[k];
+        }
+    }
+    std::vector<char> accept(terminal);
+    accept.push_back(0);
+    return DFATable(byteClasses, static_cast<int>(classCount), 0, std::move(transitions), std::move(accept));
+}
+
+DFATable KeywordTrie::toSearchTable() const
+{
+    std::array<uint8_t, 256> byteClasses;
+    const size_t classCount = buildByteClasses(byteClasses);
+    const int nodeCount = getNodeCount();
+
+    // 按广度优先顺序展开失败链接：没有子结点的转换沿用失败链接所指结点的那一行，
+    // 该行更浅，已经先算好；根结点上的缺失转换回到根结点
+    std::vector<int> transitions((nodeCount + 1) * classCount, nodeCount);
+    std::vector<int> queue;
+    queue.reserve(nodeCount);
+    queue.push_back(0);
+    for (size_t head = 0; head < queue.size(); head++)
+    {
+        int node = queue[head];
+        int *row = &transitions[node * classCount];
+        if (node == 0)
+        {
+            std::fill(row, row + classCount, 0);
+        }
+        else
+        {
+            const int *fallback = &transitions[failure[node] * classCount];
+            std::copy(fallback, fallback + classCount, row);
+        }
+        for (uint32_t k = childBegin[node]; k < childBegin[node + 1]; k++)
+        {
+            row[byteClasses[childBytes[k]]] = childNodes[k];
+            queue.push_back(childNodes[k]);
+        }
+    }
+
+    std::vector<char> accept(nodeCount + 1, 0);
+    for (int node = 0; node < nodeCount; node++)
+    {
+        accept[node] = outputLength[node] > 0;
+    }
+    return DFATable(byteClasses, static_cast<int>(classCount), 0, std::move(transitions), std::move(accept));
+}
+
+size_t KeywordTrie::getKeywordCount() const
+{
+    return keywordCount;
+}
+
+int KeywordTrie::getNodeCount() const
+{
+    return static_cast<int>(failure.size());
+}
+
+size_t KeywordTrie::memoryUsage() const
+{
+    return childBegin.size() * sizeof(uint32_t) + childBytes.size() + childNodes.size() * sizeof(int) +
+           failure.size() * sizeof(int) + outputLength.size() * sizeof(int) + terminal.size();
+}
@@ -0,0 +1,69 @@
+#ifndef KEYWORD_TRIE_H
+#define KEYWORD_TRIE_H
+
+#include "dfa_table.h"
+#include "graph.h"
+#include "search.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 关键词字典树（带Aho-Corasick失败链接）
+//
+// 只由字面字符串组成的大选择式（foo|bar|baz|...）若按Thompson构造逐对合并再做子集构造，
+// 每次合并都要复制已累积的图，代价随关键词数平方增长。这里把关键词排序后顺序插入，
+// 子结点按字节有序地连续存放（CSR），结点号即前序编号；再按广度优先顺序计算失败链接，
+// 以及每个结点处作为后缀结束的最长关键词长度，用于在文本任意位置开始的搜索。
+//
+// 字典树本身就是识别关键词集合的DFA：toGraph() 给出与NFABuilder/DFABuilder兼容的Graph，
+// toTable() 给出锚定的DFATable，toSearchTable() 把失败链接展开成识别 Σ*K 的完全DFA。
+class KeywordTrie
+{
+public:
+    KeywordTrie();
+    // 关键词可以重复，不能为空串，否则抛出std::invalid_argument
+    explicit KeywordTrie(std::vector<std::string> keywords);
+
+    // 若正则表达式是至少两个字面串的选择，取出各字面串并返回true。
+    // 只接受普通字节和 \n \t \r 及转义的ASCII标点，其余写法（包括未转义的'$'）返回false，交给一般的构造过程
+    static bool parseAlternation(const std::string &regex, std::vector<std::string> &keywords);
+
+    // 整个输入是否恰好是一个关键词
+    bool contains(const char *data, size_t length) const;
+    // 查找结束位置最早的关键词出现，同一结束位置取最长的关键词
+    bool find(const char *data, size_t length, MatchSpan &match) const;
+    // 从每个匹配的结束处继续，查找全部互不重叠的出现
+    std::vector<MatchSpan> findAll(const char *data, size_t length) const;
+
+    // 转换为Graph形式的DFA，状态号为结点号，初始状态为0
+    std::shared_ptr<Graph> toGraph() const;
+    // 锚定的DFA转换表，识别的语言与toGraph()相同
+    DFATable toTable() const;
+    // 非锚定的DFA转换表，在任何以关键词结尾的前缀处接受
+    DFATable toSearchTable() const;
+
+    size_t getKeywordCount() const;
+    int getNodeCount() const;
+    // 字典树数组占用的字节数
+    size_t memoryUsage() const;
+
+private:
+    // 结点node经字节c到达的子结点，不存在时返回-1
+    int child(int node, unsigned char c) const;
+    // 沿失败链接回退直到能经c前进，即Aho-Corasick的转移函数
+    int step(int node, unsigned char c) const;
+    // 关键词中出现过的字节各占一个等价类，其余字节为等价类0；全部256个字节都出现过时从0开始编号，
+    // 返回的等价类数不超过256
+    int buildByteClasses(std::array<uint8_t, 256> &byteClasses) const;
+
+    size_t keywordCount;               // 不同关键词的个数
+    std::vector<uint32_t> childBegin;  // 每个结点的子结点在childBytes/childNodes中的起点，多一项作为终点
+    std::vector<unsigned char> childBytes; // 子结点对应的字节，每个结点内有序
+    std::vector<int> childNodes;       // 子结点号
+    std::vector<int> failure;          // 失败链接，根结点为0
+    std::vector<int> outputLength;     // 在该结点结束的最长关键词长度，0表示没有
+    std::vector<char> terminal;        // 是否恰好是一个关键词的结尾
+};
+
+#endif // KEYWORD_TRIE_H
@@ -0,0 +1,161 @@
+#include "layout.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+    // 广度优先遍历全部状态，输出其中不在exclude里的非死状态
+    template <typename Table>
+    std::vector<int> breadthFirstOrder(const Table &table, const std::vector<char> &exclude)
+    {
+        const int stateCount = table.getStateCount();
+        const int deadState = table.getDeadState();
+        std::vector<char> seen(stateCount, 0);
+        std::vector<int> queue;
+        queue.reserve(stateCount);
+        auto visit = [&](int state)
+        {
+            if (state >= 0 && !seen[state])
+            {
+                seen[state] = 1;
+                queue.push_back(state);
+            }
+        };
+
+        // 先从初始状态出发，再依次从剩下的不可达状态出发
+        visit(table.getInitialState());
+        size_t head = 0;
+        int next = 0;
+        while (true)
+        {
+            for (; head < queue.size(); head++)
+            {
+                for (int cls = 0; cls < table.getClassCount(); cls++)
+                {
+                    visit(table.getNextStateByClass(queue[head], cls));
+                }
+            }
+            while (next < stateCount && seen[next])
+            {
+                next++;
+            }
+            if (next == stateCount)
+            {
+                break;
+            }
+            visit(next);
+        }
+
+        std::vector<int> order;
+        for (int state : queue)
+        {
+            if (state != deadState && !exclude[state])
+            {
+                order.push_back(state);
+            }
+        }
+        return order;
+    }
+
+    template <typename Table>
+    std::vector<int> breadthFirst(const Table &table)
+    {
+        return breadthFirstOrder(table, std::vector<char>(table.getStateCount(), 0));
+    }
+
+    template <typename Table>
+    std::vector<int> byProfile(const Table &table, const std::vector<uint64_t> &visits)
+    {
+        const int stateCount = table.getStateCount();
+        const int deadState = table.getDeadState();
+        auto count = [&visits](int state)
+        {
+            return static_cast<size_t>(state) < visits.size() ? visits[state] : 0;
+        };
+
+        // 被访问过的状态按访问次数从多到少
+        std::vector<int> hot;
+        for (int s = 0; s < stateCount; s++)
+        {
+            if (s != deadState && count(s) != 0)
+            {
+                hot.push_back(s);
+            }
+        }
+        std::stable_sort(hot.begin(), hot.end(), [&count](int a, int b)
+                         { return count(a) > count(b); });
+
+        // 每次从最热的未放置状态开始，沿访问最多的未放置后继连成一条链
+        std::vector<char> placed(stateCount, 0);
+        std::vector<int> order;
+        order.reserve(stateCount);
+        for (int start : hot)
+        {
+            int state = start;
+            while (state >= 0 && !placed[state])
+            {
+                placed[state] = 1;
+                order.push_back(state);
+                int best = -1;
+                for (int cls = 0; cls < table.getClassCount(); cls++)
+                {
+                    int next = table.getNextStateByClass(state, cls);
+                    if (next != deadState && !placed[next] && count(next) != 0 &&
+                        (best < 0 || count(next) > count(best)))
+                    {
+                        best = next;
+                    }
+                }
+                state = best;
+            }
+        }
+
+        std::vector<int> cold = breadthFirstOrder(table, placed);
+        order.insert(order.end(), cold.begin(), cold.end());
+        return order;
+    }
+}
+
+std::vector<int> breadthFirstLayout(const DFATable &table)
+{
+    return breadthFirst(table);
+}
+
+std::vector<int> breadthFirstLayout(const CompressedDFATable &table)
+{
+    return breadthFirst(table);
+}
+
+std::vector<int> profileLayout(const DFATable &table, const std::vector<uint64_t> &visits)
+{
+    return byProfile(table, visits);
+}
+
+std::vector<int> profileLayout(const CompressedDFATable &table, const std::vector<uint64_t> &visits)
+{
+    return byProfile(table, visits);
+}
+
+std::vector<int> invertLayout(const std::vector<int> &order, int stateCount, int deadState)
+{
+    int liveCount = deadState >= 0 ? stateCount - 1 : stateCount;
+    if (static_cast<int>(order.size()) != liveCount)
+    {
+        throw std::invalid_argument("状态顺序的长度与非死状态数不一致");
+    }
+    std::vector<int> newId(stateCount, -1);
+    for (int i = 0; i < liveCount; i++)
+    {
+        int state = order[i];
+        if (state < 0 || state >= stateCount || state == deadState || newId[state] >= 0)
+        {
+            throw std::invalid_argument("状态顺序不是非死状态的排列");
+        }
+        newId[state] = i;
+    }
+    if (deadState >= 0)
+    {
+        newId[deadState] = liveCount;
+    }
+    return newId;
+}
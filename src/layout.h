@@ -0,0 +1,32 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include "compressed_table.h"
+#include "dfa_table.h"
+#include <cstdint>
+#include <vector>
+
+// 转换表的状态布局
+//
+// minimizeDFA按各等价类中最小的原状态号编号状态，与运行时的访问模式无关，热点状态分散在整张转换表中，
+// 每一步查表都可能落在不同的缓存行和页上。下面的函数计算新的状态顺序order
+// （order[i]为新编号i对应的原状态，不含死状态），交给renumbered重新编号：
+//   - 广度优先：不需要样本输入，从初始状态出发按层排列，靠近初始状态的状态最常被访问
+//   - 按访问统计：由matchProfiled在样本输入上得到每个状态的访问次数，
+//     从最热的状态开始沿访问最多的后继连成链依次排列，热点状态及其常见后继因此相邻；
+//     未被访问的状态按广度优先顺序放在最后
+// 死状态始终保留在最后。
+
+// 广度优先顺序
+std::vector<int> breadthFirstLayout(const DFATable &table);
+std::vector<int> breadthFirstLayout(const CompressedDFATable &table);
+
+// 按访问统计的顺序，visits按原状态编号索引，可以短于状态数
+std::vector<int> profileLayout(const DFATable &table, const std::vector<uint64_t> &visits);
+std::vector<int> profileLayout(const CompressedDFATable &table, const std::vector<uint64_t> &visits);
+
+// 检查order并求逆映射：返回原状态到新编号的映射，死状态映射到最后一个编号
+// order不是全部非死状态的排列时抛出std::invalid_argument
+std::vector<int> invertLayout(const std::vector<int> &order, int stateCount, int deadState);
+
+#endif // LAYOUT_H
@@ -0,0 +1,123 @@
+#include "lexer.h"
+#include "dfa.h"
+#include "nfa.h"
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
+Lexer::Lexer() : ruleCount(0), stateRules(1, -1)
+{
+}
+
+Lexer::Lexer(const std::vector<std::string> &rules) : ruleCount(rules.size())
+{
+    if (rules.empty())
+    {
+        throw std::invalid_argument("词法规则为空");
+    }
+
+    // 各规则的NFA状态依次平移编号，并联到新的初始状态0上
+    auto nfa = std::make_shared<Graph>();
+    std::map<int, int> acceptTags;
+    nfa->addState(0);
+    nfa->setInitialState(0);
+    int offset = 1;
+    NFABuilder nfaBuilder;
+    for (size_t rule = 0; rule < rules.size(); rule++)
+    {
+        std::shared_ptr<Graph> ruleNFA;
+        try
+        {
+            ruleNFA = nfaBuilder.buildNFA(rules[rule]);
+        }
+        catch (const std::invalid_argument &e)
+        {
+            throw std::invalid_argument("规则 " + std::to_string(rule) + ": " + e.what());
+        }
+        int next = offset;
+        for (int state : ruleNFA->getAllStates())
+        {
+            nfa->addState(offset + state);
+            next = std::max(next, offset + state + 1);
+        }
+        for (const Edge &edge : ruleNFA->getEdges())
+        {
+            nfa->addEdge(offset + edge.u, offset + edge.v, edge);
+        }
+        nfa->addEpsilonEdge(0, offset + ruleNFA->getInitialState());
+        for (int state : ruleNFA->getAcceptStates())
+        {
+            nfa->addAcceptState(offset + state);
+            acceptTags[offset + state] = static_cast<int>(rule);
+        }
+        offset = next;
+    }
+
+    // 合并后的DFA可能很大，按签名并行细化
+    DFABuilder dfaBuilder;
+    dfaBuilder.setMinimizeMode(MinimizeMode::Parallel);
+    std::map<int, int> dfaTags, minTags;
+    auto dfa = dfaBuilder.buildDFA(nfa, acceptTags, dfaTags);
+    auto minDfa = dfaBuilder.minimizeDFA(dfa, dfaTags, minTags);
+    table = DFATable(minDfa);
+
+    // DFATable按状态号从小到大重新编号，死状态在最后
+    stateRules.assign(table.getStateCount(), -1);
+    int index = 0;
+    for (int state : minDfa->getAllStates())
+    {
+        auto it = minTags.find(state);
+        if (it != minTags.end())
+        {
+            stateRules[index] = it->second;
+        }
+        index++;
+    }
+}
+
+size_t Lexer::tokenize(const char *data, size_t length, LexToken *tokens, size_t capacity, size_t &consumed) const
+{
+    const int initial = table.getInitialState();
+    const int dead = table.getDeadState();
+    const int *rules = stateRules.data();
+    size_t position = 0;
+    size_t count = 0;
+    while (position < length && count < capacity)
+    {
+        // 单趟前进，记住最后一个接受位置，走不下去时回退到那里
+        int state = initial;
+        int lastRule = -1;
+        size_t lastEnd = position;
+        for (size_t i = position; i < length; i++)
+        {
+            state = table.getNextState(state, static_cast<unsigned char>(data[i]));
+            if (state == dead)
+            {
+                break;
+            }
+            if (rules[state] >= 0)
+            {
+                lastRule = rules[state];
+                lastEnd = i + 1;
+            }
+        }
+        if (lastRule < 0)
+        {
+            break;
+        }
+        tokens[count++] = LexToken{lastRule, position, lastEnd - position};
+        position = lastEnd;
+    }
+    consumed = position;
+    return count;
+}
+
+size_t Lexer::getRuleCount() const
+{
+    return ruleCount;
+}
+
+int Lexer::getStateCount() const
+{
+    return table.getStateCount();
+}
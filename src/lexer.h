@@ -0,0 +1,45 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+#include "dfa_table.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// 一个记号：规则号与在输入中的字节范围
+struct LexToken
+{
+    int rule;      // 匹配的规则在规则列表中的下标
+    size_t offset; // 起始字节偏移
+    size_t length; // 字节长度，总是大于0
+};
+
+// 词法分析器
+//
+// 按优先级排列的一组记号规则（正则表达式）合并成一个DFA：各规则的NFA由一个新的初始状态
+// 经ε转换并联，接受状态带规则号，子集构造后取集合中最小的规则号，最小化时不合并规则号不同的
+// 接受状态。切分时从当前位置起沿DFA前进，记住最后经过的接受状态，走到死状态或输入末尾后
+// 回到该位置输出记号（最长匹配，长度相同时前面的规则优先），然后从那里继续。
+// 只能匹配空串的规则不会产生记号。
+class Lexer
+{
+public:
+    Lexer();
+    // 规则有误时抛出std::invalid_argument，消息中带有规则的下标
+    explicit Lexer(const std::vector<std::string> &rules);
+
+    // 从data开头连续切分记号，写入调用方预先分配的tokens，最多capacity个，不做任何内存分配。
+    // 返回写入的记号数，consumed为这些记号覆盖的字节数。
+    // 返回值小于capacity且consumed小于length时，consumed处没有规则能够匹配
+    size_t tokenize(const char *data, size_t length, LexToken *tokens, size_t capacity, size_t &consumed) const;
+
+    size_t getRuleCount() const;
+    int getStateCount() const;
+
+private:
+    size_t ruleCount;
+    DFATable table;              // 合并后的最小DFA
+    std::vector<int> stateRules; // 每个状态接受的规则号，不接受为-1
+};
+
+#endif // LEXER_H
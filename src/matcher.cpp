@@ -0,0 +1,193 @@
+#include "matcher.h"
+#include "dfa.h"
+#include "layout.h"
+#include "nfa.h"
+
+Matcher::Matcher(const std::string &regex, size_t denseLimit, const DFALimits &dfaLimits)
+{
+    NFABuilder nfaBuilder;
+    nfaBuilder.setLimits(dfaLimits);
+    auto nfa = nfaBuilder.buildNFA(regex);
+    DFABuilder dfaBuilder;
+    dfaBuilder.setLimits(dfaLimits);
+    std::shared_ptr<Graph> dfa;
+    try
+    {
+        dfa = dfaBuilder.buildDFA(nfa);
+    }
+    catch (const DFALimitExceeded &e)
+    {
+        // 取消或超时由调用方处理
+        if (e.getKind() == DFALimitKind::Cancelled || e.getKind() == DFALimitKind::Deadline)
+        {
+            throw;
+        }
+        // 确定化会导致状态爆炸，直接模拟NFA，匹配仍是线性时间，内存只与模式长度有关
+        engine = MatcherEngine::BitParallelNFA;
+        bitNFA = BitNFA(nfa);
+        return;
+    }
+    build(dfaBuilder.minimizeDFA(dfa), denseLimit);
+}
+
+Matcher::Matcher(const std::shared_ptr<Graph> &dfa, size_t denseLimit)
+{
+    build(dfa, denseLimit);
+}
+
+void Matcher::build(const std::shared_ptr<Graph> &dfa, size_t denseLimit)
+{
+    // 等价类数不超过字母表大小加一，据此先估计稠密表的上界，小的DFA直接使用稠密表
+    size_t estimate = (dfa->getAllStates().size() + 1) * (dfa->getAlphabet().size() + 1) * sizeof(int);
+    if (estimate <= denseLimit)
+    {
+        engine = MatcherEngine::DenseDFA;
+        dense = DFATable(dfa);
+        return;
+    }
+
+    // 压缩表的构造不需要稠密表；得到准确的等价类数后再确认一次。
+    // 压缩表压缩不到一半时缓存占用与稠密表相近，查表更快的稠密表仍然更好
+    compressed = CompressedDFATable(dfa);
+    if (compressed.denseMemoryUsage() <= denseLimit || compressed.memoryUsage() * 2 > compressed.denseMemoryUsage())
+    {
+        engine = MatcherEngine::DenseDFA;
+        compressed = CompressedDFATable();
+        dense = DFATable(dfa);
+        return;
+    }
+    engine = MatcherEngine::CompressedDFA;
+}
+
+bool Matcher::match(const std::string &input) const
+{
+    return match(input.data(), input.size());
+}
+
+bool Matcher::match(const char *data, size_t length) const
+{
+    switch (engine)
+    {
+    case MatcherEngine::DenseDFA:
+        return dense.match(data, length);
+    case MatcherEngine::CompressedDFA:
+        return compressed.match(data, length);
+    case MatcherEngine::StrideDFA:
+        return stride.match(data, length);
+    default:
+        return bitNFA.match(data, length);
+    }
+}
+
+bool Matcher::matchProfiled(const char *data, size_t length, std::vector<uint64_t> &visits) const
+{
+    switch (engine)
+    {
+    case MatcherEngine::DenseDFA:
+        return dense.matchProfiled(data, length, visits);
+    case MatcherEngine::CompressedDFA:
+        return compressed.matchProfiled(data, length, visits);
+    case MatcherEngine::StrideDFA:
+        // 按一字节表统计，状态编号与双字节表相同
+        return stride.getByteTable().matchProfiled(data, length, visits);
+    default:
+        return bitNFA.match(data, length);
+    }
+}
+
+void Matcher::relayout(const std::vector<uint64_t> &visits)
+{
+    switch (engine)
+    {
+    case MatcherEngine::DenseDFA:
+        dense = dense.renumbered(visits.empty() ? breadthFirstLayout(dense) : profileLayout(dense, visits));
+        break;
+    case MatcherEngine::CompressedDFA:
+        compressed = compressed.renumbered(visits.empty() ? breadthFirstLayout(compressed)
+                                                          : profileLayout(compressed, visits));
+        break;
+    case MatcherEngine::StrideDFA:
+    {
+        // 重新编号一字节表后重建双字节表，大小不变
+        const DFATable &table = stride.getByteTable();
+        DFATable renumbered = table.renumbered(visits.empty() ? breadthFirstLayout(table) : profileLayout(table, visits));
+        stride = StrideDFATable(renumbered, StrideDFATable::estimateMemory(renumbered));
+        break;
+    }
+    default:
+        // 位并行NFA没有状态表
+        break;
+    }
+}
+
+bool Matcher::useStride(size_t limit)
+{
+    if (engine != MatcherEngine::DenseDFA || StrideDFATable::estimateMemory(dense) > limit)
+    {
+        return false;
+    }
+    // 双字节表自带一字节表，不再单独保留稠密表
+    stride = StrideDFATable(dense, limit);
+    dense = DFATable();
+    engine = MatcherEngine::StrideDFA;
+    return true;
+}
+
+MatcherEngine Matcher::getEngine() const
+{
+    return engine;
+}
+
+const char *Matcher::getEngineName() const
+{
+    switch (engine)
+    {
+    case MatcherEngine::DenseDFA:
+        return "DenseDFA";
+    case MatcherEngine::CompressedDFA:
+        return "CompressedDFA";
+    case MatcherEngine::StrideDFA:
+        return "StrideDFA";
+    default:
+        return "BitParallelNFA";
+    }
+}
+
+int Matcher::getStateCount() const
+{
+    switch (engine)
+    {
+    case MatcherEngine::DenseDFA:
+        return dense.getStateCount();
+    case MatcherEngine::CompressedDFA:
+        return compressed.getStateCount();
+    case MatcherEngine::StrideDFA:
+        return stride.getStateCount();
+    default:
+        // 位并行NFA的“状态”是位置
+        return static_cast<int>(bitNFA.getPositionCount());
+    }
+}
+
+size_t Matcher::memoryUsage() const
+{
+    switch (engine)
+    {
+    case MatcherEngine::DenseDFA:
+        return dense.memoryUsage();
+    case MatcherEngine::CompressedDFA:
+        return compressed.memoryUsage();
+    case MatcherEngine::StrideDFA:
+        return stride.memoryUsage();
+    default:
+        return bitNFA.memoryUsage();
+    }
+}
+
+DFALimits Matcher::defaultLimits()
+{
+    DFALimits limits;
+    limits.maxStates = DFA_STATE_LIMIT;
+    limits.maxMemoryBytes = DFA_MEMORY_LIMIT;
+    return limits;
+}
@@ -0,0 +1,73 @@
+#ifndef MATCHER_H
+#define MATCHER_H
+
+#include "bit_nfa.h"
+#include "compressed_table.h"
+#include "dfa.h"
+#include "dfa_table.h"
+#include "graph.h"
+#include "stride_table.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// 匹配引擎
+enum class MatcherEngine
+{
+    DenseDFA,      // 稠密转换表
+    CompressedDFA, // 行位移压缩转换表
+    StrideDFA,     // 双字节步长转换表，由useStride启用
+    BitParallelNFA // 子集构造超出上限时的位并行NFA模拟
+};
+
+// 默认的稠密表大小上限（字节），超过时改用压缩表。
+// 取L2缓存的量级：bench/compressed_bench的字典树DFA上，稠密表115KB时比压缩表快约10%，
+// 200KB～600KB时两者相当，1.9MB时压缩表快约20%，4.6MB时快约90%，42MB时快约5倍
+const size_t DENSE_TABLE_LIMIT = 256 << 10;
+// 默认的子集构造上限，超过时改用位并行NFA
+const size_t DFA_STATE_LIMIT = 10000;
+const size_t DFA_MEMORY_LIMIT = 64 << 20;
+
+// 整串匹配器
+// 根据转换表的缓存占用自动选择表示：小的DFA使用查表最快的稠密表；
+// 稠密表超过denseLimit字节（放不进缓存或内存预算）、且压缩表不到它的一半时使用压缩表，
+// 此时压缩表的工作集小得多，访存缺失的减少超过了查表多出的几条指令。
+// 从正则表达式构造时，子集构造超出dfaLimits则放弃确定化，改用位并行NFA模拟
+class Matcher
+{
+public:
+    explicit Matcher(const std::string &regex, size_t denseLimit = DENSE_TABLE_LIMIT,
+                     const DFALimits &dfaLimits = defaultLimits());
+    // 从最小化后的Graph形式DFA构造
+    explicit Matcher(const std::shared_ptr<Graph> &dfa, size_t denseLimit = DENSE_TABLE_LIMIT);
+
+    bool match(const std::string &input) const;
+    bool match(const char *data, size_t length) const;
+    // 同match，并按状态编号累加每个状态的访问次数，供relayout使用；位并行NFA不统计
+    bool matchProfiled(const char *data, size_t length, std::vector<uint64_t> &visits) const;
+    // 重新编号DFA状态以改善缓存局部性：visits非空时按访问统计，否则按广度优先顺序（见layout.h）
+    // 编号改变后此前收集的visits不再适用
+    void relayout(const std::vector<uint64_t> &visits = std::vector<uint64_t>());
+    // 当前使用稠密表且双字节表不超过limit字节时改用双字节表（见stride_table.h），返回是否改用
+    bool useStride(size_t limit = STRIDE_TABLE_LIMIT);
+
+    MatcherEngine getEngine() const;
+    const char *getEngineName() const;
+    int getStateCount() const;
+    // 所选表示占用的字节数
+    size_t memoryUsage() const;
+
+    // 默认的子集构造上限
+    static DFALimits defaultLimits();
+
+private:
+    void build(const std::shared_ptr<Graph> &dfa, size_t denseLimit);
+
+    MatcherEngine engine;
+    DFATable dense;
+    CompressedDFATable compressed;
+    StrideDFATable stride;
+    BitNFA bitNFA;
+};
+
+#endif // MATCHER_H
@@ -1,80 +1,161 @@
 #include "nfa.h"
+#include "alloc_stats.h"
+#include "keyword_trie.h"
+#include "utf8.h"
 #include <stack>
 #include <algorithm>
 #include <map>
+#include <stdexcept>
+#include <tuple>
 
-#define EPSILON_CHAR '$' // 使用$作为epsilon转换的符号
+#define EPSILON_CHAR '$' // 正则表达式中未转义的$表示epsilon
 
-NFABuilder::NFABuilder() : stateCounter(0) {}
+// 字面选择式的选择项达到这个数目时直接构造字典树；较短的仍按Thompson构造，
+// 界面上显示的NFA与教材中的构造一致
+const size_t KEYWORD_TRIE_MIN_ALTERNATIVES = 32;
+
+// 每隔多少次检查读取一次时钟
+const unsigned CLOCK_CHECK_INTERVAL = 64;
+
+NFABuilder::NFABuilder() : stateCounter(0), captureGroups(false), groupCount(0), keywordTrie(false),
+                           interruptCheckCounter(0) {}
 
 NFABuilder::~NFABuilder() {}
 
+void NFABuilder::setLimits(const DFALimits &newLimits)
+{
+    limits = newLimits;
+}
+
+const DFALimits &NFABuilder::getLimits() const
+{
+    return limits;
+}
+
+bool NFABuilder::builtKeywordTrie() const
+{
+    return keywordTrie;
+}
+
+void NFABuilder::checkInterrupted()
+{
+    size_t stateCount = static_cast<size_t>(stateCounter);
+    if (limits.cancelled && limits.cancelled->load(std::memory_order_relaxed))
+    {
+        throw DFALimitExceeded("NFA构造已被取消", DFALimitKind::Cancelled, stateCount, 0);
+    }
+    // 读取时钟比检查标记昂贵，每隔若干次才检查一次截止时间
+    if (limits.deadline != std::chrono::steady_clock::time_point::max() &&
+        ++interruptCheckCounter % CLOCK_CHECK_INTERVAL == 0 && std::chrono::steady_clock::now() > limits.deadline)
+    {
+        throw DFALimitExceeded("NFA构造超过截止时间", DFALimitKind::Deadline, stateCount, 0);
+    }
+}
+
 std::shared_ptr<Graph> NFABuilder::buildNFA(const std::string &regex)
 {
+    REGEXP_ALLOC_PHASE("buildNFA");
+
     // 重置状态计数器
     stateCounter = 0;
+    tagEdges.clear();
+    fragmentTags.clear();
+    keywordTrie = false;
+
+    // 大的字面选择式（关键词表）若逐对合并，每次都要复制已累积的图，改为直接构造字典树
+    std::vector<std::string> keywords;
+    if (!captureGroups && KeywordTrie::parseAlternation(regex, keywords) &&
+        keywords.size() >= KEYWORD_TRIE_MIN_ALTERNATIVES)
+    {
+        REGEXP_ALLOC_CATEGORY("keywordTrie");
+        keywordTrie = true;
+        return KeywordTrie(std::move(keywords)).toGraph();
+    }
 
     // 先构建NFA
-    std::string postfix = infixToPostfix(regex);
+    std::vector<RegexToken> postfix;
+    {
+        REGEXP_ALLOC_CATEGORY("postfix");
+        postfix = infixToPostfix(regex);
+    }
+    REGEXP_ALLOC_CATEGORY("fragments");
     std::stack<std::shared_ptr<Graph>> nfaStack;
 
-    for (char c : postfix)
+    // 弹出栈顶NFA，缺少操作数说明表达式不完整
+    auto pop = [&nfaStack](char op)
     {
-        if (!isOperator(c))
+        if (nfaStack.empty())
         {
-            nfaStack.push(createBasicNFA(c));
+            throw std::invalid_argument(std::string("运算符 '") + op + "' 缺少操作数");
+        }
+        auto nfa = nfaStack.top();
+        nfaStack.pop();
+        return nfa;
+    };
+
+    for (const RegexToken &token : postfix)
+    {
+        checkInterrupted();
+        if (token.op == 0)
+        {
+            nfaStack.push(createAtomNFA(atoms[token.atom]));
         }
         else
         {
-            switch (c)
+            switch (token.op)
             {
             case '|':
             {
-                auto nfa2 = nfaStack.top();
-                nfaStack.pop();
-                auto nfa1 = nfaStack.top();
-                nfaStack.pop();
+                auto nfa2 = pop('|');
+                auto nfa1 = pop('|');
                 nfaStack.push(createUnionNFA(nfa1, nfa2));
                 break;
             }
             case '.':
             { // 连接运算符
-                auto nfa2 = nfaStack.top();
-                nfaStack.pop();
-                auto nfa1 = nfaStack.top();
-                nfaStack.pop();
+                auto nfa2 = pop('.');
+                auto nfa1 = pop('.');
                 nfaStack.push(createConcatNFA(nfa1, nfa2));
                 break;
             }
             case '*':
             {
-                auto nfa = nfaStack.top();
-                nfaStack.pop();
-                nfaStack.push(createStarNFA(nfa));
+                nfaStack.push(createStarNFA(pop('*')));
                 break;
             }
             case '+':
             {
-                auto nfa = nfaStack.top();
-                nfaStack.pop();
-                nfaStack.push(createPlusNFA(nfa));
+                nfaStack.push(createPlusNFA(pop('+')));
                 break;
             }
             case '?':
             {
-                auto nfa = nfaStack.top();
-                nfaStack.pop();
-                nfaStack.push(createOptionalNFA(nfa));
+                nfaStack.push(createOptionalNFA(pop('?')));
+                break;
+            }
+            case ')':
+            {
+                // 不记录捕获组时括号只用于分组
+                if (captureGroups)
+                {
+                    nfaStack.push(createCaptureNFA(pop(')'), token.atom));
+                }
                 break;
             }
             }
         }
     }
 
+    if (nfaStack.size() != 1)
+    {
+        throw std::invalid_argument(nfaStack.empty() ? "正则表达式为空" : "正则表达式不完整");
+    }
+
     // 获取构建好的NFA
     auto result = nfaStack.top();
 
     // 重新映射所有状态，确保从0开始
+    REGEXP_ALLOC_CATEGORY("Graph");
     auto remappedNFA = std::make_shared<Graph>();
     std::map<int, int> stateMap;
     int newCounter = 0;
@@ -82,6 +163,7 @@ std::shared_ptr<Graph> NFABuilder::buildNFA(const std::string &regex)
     // 创建新的状态映射
     for (int oldState : result->getAllStates())
     {
+        checkInterrupted();
         stateMap[oldState] = newCounter++;
         remappedNFA->addState(stateMap[oldState]);
     }
@@ -89,8 +171,17 @@ std::shared_ptr<Graph> NFABuilder::buildNFA(const std::string &regex)
     // 复制所有边
     for (const Edge &edge : result->getEdges())
     {
-        remappedNFA->addEdge(stateMap[edge.u], stateMap[edge.v], edge.w);
+        remappedNFA->addEdge(stateMap[edge.u], stateMap[edge.v], edge);
+    }
+    auto tags = fragmentTags.find(result.get());
+    if (tags != fragmentTags.end())
+    {
+        for (const auto &tag : tags->second)
+        {
+            tagEdges[{stateMap[tag.first.first], stateMap[tag.first.second]}] = tag.second;
+        }
     }
+    fragmentTags.clear();
 
     // 设置初始状态和接受状态
     remappedNFA->setInitialState(stateMap[result->getInitialState()]);
@@ -102,6 +193,53 @@ std::shared_ptr<Graph> NFABuilder::buildNFA(const std::string &regex)
     return remappedNFA;
 }
 
+TaggedNFA NFABuilder::buildTaggedNFA(const std::string &regex)
+{
+    captureGroups = true;
+    TaggedNFA result;
+    try
+    {
+        result.nfa = buildNFA(regex);
+    }
+    catch (...)
+    {
+        captureGroups = false;
+        throw;
+    }
+    captureGroups = false;
+    result.tagEdges.swap(tagEdges);
+    result.groupCount = groupCount;
+    return result;
+}
+
+std::shared_ptr<Graph> NFABuilder::reverseNFA(const std::shared_ptr<Graph> &nfa)
+{
+    auto reversed = std::make_shared<Graph>();
+    auto states = nfa->getAllStates();
+    for (int state : states)
+    {
+        reversed->addState(state);
+    }
+
+    // 新的初始状态通过ε转换到达原NFA的每个接受状态
+    int start = states.empty() ? 0 : *states.rbegin() + 1;
+    reversed->setInitialState(start);
+    for (int acceptState : nfa->getAcceptStates())
+    {
+        reversed->addEpsilonEdge(start, acceptState);
+    }
+
+    for (const Edge &edge : nfa->getEdges())
+    {
+        reversed->addEdge(edge.v, edge.u, edge);
+    }
+
+    // 原初始状态成为唯一的接受状态
+    reversed->addAcceptState(nfa->getInitialState());
+
+    return reversed;
+}
+
 std::shared_ptr<Graph> NFABuilder::createBasicNFA(char c)
 {
     auto nfa = std::make_shared<Graph>();
@@ -117,6 +255,74 @@ std::shared_ptr<Graph> NFABuilder::createBasicNFA(char c)
     return nfa;
 }
 
+std::shared_ptr<Graph> NFABuilder::createAtomNFA(const RegexAtom &atom)
+{
+    if (atom.isEpsilon)
+    {
+        auto nfa = std::make_shared<Graph>();
+        int start = stateCounter++;
+        int end = stateCounter++;
+        nfa->addState(start);
+        nfa->addState(end);
+        nfa->setInitialState(start);
+        nfa->addAcceptState(end);
+        nfa->addEpsilonEdge(start, end);
+        return nfa;
+    }
+    if (atom.isByte)
+    {
+        return createBasicNFA(static_cast<char>(atom.byte));
+    }
+    if (atom.ranges.size() == 1 && atom.ranges[0].first == atom.ranges[0].second &&
+        atom.ranges[0].first < 0x80)
+    {
+        return createBasicNFA(static_cast<char>(atom.ranges[0].first));
+    }
+
+    auto nfa = std::make_shared<Graph>();
+    int start = stateCounter++;
+    int end = stateCounter++;
+    nfa->addState(start);
+    nfa->addState(end);
+    nfa->setInitialState(start);
+    nfa->addAcceptState(end);
+
+    // 在from和to之间为字节范围内的每个字节添加一条边
+    auto addRange = [&nfa](int from, int to, const ByteRange &range)
+    {
+        for (int b = range.first; b <= range.second; b++)
+        {
+            nfa->addEdge(from, to, static_cast<char>(b));
+        }
+    };
+
+    // 从每个字节序列的末尾向前构造，(字节范围, 后继状态)相同的状态只创建一次
+    std::map<std::tuple<unsigned char, unsigned char, int>, int> suffixStates;
+    for (const auto &range : atom.ranges)
+    {
+        for (const Utf8Sequence &sequence : utf8Sequences(range.first, range.second))
+        {
+            int target = end;
+            for (size_t i = sequence.size() - 1; i > 0; i--)
+            {
+                auto key = std::make_tuple(sequence[i].first, sequence[i].second, target);
+                auto it = suffixStates.find(key);
+                if (it == suffixStates.end())
+                {
+                    int state = stateCounter++;
+                    nfa->addState(state);
+                    addRange(state, target, sequence[i]);
+                    it = suffixStates.emplace(key, state).first;
+                }
+                target = it->second;
+            }
+            addRange(start, target, sequence[0]);
+        }
+    }
+
+    return nfa;
+}
+
 std::shared_ptr<Graph> NFABuilder::createUnionNFA(std::shared_ptr<Graph> nfa1, std::shared_ptr<Graph> nfa2)
 {
     auto result = std::make_shared<Graph>();
@@ -133,16 +339,16 @@ std::shared_ptr<Graph> NFABuilder::createUnionNFA(std::shared_ptr<Graph> nfa1, s
     auto map2 = mergeNFA(result, nfa2);
 
     // 使用映射后的状态添加ε转换
-    result->addEdge(start, map1[nfa1->getInitialState()], EPSILON_CHAR);
-    result->addEdge(start, map2[nfa2->getInitialState()], EPSILON_CHAR);
+    result->addEpsilonEdge(start, map1[nfa1->getInitialState()]);
+    result->addEpsilonEdge(start, map2[nfa2->getInitialState()]);
 
     for (int acceptState : nfa1->getAcceptStates())
     {
-        result->addEdge(map1[acceptState], end, EPSILON_CHAR);
+        result->addEpsilonEdge(map1[acceptState], end);
     }
     for (int acceptState : nfa2->getAcceptStates())
     {
-        result->addEdge(map2[acceptState], end, EPSILON_CHAR);
+        result->addEpsilonEdge(map2[acceptState], end);
     }
 
     return result;
@@ -161,7 +367,7 @@ std::shared_ptr<Graph> NFABuilder::createConcatNFA(std::shared_ptr<Graph> nfa1,
     // 使用映射后的状态连接nfa1的接受状态到nfa2的初始状态
     for (int acceptState : nfa1->getAcceptStates())
     {
-        result->addEdge(map1[acceptState], map2[nfa2->getInitialState()], EPSILON_CHAR);
+        result->addEpsilonEdge(map1[acceptState], map2[nfa2->getInitialState()]);
     }
 
     // 设置nfa2的映射后的接受状态为新NFA的接受状态
@@ -188,13 +394,14 @@ std::shared_ptr<Graph> NFABuilder::createStarNFA(std::shared_ptr<Graph> nfa)
     auto map = mergeNFA(result, nfa);
 
     // 使用映射后的状态添加ε转换
-    result->addEdge(start, end, EPSILON_CHAR);
-    result->addEdge(start, map[nfa->getInitialState()], EPSILON_CHAR);
+    // 同一状态出发的ε边按添加顺序决定捕获组的优先级，先进入循环体（贪婪）
+    result->addEpsilonEdge(start, map[nfa->getInitialState()]);
+    result->addEpsilonEdge(start, end);
 
     for (int acceptState : nfa->getAcceptStates())
     {
-        result->addEdge(map[acceptState], end, EPSILON_CHAR);
-        result->addEdge(map[acceptState], map[nfa->getInitialState()], EPSILON_CHAR);
+        result->addEpsilonEdge(map[acceptState], map[nfa->getInitialState()]);
+        result->addEpsilonEdge(map[acceptState], end);
     }
 
     return result;
@@ -215,12 +422,12 @@ std::shared_ptr<Graph> NFABuilder::createPlusNFA(std::shared_ptr<Graph> nfa)
     auto map = mergeNFA(result, nfa);
 
     // 使用映射后的状态添加ε转换
-    result->addEdge(start, map[nfa->getInitialState()], EPSILON_CHAR);
+    result->addEpsilonEdge(start, map[nfa->getInitialState()]);
 
     for (int acceptState : nfa->getAcceptStates())
     {
-        result->addEdge(map[acceptState], end, EPSILON_CHAR);
-        result->addEdge(map[acceptState], map[nfa->getInitialState()], EPSILON_CHAR);
+        result->addEpsilonEdge(map[acceptState], map[nfa->getInitialState()]);
+        result->addEpsilonEdge(map[acceptState], end);
     }
 
     return result;
@@ -241,12 +448,38 @@ std::shared_ptr<Graph> NFABuilder::createOptionalNFA(std::shared_ptr<Graph> nfa)
     auto map = mergeNFA(result, nfa);
 
     // 使用映射后的状态添加ε转换
-    result->addEdge(start, end, EPSILON_CHAR);
-    result->addEdge(start, map[nfa->getInitialState()], EPSILON_CHAR);
+    result->addEpsilonEdge(start, map[nfa->getInitialState()]);
+    result->addEpsilonEdge(start, end);
+
+    for (int acceptState : nfa->getAcceptStates())
+    {
+        result->addEpsilonEdge(map[acceptState], end);
+    }
+
+    return result;
+}
 
+std::shared_ptr<Graph> NFABuilder::createCaptureNFA(std::shared_ptr<Graph> nfa, int group)
+{
+    auto result = std::make_shared<Graph>();
+    int start = stateCounter++;
+    int end = stateCounter++;
+
+    result->addState(start);
+    result->addState(end);
+    result->setInitialState(start);
+    result->addAcceptState(end);
+
+    auto map = mergeNFA(result, nfa);
+
+    // 起点和终点都是新状态，(起点, 终点)唯一确定一条标记边
+    auto &tags = fragmentTags[result.get()];
+    result->addEpsilonEdge(start, map[nfa->getInitialState()]);
+    tags.push_back({{start, map[nfa->getInitialState()]}, 2 * (group - 1)});
     for (int acceptState : nfa->getAcceptStates())
     {
-        result->addEdge(map[acceptState], end, EPSILON_CHAR);
+        result->addEpsilonEdge(map[acceptState], end);
+        tags.push_back({{map[acceptState], end}, 2 * (group - 1) + 1});
     }
 
     return result;
@@ -274,11 +507,31 @@ int NFABuilder::getPrecedence(char op) const
     }
 }
 
-std::string NFABuilder::infixToPostfix(const std::string &infix)
+std::vector<RegexToken> NFABuilder::infixToPostfix(const std::string &infix)
 {
-    std::string postfix;
+    std::vector<RegexToken> postfix;
     std::stack<char> operators;
+    std::stack<int> openGroups; // 尚未闭合的括号组编号
     bool lastWasOperand = false;
+    atoms.clear();
+    groupCount = 0;
+
+    // 输出一个操作数，必要时先插入显式连接运算符
+    auto pushOperand = [&](int atom)
+    {
+        if (lastWasOperand)
+        {
+            while (!operators.empty() && operators.top() != '(' &&
+                   getPrecedence(operators.top()) >= getPrecedence('.'))
+            {
+                postfix.push_back({operators.top(), -1});
+                operators.pop();
+            }
+            operators.push('.');
+        }
+        postfix.push_back({0, atom});
+        lastWasOperand = true;
+    };
 
     for (size_t i = 0; i < infix.length(); i++)
     {
@@ -286,47 +539,73 @@ std::string NFABuilder::infixToPostfix(const std::string &infix)
 
         if (c == '\\' && i + 1 < infix.length())
         {
-            postfix += infix[++i];
-            lastWasOperand = true;
+            pushOperand(parseEscape(infix, i));
+            continue;
+        }
+
+        if (c == '[')
+        {
+            pushOperand(parseClass(infix, i));
             continue;
         }
 
         if (!isOperator(c) && c != '(' && c != ')')
         {
-            if (lastWasOperand)
+            // 非ASCII字符按UTF-8解码为一个码点，无法解码的字节按原样作为单个字节
+            uint32_t codePoint;
+            size_t next = i;
+            if (static_cast<unsigned char>(c) >= 0x80 && decodeUtf8(infix, next, codePoint))
             {
-                // 插入显式连接运算符
-                while (!operators.empty() && operators.top() != '(' &&
-                       getPrecedence(operators.top()) >= getPrecedence('.'))
-                {
-                    postfix += operators.top();
-                    operators.pop();
-                }
-                operators.push('.');
+                i = next - 1;
+                pushOperand(addCodePointAtom(codePoint));
+            }
+            else if (c == EPSILON_CHAR)
+            {
+                atoms.push_back({false, 0, {}, true});
+                pushOperand(static_cast<int>(atoms.size()) - 1);
+            }
+            else
+            {
+                atoms.push_back({true, static_cast<unsigned char>(c), {}});
+                pushOperand(static_cast<int>(atoms.size()) - 1);
             }
-            postfix += c;
-            lastWasOperand = true;
         }
         else if (c == '(')
         {
             if (lastWasOperand)
             {
+                while (!operators.empty() && operators.top() != '(' &&
+                       getPrecedence(operators.top()) >= getPrecedence('.'))
+                {
+                    postfix.push_back({operators.top(), -1});
+                    operators.pop();
+                }
                 operators.push('.');
             }
             operators.push(c);
+            openGroups.push(++groupCount);
             lastWasOperand = false;
         }
         else if (c == ')')
         {
             while (!operators.empty() && operators.top() != '(')
             {
-                postfix += operators.top();
+                postfix.push_back({operators.top(), -1});
                 operators.pop();
             }
-            if (!operators.empty())
+            if (operators.empty())
             {
-                operators.pop(); // 弹出'('
+                throw std::invalid_argument("括号不匹配：多余的 ')'");
             }
+            operators.pop(); // 弹出'('
+            postfix.push_back({')', openGroups.top()});
+            openGroups.pop();
+            lastWasOperand = true;
+        }
+        else if (c == '*' || c == '+' || c == '?')
+        {
+            // 后缀单目运算符优先级最高，直接输出，之后仍可与后续操作数连接
+            postfix.push_back({c, -1});
             lastWasOperand = true;
         }
         else
@@ -334,7 +613,7 @@ std::string NFABuilder::infixToPostfix(const std::string &infix)
             while (!operators.empty() && operators.top() != '(' &&
                    getPrecedence(operators.top()) >= getPrecedence(c))
             {
-                postfix += operators.top();
+                postfix.push_back({operators.top(), -1});
                 operators.pop();
             }
             operators.push(c);
@@ -344,21 +623,211 @@ std::string NFABuilder::infixToPostfix(const std::string &infix)
 
     while (!operators.empty())
     {
-        postfix += operators.top();
+        if (operators.top() == '(')
+        {
+            throw std::invalid_argument("括号不匹配：缺少 ')'");
+        }
+        postfix.push_back({operators.top(), -1});
         operators.pop();
     }
 
     return postfix;
 }
 
+int NFABuilder::parseEscape(const std::string &infix, size_t &i)
+{
+    // i指向反斜杠
+    char c = infix[++i];
+    if (c == 'u' && i + 1 < infix.length() && infix[i + 1] == '{')
+    {
+        return addCodePointAtom(parseHexCodePoint(infix, i));
+    }
+    if (c == 'p' && infix.compare(i + 1, 5, "{Any}") == 0)
+    {
+        // 任意Unicode标量值
+        i += 5;
+        atoms.push_back({false, 0, {{0, MAX_CODE_POINT}}});
+        return static_cast<int>(atoms.size()) - 1;
+    }
+    if (c == 'n' || c == 't' || c == 'r')
+    {
+        return addCodePointAtom(c == 'n' ? '\n' : (c == 't' ? '\t' : '\r'));
+    }
+
+    // 其他字符按字面处理
+    uint32_t codePoint;
+    size_t next = i;
+    if (decodeUtf8(infix, next, codePoint))
+    {
+        i = next - 1;
+        return addCodePointAtom(codePoint);
+    }
+    atoms.push_back({true, static_cast<unsigned char>(c), {}});
+    return static_cast<int>(atoms.size()) - 1;
+}
+
+int NFABuilder::parseClass(const std::string &infix, size_t &i)
+{
+    // i指向'['
+    i++;
+    bool negated = false;
+    if (i < infix.length() && infix[i] == '^')
+    {
+        negated = true;
+        i++;
+    }
+
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;
+    while (true)
+    {
+        if (i >= infix.length())
+        {
+            throw std::invalid_argument("字符类缺少 ']'");
+        }
+        if (infix[i] == ']')
+        {
+            break;
+        }
+        uint32_t first = parseClassChar(infix, i);
+        uint32_t last = first;
+        if (i + 1 < infix.length() && infix[i] == '-' && infix[i + 1] != ']')
+        {
+            i++;
+            last = parseClassChar(infix, i);
+            if (last < first)
+            {
+                throw std::invalid_argument("字符类中的范围顺序错误");
+            }
+        }
+        ranges.push_back({first, last});
+    }
+
+    // 排序并合并重叠或相邻的范围
+    std::sort(ranges.begin(), ranges.end());
+    std::vector<std::pair<uint32_t, uint32_t>> merged;
+    for (const auto &range : ranges)
+    {
+        if (!merged.empty() && range.first <= merged.back().second + 1)
+        {
+            merged.back().second = std::max(merged.back().second, range.second);
+        }
+        else
+        {
+            merged.push_back(range);
+        }
+    }
+
+    if (negated)
+    {
+        std::vector<std::pair<uint32_t, uint32_t>> complement;
+        uint32_t next = 0;
+        for (const auto &range : merged)
+        {
+            if (range.first > next)
+            {
+                complement.push_back({next, range.first - 1});
+            }
+            next = range.second + 1;
+        }
+        if (next <= MAX_CODE_POINT)
+        {
+            complement.push_back({next, MAX_CODE_POINT});
+        }
+        merged = complement;
+    }
+    if (merged.empty())
+    {
+        throw std::invalid_argument("字符类为空");
+    }
+
+    atoms.push_back({false, 0, merged});
+    return static_cast<int>(atoms.size()) - 1;
+}
+
+uint32_t NFABuilder::parseClassChar(const std::string &infix, size_t &i)
+{
+    // 解析字符类中的一个字符，返回后i指向下一个未处理的字符
+    if (infix[i] == '\\' && i + 1 < infix.length())
+    {
+        char c = infix[++i];
+        if (c == 'u' && i + 1 < infix.length() && infix[i + 1] == '{')
+        {
+            uint32_t codePoint = parseHexCodePoint(infix, i);
+            i++;
+            return codePoint;
+        }
+        if (c == 'n' || c == 't' || c == 'r')
+        {
+            i++;
+            return c == 'n' ? '\n' : (c == 't' ? '\t' : '\r');
+        }
+    }
+    uint32_t codePoint;
+    if (!decodeUtf8(infix, i, codePoint))
+    {
+        throw std::invalid_argument("字符类中包含非法的UTF-8编码");
+    }
+    return codePoint;
+}
+
+uint32_t NFABuilder::parseHexCodePoint(const std::string &infix, size_t &i)
+{
+    // i指向'u'，格式为 u{十六进制}，返回后i指向'}'
+    size_t close = infix.find('}', i);
+    if (close == std::string::npos || close == i + 2)
+    {
+        throw std::invalid_argument("\\u{...} 格式错误");
+    }
+    uint32_t codePoint = 0;
+    for (size_t k = i + 2; k < close; k++)
+    {
+        char h = infix[k];
+        int digit;
+        if (h >= '0' && h <= '9')
+            digit = h - '0';
+        else if (h >= 'a' && h <= 'f')
+            digit = h - 'a' + 10;
+        else if (h >= 'A' && h <= 'F')
+            digit = h - 'A' + 10;
+        else
+            throw std::invalid_argument("\\u{...} 中包含非十六进制字符");
+        codePoint = codePoint * 16 + digit;
+        if (codePoint > MAX_CODE_POINT)
+        {
+            throw std::invalid_argument("码点超出Unicode范围");
+        }
+    }
+    if (codePoint >= 0xD800 && codePoint <= 0xDFFF)
+    {
+        throw std::invalid_argument("码点位于代理区");
+    }
+    i = close;
+    return codePoint;
+}
+
+int NFABuilder::addCodePointAtom(uint32_t codePoint)
+{
+    if (codePoint < 0x80)
+    {
+        atoms.push_back({true, static_cast<unsigned char>(codePoint), {}});
+    }
+    else
+    {
+        atoms.push_back({false, 0, {{codePoint, codePoint}}});
+    }
+    return static_cast<int>(atoms.size()) - 1;
+}
+
 std::map<int, int> NFABuilder::mergeNFA(std::shared_ptr<Graph> &target, const std::shared_ptr<Graph> &source)
 {
     // 创建状态映射
     std::map<int, int> stateMap;
 
     // 为源NFA中的每个状态创建新的状态编号
+    // 每次合并都复制整个子NFA，嵌套很深时合并本身就是构造的主要开销
     for (int oldState : source->getAllStates())
     {
+        checkInterrupted();
         int newState = stateCounter++;
         stateMap[oldState] = newState;
         target->addState(newState);
@@ -367,14 +836,22 @@ std::map<int, int> NFABuilder::mergeNFA(std::shared_ptr<Graph> &target, const st
     // 使用新的状态编号添加边
     for (const Edge &edge : source->getEdges())
     {
-        target->addEdge(stateMap[edge.u], stateMap[edge.v], edge.w);
+        target->addEdge(stateMap[edge.u], stateMap[edge.v], edge);
     }
 
-    // 更新接受状态
-    for (int oldAcceptState : source->getAcceptStates())
+    // 源NFA的标记边随状态一起重新编号并归入target，代价与源NFA的标记边数成正比
+    auto sourceTags = fragmentTags.find(source.get());
+    if (sourceTags != fragmentTags.end())
     {
-        target->addAcceptState(stateMap[oldAcceptState]);
+        auto &targetTags = fragmentTags[target.get()];
+        for (const auto &tag : sourceTags->second)
+        {
+            targetTags.push_back({{stateMap[tag.first.first], stateMap[tag.first.second]}, tag.second});
+        }
+        fragmentTags.erase(sourceTags);
     }
 
+    // 接受状态由调用方根据构造规则重新设置，这里不复制，
+    // 否则子NFA的接受状态会残留为整体NFA的接受状态
     return stateMap;
 }
\ No newline at end of file
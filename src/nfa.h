@@ -1,11 +1,41 @@
 #ifndef NFA_H
 #define NFA_H
 
+#include "dfa.h"
 #include "graph.h"
 #include <string>
 #include <memory>
 #include <stack>
 #include <map>
+#include <vector>
+#include <cstdint>
+
+// 正则表达式中的一个操作数
+struct RegexAtom
+{
+    bool isByte;                                        // 是否为单个字节（ASCII字符或非法的UTF-8字节）
+    unsigned char byte;                                 // 单个字节的值
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;  // 否则为一组码点范围
+    bool isEpsilon = false;                             // 未转义的'$'，表示ε转换
+};
+
+// 后缀表达式中的记号
+struct RegexToken
+{
+    char op;  // 运算符，为0时表示操作数；')'表示结束一个括号组
+    int atom; // 操作数在原子列表中的下标；op为')'时为捕获组编号（从1开始）
+};
+
+// 带捕获组标记的NFA
+// 第k个捕获组（按左括号出现的顺序从1开始编号）的开始标记为2(k-1)，结束标记为2(k-1)+1。
+// 标记位于ε边上，tagEdges记录(起点, 终点)到标记的映射；
+// 同一状态出发的ε边在getEdges()中的先后顺序即匹配时的优先级（最左优先、贪婪）
+struct TaggedNFA
+{
+    std::shared_ptr<Graph> nfa;
+    std::map<std::pair<int, int>, int> tagEdges;
+    int groupCount;
+};
 
 // 正则表达式到NFA的转换器
 class NFABuilder
@@ -14,25 +44,61 @@ public:
     NFABuilder();
     ~NFABuilder();
 
+    // 设置截止时间与取消标记，构造过程中周期性地检查，超出时buildNFA抛出DFALimitExceeded；
+    // NFA的规模与正则表达式的长度成正比，状态数与内存上限不在这里检查
+    void setLimits(const DFALimits &limits);
+    const DFALimits &getLimits() const;
+
     // 构建NFA
     std::shared_ptr<Graph> buildNFA(const std::string &regex);
+    // 构建带捕获组标记的NFA，识别的语言与buildNFA相同
+    TaggedNFA buildTaggedNFA(const std::string &regex);
+
+    // 上一次buildNFA是否把字面选择式直接构造为字典树。字典树本身已是DFA，
+    // 但含大量可合并的公共后缀，最小化时应使用MinimizeMode::Parallel
+    bool builtKeywordTrie() const;
+
+    // 反转NFA的所有边，得到识别逆序语言的NFA
+    std::shared_ptr<Graph> reverseNFA(const std::shared_ptr<Graph> &nfa);
 
 private:
     // Thompson构造法的基本构造单元
     std::shared_ptr<Graph> createBasicNFA(char c);
+    // 将码点范围编译为UTF-8字节序列片段，公共后缀共享状态
+    std::shared_ptr<Graph> createAtomNFA(const RegexAtom &atom);
     std::shared_ptr<Graph> createUnionNFA(std::shared_ptr<Graph> nfa1, std::shared_ptr<Graph> nfa2);
     std::shared_ptr<Graph> createConcatNFA(std::shared_ptr<Graph> nfa1, std::shared_ptr<Graph> nfa2);
     std::shared_ptr<Graph> createStarNFA(std::shared_ptr<Graph> nfa);
     std::shared_ptr<Graph> createPlusNFA(std::shared_ptr<Graph> nfa);
     std::shared_ptr<Graph> createOptionalNFA(std::shared_ptr<Graph> nfa);
+    // 在子NFA前后加上捕获组group的开始和结束标记边
+    std::shared_ptr<Graph> createCaptureNFA(std::shared_ptr<Graph> nfa, int group);
 
     // 辅助函数
     bool isOperator(char c) const;
     int getPrecedence(char op) const;
-    std::string infixToPostfix(const std::string &infix);
+    std::vector<RegexToken> infixToPostfix(const std::string &infix);
     std::map<int, int> mergeNFA(std::shared_ptr<Graph> &target, const std::shared_ptr<Graph> &source);
+    // 检查是否已被取消或超过截止时间
+    void checkInterrupted();
+
+    // 词法分析辅助函数，解析出的操作数追加到atoms中并返回下标
+    int parseEscape(const std::string &infix, size_t &i);
+    int parseClass(const std::string &infix, size_t &i);
+    uint32_t parseClassChar(const std::string &infix, size_t &i);
+    uint32_t parseHexCodePoint(const std::string &infix, size_t &i);
+    int addCodePointAtom(uint32_t codePoint);
 
-    int stateCounter; // 状态计数器，用于生成唯一的状态ID
+    int stateCounter;             // 状态计数器，用于生成唯一的状态ID
+    std::vector<RegexAtom> atoms; // 当前正则表达式的操作数
+    bool captureGroups;           // 是否为括号组生成标记边
+    std::map<std::pair<int, int>, int> tagEdges; // 当前正则表达式的标记边
+    // 构造过程中各片段自己的标记边，合并时只重新编号被合并片段的标记边
+    std::map<const Graph *, std::vector<std::pair<std::pair<int, int>, int>>> fragmentTags;
+    int groupCount;               // 当前正则表达式的括号组数
+    bool keywordTrie;             // 上一次buildNFA是否构造了字典树
+    DFALimits limits;             // 截止时间与取消标记
+    unsigned interruptCheckCounter; // 控制读取时钟的频率
 };
 
 #endif // NFA_H
\ No newline at end of file
@@ -0,0 +1,294 @@
+#include "product.h"
+#include <algorithm>
+#include <map>
+#include <queue>
+
+namespace
+{
+    // 反向广度优先搜索，标记能够到达目标状态（接受或拒绝）的所有状态
+    std::vector<char> computeCoReachable(const DFATable &table, bool acceptTarget)
+    {
+        int stateCount = table.getStateCount();
+        int classCount = table.getClassCount();
+        std::vector<std::vector<int>> predecessors(stateCount);
+        for (int s = 0; s < stateCount; s++)
+        {
+            for (int c = 0; c < classCount; c++)
+            {
+                predecessors[table.getNextStateByClass(s, c)].push_back(s);
+            }
+        }
+
+        std::vector<char> reachable(stateCount, 0);
+        std::queue<int> queue;
+        for (int s = 0; s < stateCount; s++)
+        {
+            if (table.isAccept(s) == acceptTarget)
+            {
+                reachable[s] = 1;
+                queue.push(s);
+            }
+        }
+        while (!queue.empty())
+        {
+            int current = queue.front();
+            queue.pop();
+            for (int prev : predecessors[current])
+            {
+                if (!reachable[prev])
+                {
+                    reachable[prev] = 1;
+                    queue.push(prev);
+                }
+            }
+        }
+        return reachable;
+    }
+}
+
+ProductDFA::ProductDFA(const DFATable &left, const DFATable &right, ProductOperation operation)
+    : left(left), right(right), operation(operation)
+{
+    // 按(左等价类, 右等价类)对划分256个字节
+    std::map<std::pair<int, int>, int> jointClasses;
+    for (int b = 0; b < 256; b++)
+    {
+        auto key = std::make_pair(left.getByteClass(static_cast<unsigned char>(b)),
+                                  right.getByteClass(static_cast<unsigned char>(b)));
+        if (jointClasses.emplace(key, static_cast<int>(leftClass.size())).second)
+        {
+            leftClass.push_back(key.first);
+            rightClass.push_back(key.second);
+            classRepresentatives.push_back(static_cast<unsigned char>(b));
+        }
+    }
+
+    leftCanAccept = computeCoReachable(left, true);
+    leftCanReject = computeCoReachable(left, false);
+    rightCanAccept = computeCoReachable(right, true);
+    rightCanReject = computeCoReachable(right, false);
+}
+
+int ProductDFA::getInitialState()
+{
+    if (!isViable(left.getInitialState(), right.getInitialState()))
+    {
+        return -1;
+    }
+    return getPairId(left.getInitialState(), right.getInitialState());
+}
+
+int ProductDFA::getNextState(int state, int symbolClass)
+{
+    int classCount = getClassCount();
+    size_t index = static_cast<size_t>(state) * classCount + symbolClass;
+    if (transitions[index] != -2)
+    {
+        return transitions[index];
+    }
+
+    int nextLeft = left.getNextStateByClass(pairs[state].first, leftClass[symbolClass]);
+    int nextRight = right.getNextStateByClass(pairs[state].second, rightClass[symbolClass]);
+    int next = isViable(nextLeft, nextRight) ? getPairId(nextLeft, nextRight) : -1;
+    // getPairId可能使transitions扩容，这里重新按下标写入
+    transitions[index] = next;
+    return next;
+}
+
+bool ProductDFA::isAccept(int state) const
+{
+    return evaluate(left.isAccept(pairs[state].first), right.isAccept(pairs[state].second));
+}
+
+int ProductDFA::getClassCount() const
+{
+    return static_cast<int>(classRepresentatives.size());
+}
+
+unsigned char ProductDFA::getClassRepresentative(int symbolClass) const
+{
+    return classRepresentatives[symbolClass];
+}
+
+int ProductDFA::getStateCount() const
+{
+    return static_cast<int>(pairs.size());
+}
+
+bool ProductDFA::findWitness(std::string &witness)
+{
+    int initial = getInitialState();
+    if (initial < 0)
+    {
+        return false;
+    }
+
+    // 状态编号按访问顺序分配，这里记录每个新状态第一次被发现时的前驱和符号
+    std::vector<int> parent(pairs.size(), -1);
+    std::vector<int> parentClass(pairs.size(), -1);
+    std::vector<char> visited(pairs.size(), 0);
+    std::queue<int> queue;
+    visited[initial] = 1;
+    queue.push(initial);
+
+    int found = -1;
+    while (!queue.empty() && found < 0)
+    {
+        int current = queue.front();
+        queue.pop();
+        if (isAccept(current))
+        {
+            found = current;
+            break;
+        }
+
+        for (int c = 0; c < getClassCount(); c++)
+        {
+            int next = getNextState(current, c);
+            if (next < 0)
+                continue;
+            if (static_cast<size_t>(next) >= visited.size())
+            {
+                visited.resize(pairs.size(), 0);
+                parent.resize(pairs.size(), -1);
+                parentClass.resize(pairs.size(), -1);
+            }
+            if (visited[next])
+                continue;
+            visited[next] = 1;
+            parent[next] = current;
+            parentClass[next] = c;
+            queue.push(next);
+        }
+    }
+
+    if (found < 0)
+    {
+        return false;
+    }
+
+    witness.clear();
+    for (int s = found; s != initial; s = parent[s])
+    {
+        witness.push_back(static_cast<char>(classRepresentatives[parentClass[s]]));
+    }
+    std::reverse(witness.begin(), witness.end());
+    return true;
+}
+
+bool ProductDFA::isEmpty()
+{
+    std::string witness;
+    return !findWitness(witness);
+}
+
+std::shared_ptr<Graph> ProductDFA::toGraph()
+{
+    auto dfa = std::make_shared<Graph>();
+    int initial = getInitialState();
+    if (initial < 0)
+    {
+        return dfa;
+    }
+    dfa->setInitialState(initial);
+
+    // 状态编号连续分配，按编号顺序处理即是广度优先遍历
+    for (int current = 0; current < getStateCount(); current++)
+    {
+        dfa->addState(current);
+        if (isAccept(current))
+        {
+            dfa->addAcceptState(current);
+        }
+        for (int c = 0; c < getClassCount(); c++)
+        {
+            int next = getNextState(current, c);
+            if (next < 0)
+                continue;
+            // 联合等价类中的每个字节都对应一条边
+            for (int b = 0; b < 256; b++)
+            {
+                if (left.getByteClass(static_cast<unsigned char>(b)) == leftClass[c] &&
+                    right.getByteClass(static_cast<unsigned char>(b)) == rightClass[c])
+                {
+                    dfa->addEdge(current, next, static_cast<char>(b));
+                }
+            }
+        }
+    }
+    return dfa;
+}
+
+int ProductDFA::getPairId(int leftState, int rightState)
+{
+    uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(leftState)) << 32) |
+                   static_cast<uint32_t>(rightState);
+    auto it = pairToId.find(key);
+    if (it != pairToId.end())
+    {
+        return it->second;
+    }
+    int id = static_cast<int>(pairs.size());
+    pairToId.emplace(key, id);
+    pairs.emplace_back(leftState, rightState);
+    transitions.resize(pairs.size() * getClassCount(), -2);
+    return id;
+}
+
+bool ProductDFA::evaluate(bool inLeft, bool inRight) const
+{
+    switch (operation)
+    {
+    case ProductOperation::Intersection:
+        return inLeft && inRight;
+    case ProductOperation::Union:
+        return inLeft || inRight;
+    case ProductOperation::Difference:
+        return inLeft && !inRight;
+    case ProductOperation::SymmetricDifference:
+        return inLeft != inRight;
+    }
+    return false;
+}
+
+bool ProductDFA::isViable(int leftState, int rightState) const
+{
+    // 只要两侧各自可能达到的接受情况组合中有一种满足运算，该状态对就可能到达接受状态
+    for (int l = 0; l < 2; l++)
+    {
+        if (!(l ? leftCanAccept[leftState] : leftCanReject[leftState]))
+            continue;
+        for (int r = 0; r < 2; r++)
+        {
+            if (!(r ? rightCanAccept[rightState] : rightCanReject[rightState]))
+                continue;
+            if (evaluate(l != 0, r != 0))
+                return true;
+        }
+    }
+    return false;
+}
+
+bool intersects(const DFATable &a, const DFATable &b, std::string *witness)
+{
+    ProductDFA product(a, b, ProductOperation::Intersection);
+    std::string example;
+    bool found = product.findWitness(example);
+    if (found && witness)
+    {
+        *witness = example;
+    }
+    return found;
+}
+
+bool isSubsetOf(const DFATable &a, const DFATable &b, std::string *counterexample)
+{
+    ProductDFA product(a, b, ProductOperation::Difference);
+    std::string example;
+    bool found = product.findWitness(example);
+    if (found && counterexample)
+    {
+        *counterexample = example;
+    }
+    return !found;
+}
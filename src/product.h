@@ -0,0 +1,76 @@
+#ifndef PRODUCT_H
+#define PRODUCT_H
+
+#include "dfa_table.h"
+#include "graph.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 乘积自动机的组合方式
+enum class ProductOperation
+{
+    Intersection,       // L(A) ∩ L(B)
+    Union,              // L(A) ∪ L(B)
+    Difference,         // L(A) - L(B)
+    SymmetricDifference // L(A) △ L(B)
+};
+
+// 惰性乘积自动机
+// 状态对(p, q)只在被访问到时才分配编号，转换也按需计算并缓存。
+// 无法再到达接受状态的状态对会被剪枝，因此空性检查通常只需访问很小一部分乘积。
+// 构造时保存的是两个转换表的引用，使用期间它们必须保持有效。
+class ProductDFA
+{
+public:
+    ProductDFA(const DFATable &left, const DFATable &right, ProductOperation operation);
+
+    // 获取初始状态，-1表示乘积语言为空
+    int getInitialState();
+    // 获取状态在联合等价类上的后继，-1表示被剪枝的死状态
+    int getNextState(int state, int symbolClass);
+    bool isAccept(int state) const;
+
+    // 联合字节等价类：两个转换表的等价类对
+    int getClassCount() const;
+    unsigned char getClassRepresentative(int symbolClass) const;
+    // 已经生成的状态数
+    int getStateCount() const;
+
+    // 广度优先搜索最短的被接受字符串，找到第一个接受状态对即停止
+    bool findWitness(std::string &witness);
+    bool isEmpty();
+
+    // 展开全部可达状态，得到与DFABuilder输出兼容的DFA
+    std::shared_ptr<Graph> toGraph();
+
+private:
+    int getPairId(int leftState, int rightState);
+    bool evaluate(bool inLeft, bool inRight) const;
+    bool isViable(int leftState, int rightState) const;
+
+    const DFATable &left;
+    const DFATable &right;
+    ProductOperation operation;
+
+    std::vector<int> leftClass;                        // 联合等价类到左侧等价类
+    std::vector<int> rightClass;                       // 联合等价类到右侧等价类
+    std::vector<unsigned char> classRepresentatives;   // 联合等价类的代表字节
+
+    // 每个状态能否到达接受/拒绝状态，用于剪枝
+    std::vector<char> leftCanAccept, leftCanReject;
+    std::vector<char> rightCanAccept, rightCanReject;
+
+    std::vector<std::pair<int, int>> pairs;            // 状态编号到状态对
+    std::unordered_map<uint64_t, int> pairToId;        // 状态对到状态编号
+    std::vector<int> transitions;                      // 缓存的转换，-2表示尚未计算
+};
+
+// 判断两个DFA的语言是否相交，witness返回最短的公共字符串
+bool intersects(const DFATable &a, const DFATable &b, std::string *witness = nullptr);
+// 判断L(a)是否包含于L(b)，counterexample返回最短的反例
+bool isSubsetOf(const DFATable &a, const DFATable &b, std::string *counterexample = nullptr);
+
+#endif // PRODUCT_H
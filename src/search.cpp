@@ -0,0 +1,218 @@
+#include "search.h"
+#include "dfa.h"
+#include "nfa.h"
+#include <cstdint>
+
+Searcher::Searcher(const std::string &regex)
+{
+    NFABuilder nfaBuilder;
+    build(nfaBuilder.buildNFA(regex));
+}
+
+Searcher::Searcher(const std::shared_ptr<Graph> &nfa)
+{
+    build(nfa);
+}
+
+void Searcher::build(const std::shared_ptr<Graph> &nfa)
+{
+    NFABuilder nfaBuilder;
+    DFABuilder dfaBuilder;
+
+    forward = DFATable(dfaBuilder.minimizeDFA(dfaBuilder.buildDFA(nfa)));
+    forwardUnanchored = forward.unanchored();
+
+    auto reversed = nfaBuilder.reverseNFA(nfa);
+    reverseUnanchored = DFATable(dfaBuilder.minimizeDFA(dfaBuilder.buildDFA(reversed))).unanchored();
+}
+
+bool Searcher::search(const std::string &text, MatchSpan &match) const
+{
+    return search(text.data(), text.size(), match);
+}
+
+bool Searcher::search(const char *data, size_t length, MatchSpan &match) const
+{
+    long long lastEnd = findLastEnd(data, length);
+    if (lastEnd < 0)
+    {
+        return false;
+    }
+
+    std::vector<char> starts;
+    findStarts(data, static_cast<size_t>(lastEnd), starts);
+    for (size_t i = 0; i <= static_cast<size_t>(lastEnd); i++)
+    {
+        if (starts[i])
+        {
+            match.start = i;
+            match.end = static_cast<size_t>(findLongestEnd(data, i, static_cast<size_t>(lastEnd)));
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<MatchSpan> Searcher::findAll(const std::string &text) const
+{
+    return findAll(text.data(), text.size());
+}
+
+std::vector<MatchSpan> Searcher::findAll(const char *data, size_t length) const
+{
+    std::vector<MatchSpan> matches;
+    long long lastEnd = findLastEnd(data, length);
+    if (lastEnd < 0)
+    {
+        return matches;
+    }
+
+    // 起点集合只依赖文本本身，整段文本只需反向扫描一次
+    std::vector<char> starts;
+    findStarts(data, static_cast<size_t>(lastEnd), starts);
+    std::vector<long long> longestEnds;
+    findLongestEnds(data, starts, static_cast<size_t>(lastEnd), longestEnds);
+
+    size_t position = 0;
+    while (position <= static_cast<size_t>(lastEnd))
+    {
+        if (!starts[position])
+        {
+            position++;
+            continue;
+        }
+        size_t end = static_cast<size_t>(longestEnds[position]);
+        matches.push_back({position, end});
+        position = end > position ? end : position + 1;
+    }
+    return matches;
+}
+
+long long Searcher::findLastEnd(const char *data, size_t length) const
+{
+    int state = forwardUnanchored.getInitialState();
+    long long lastEnd = forwardUnanchored.isAccept(state) ? 0 : -1;
+    for (size_t i = 0; i < length; i++)
+    {
+        state = forwardUnanchored.getNextState(state, static_cast<unsigned char>(data[i]));
+        if (forwardUnanchored.isAccept(state))
+        {
+            lastEnd = static_cast<long long>(i) + 1;
+        }
+    }
+    return lastEnd;
+}
+
+void Searcher::findStarts(const char *data, size_t lastEnd, std::vector<char> &starts) const
+{
+    // 读入 data[i, lastEnd) 的逆序后处于接受状态，说明存在从i开始、不晚于lastEnd结束的匹配
+    starts.assign(lastEnd + 1, 0);
+    int state = reverseUnanchored.getInitialState();
+    starts[lastEnd] = reverseUnanchored.isAccept(state);
+    for (size_t i = lastEnd; i > 0; i--)
+    {
+        state = reverseUnanchored.getNextState(state, static_cast<unsigned char>(data[i - 1]));
+        starts[i - 1] = reverseUnanchored.isAccept(state);
+    }
+}
+
+long long Searcher::findLongestEnd(const char *data, size_t start, size_t limit) const
+{
+    int state = forward.getInitialState();
+    long long longestEnd = forward.isAccept(state) ? static_cast<long long>(start) : -1;
+    for (size_t i = start; i < limit; i++)
+    {
+        state = forward.getNextState(state, static_cast<unsigned char>(data[i]));
+        if (state == forward.getDeadState())
+        {
+            break;
+        }
+        if (forward.isAccept(state))
+        {
+            longestEnd = static_cast<long long>(i) + 1;
+        }
+    }
+    return longestEnd;
+}
+
+void Searcher::findLongestEnds(const char *data, const std::vector<char> &starts, size_t limit,
+                               std::vector<long long> &longestEnds) const
+{
+    // 从每个起点出发的锚定运行同时推进。两个运行在同一位置处于同一状态后，之后的转换完全相同，
+    // 只保留其中一个继续推进，被合并的运行记下合并位置和合并到的运行：它的最长终点是
+    // 合并之前自己的最后一个接受位置，与合并到的运行在合并位置及之后的最后一个接受位置中的较大者。
+    // 每一步活跃的运行不超过状态数，整个过程是对文本的单次扫描
+    struct Run
+    {
+        int state;
+        size_t start;
+    };
+    struct Merge
+    {
+        size_t start;    // 被合并的运行的起点
+        size_t target;   // 合并到的运行的起点
+        size_t position; // 合并位置
+    };
+    longestEnds.assign(limit + 1, -1);
+    std::vector<Merge> merges;
+    std::vector<Run> runs, nextRuns;
+    // owner[state]为本步处于该状态的运行在nextRuns中的下标，stamp标记owner是否属于本步
+    std::vector<size_t> owner(forward.getStateCount());
+    std::vector<size_t> stamp(forward.getStateCount(), SIZE_MAX);
+    const int initial = forward.getInitialState();
+    const int dead = forward.getDeadState();
+
+    // 加入一个处于state的运行，已有运行处于该状态时合并
+    auto addRun = [&](int state, size_t start, size_t position)
+    {
+        if (stamp[state] == position)
+        {
+            merges.push_back({start, nextRuns[owner[state]].start, position});
+            return;
+        }
+        stamp[state] = position;
+        owner[state] = nextRuns.size();
+        nextRuns.push_back({state, start});
+        if (forward.isAccept(state))
+        {
+            longestEnds[start] = static_cast<long long>(position);
+        }
+    };
+
+    for (size_t i = 0;; i++)
+    {
+        nextRuns.clear();
+        if (i > 0)
+        {
+            unsigned char c = static_cast<unsigned char>(data[i - 1]);
+            for (const Run &run : runs)
+            {
+                int state = forward.getNextState(run.state, c);
+                if (state != dead)
+                {
+                    addRun(state, run.start, i);
+                }
+            }
+        }
+        if (starts[i])
+        {
+            addRun(initial, i, i);
+        }
+        runs.swap(nextRuns);
+        if (i == limit)
+        {
+            break;
+        }
+    }
+
+    // 合并位置递增，合并到的运行若再被合并，其合并位置更大，逆序处理时它的结果已经确定
+    for (size_t k = merges.size(); k > 0; k--)
+    {
+        const Merge &merge = merges[k - 1];
+        long long targetEnd = longestEnds[merge.target];
+        if (targetEnd >= static_cast<long long>(merge.position) && targetEnd > longestEnds[merge.start])
+        {
+            longestEnds[merge.start] = targetEnd;
+        }
+    }
+}
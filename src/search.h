@@ -0,0 +1,62 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "dfa_table.h"
+#include "graph.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// 匹配区间 [start, end)
+struct MatchSpan
+{
+    size_t start;
+    size_t end;
+};
+
+// 最左最长语义的文本搜索器
+//
+// 语义：在所有匹配中选择起点最小的；起点相同时选择终点最大的。
+// findAll 从上一个匹配的终点继续搜索，返回互不重叠的匹配；
+// 空匹配之后从下一个字节继续，因此同一位置不会重复报告。
+//
+// 实现：
+//   1. 非锚定正向DFA（Σ*R）扫描文本，得到最后一个匹配终点 lastEnd，没有终点即无匹配；
+//   2. 由反转NFA确定化得到的非锚定反向DFA（Σ*R'）从 lastEnd 向前扫描一次，
+//      位置i处于接受状态当且仅当有匹配从i开始，从而得到全部匹配起点；
+//   3. 从最左起点用锚定正向DFA向后运行到死状态或 lastEnd，记录最后一个接受位置。
+// findAll的第三遍同时推进从所有起点出发的锚定运行，处于同一状态的运行合并，
+// 一次扫描得到每个起点的最长终点，再依次取不重叠的匹配。
+// 三遍都是对输入的单次扫描，每个字节的代价不超过锚定DFA的状态数，与匹配的个数和前瞻的长度无关。
+class Searcher
+{
+public:
+    explicit Searcher(const std::string &regex);
+    explicit Searcher(const std::shared_ptr<Graph> &nfa);
+
+    // 查找第一个（最左最长）匹配
+    bool search(const std::string &text, MatchSpan &match) const;
+    bool search(const char *data, size_t length, MatchSpan &match) const;
+
+    // 查找全部互不重叠的匹配
+    std::vector<MatchSpan> findAll(const std::string &text) const;
+    std::vector<MatchSpan> findAll(const char *data, size_t length) const;
+
+private:
+    void build(const std::shared_ptr<Graph> &nfa);
+    // 正向扫描，返回最后一个匹配终点，-1表示没有匹配
+    long long findLastEnd(const char *data, size_t length) const;
+    // 从lastEnd向前扫描，标记所有匹配起点
+    void findStarts(const char *data, size_t lastEnd, std::vector<char> &starts) const;
+    // 从start开始的最长匹配终点，-1表示没有匹配
+    long long findLongestEnd(const char *data, size_t start, size_t limit) const;
+    // 对starts中的每个起点求不晚于limit的最长匹配终点，结果按起点存入longestEnds
+    void findLongestEnds(const char *data, const std::vector<char> &starts, size_t limit,
+                         std::vector<long long> &longestEnds) const;
+
+    DFATable forward;           // 锚定正向DFA
+    DFATable forwardUnanchored; // 非锚定正向DFA
+    DFATable reverseUnanchored; // 非锚定反向DFA
+};
+
+#endif // SEARCH_H
@@ -0,0 +1,134 @@
+#include "stride_table.h"
+#include <cstdint>
+#include <stdexcept>
+
+StrideDFATable::StrideDFATable() : StrideDFATable(DFATable())
+{
+}
+
+StrideDFATable::StrideDFATable(const DFATable &table, size_t memoryLimit)
+    : byteTable(table), pairCount(static_cast<size_t>(table.getClassCount()) * table.getClassCount())
+{
+    const size_t stateCount = table.getStateCount();
+    if (estimateMemory(table) > memoryLimit)
+    {
+        throw std::invalid_argument("双字节转换表超出内存上限");
+    }
+    if (stateCount * pairCount > UINT32_MAX)
+    {
+        throw std::invalid_argument("双字节转换表的行起点超出32位");
+    }
+
+    const size_t classCount = table.getClassCount();
+    for (int b = 0; b < 256; b++)
+    {
+        int cls = table.getByteClass(static_cast<unsigned char>(b));
+        firstOffset[b] = static_cast<uint16_t>(cls * classCount);
+        secondClass[b] = static_cast<uint8_t>(cls);
+    }
+    initialRow = static_cast<uint32_t>(table.getInitialState() * pairCount);
+    deadRow = static_cast<uint32_t>(table.getDeadState() * pairCount);
+
+    pairs.resize(stateCount * pairCount);
+    accepts.resize(stateCount * pairCount);
+    for (size_t state = 0; state < stateCount; state++)
+    {
+        for (size_t first = 0; first < classCount; first++)
+        {
+            int middle = table.getNextStateByClass(static_cast<int>(state), static_cast<int>(first));
+            uint8_t midFlag = table.isAccept(middle) ? MID_ACCEPT : 0;
+            size_t entry = state * pairCount + first * classCount;
+            for (size_t second = 0; second < classCount; second++)
+            {
+                int next = table.getNextStateByClass(middle, static_cast<int>(second));
+                pairs[entry + second] = static_cast<uint32_t>(next * pairCount);
+                accepts[entry + second] = midFlag | (table.isAccept(next) ? END_ACCEPT : 0);
+            }
+        }
+    }
+}
+
+size_t StrideDFATable::estimateMemory(const DFATable &table)
+{
+    size_t classCount = table.getClassCount();
+    return table.getStateCount() * classCount * classCount * (sizeof(uint32_t) + sizeof(uint8_t));
+}
+
+bool StrideDFATable::match(const std::string &input) const
+{
+    return match(input.data(), input.size());
+}
+
+bool StrideDFATable::match(const char *data, size_t length) const
+{
+    const uint32_t *table = pairs.data();
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+    uint32_t row = initialRow;
+    size_t i = 0;
+    for (; i + 1 < length; i += 2)
+    {
+        row = table[row + firstOffset[bytes[i]] + secondClass[bytes[i + 1]]];
+        if (row == deadRow)
+        {
+            return false;
+        }
+    }
+    int state = static_cast<int>(row / pairCount);
+    if (i < length)
+    {
+        state = byteTable.getNextState(state, bytes[i]);
+    }
+    return byteTable.isAccept(state);
+}
+
+long long StrideDFATable::longestPrefix(const char *data, size_t length) const
+{
+    const uint32_t *table = pairs.data();
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+    long long last = byteTable.isAccept(byteTable.getInitialState()) ? 0 : -1;
+    uint32_t row = initialRow;
+    size_t i = 0;
+    for (; i + 1 < length; i += 2)
+    {
+        size_t entry = row + firstOffset[bytes[i]] + secondClass[bytes[i + 1]];
+        uint8_t flags = accepts[entry];
+        if (flags & MID_ACCEPT)
+        {
+            last = static_cast<long long>(i) + 1;
+        }
+        if (flags & END_ACCEPT)
+        {
+            last = static_cast<long long>(i) + 2;
+        }
+        row = table[entry];
+        if (row == deadRow)
+        {
+            return last;
+        }
+    }
+    if (i < length && byteTable.isAccept(byteTable.getNextState(static_cast<int>(row / pairCount), bytes[i])))
+    {
+        last = static_cast<long long>(i) + 1;
+    }
+    return last;
+}
+
+const DFATable &StrideDFATable::getByteTable() const
+{
+    return byteTable;
+}
+
+int StrideDFATable::getStateCount() const
+{
+    return byteTable.getStateCount();
+}
+
+size_t StrideDFATable::getPairCount() const
+{
+    return pairCount;
+}
+
+size_t StrideDFATable::memoryUsage() const
+{
+    return pairs.size() * sizeof(uint32_t) + accepts.size() * sizeof(uint8_t) + byteTable.memoryUsage();
+}
@@ -0,0 +1,66 @@
+#ifndef STRIDE_TABLE_H
+#define STRIDE_TABLE_H
+
+#include "dfa_table.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 默认的双字节转换表大小上限（字节）
+const size_t STRIDE_TABLE_LIMIT = 1 << 20;
+
+// 双字节步长DFA转换表
+//
+// 一字节的稠密表每个字节都要做一次依赖上一步结果的查表。这里按(状态, 等价类对)预先
+// 计算两步转换，匹配时每次消耗两个字节，依赖链缩短一半。等价类对的下标为
+// 第一个字节的等价类 × 等价类数 + 第二个字节的等价类，第一个字节的部分预先乘好，
+// 表项直接存放目标状态的行起点，省去乘法。
+//
+// 两步之间经过的接受状态（第一个字节之后接受）单独记录，最长前缀匹配据此不漏掉
+// 奇数长度的匹配；整串匹配时输入为奇数长度，最后一个字节用一字节表完成。
+// 表的大小为 状态数 × 等价类数² 个表项，只适合较小的最小化DFA，超出上限时不构造。
+class StrideDFATable
+{
+public:
+    StrideDFATable();
+    // 由一字节的稠密表构造；表超过memoryLimit字节时抛出std::invalid_argument
+    explicit StrideDFATable(const DFATable &table, size_t memoryLimit = STRIDE_TABLE_LIMIT);
+
+    // 由table构造的双字节表占用的字节数
+    static size_t estimateMemory(const DFATable &table);
+
+    // 判断整个输入是否被接受
+    bool match(const std::string &input) const;
+    bool match(const char *data, size_t length) const;
+    // 被接受的最长前缀的长度，没有时返回-1
+    long long longestPrefix(const char *data, size_t length) const;
+
+    // 用于奇数长度结尾、访问统计和重新编号的一字节表
+    const DFATable &getByteTable() const;
+    int getStateCount() const;
+    // 等价类对的数量，即一字节表等价类数的平方
+    size_t getPairCount() const;
+    // 双字节表与其中一字节表占用的字节数
+    size_t memoryUsage() const;
+
+private:
+    // 表项附带的接受标记
+    enum : uint8_t
+    {
+        MID_ACCEPT = 1, // 第一个字节之后接受
+        END_ACCEPT = 2  // 两个字节之后接受
+    };
+
+    DFATable byteTable;                    // 一字节稠密表
+    size_t pairCount;                      // 等价类对的数量
+    uint32_t initialRow;                   // 初始状态的行起点
+    uint32_t deadRow;                      // 死状态的行起点
+    std::array<uint16_t, 256> firstOffset; // 第一个字节的等价类乘以等价类数
+    std::array<uint8_t, 256> secondClass;  // 第二个字节的等价类
+    std::vector<uint32_t> pairs;           // 两步转换，状态数 × 等价类对数，存放目标行起点
+    std::vector<uint8_t> accepts;          // 每个表项的接受标记
+};
+
+#endif // STRIDE_TABLE_H
@@ -0,0 +1,443 @@
+#include "tdfa.h"
+#include "dfa.h"
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <unordered_map>
+
+namespace
+{
+    // 构造过程中寄存器的取值：未设置、当前位置，或者前驱状态中的某个寄存器（非负）
+    const int UNSET = -1;
+    const int CURRENT = -2;
+
+    // 寄存器不多时在栈上分配
+    const int STACK_REGISTERS = 64;
+
+    // 一组按优先级排列的NFA线程，每个线程有tagCount个寄存器取值
+    struct Threads
+    {
+        std::vector<int> states;
+        std::vector<int> registers;
+    };
+
+    // 求标记NFA的ε闭包，保留优先级顺序
+    class Closure
+    {
+    public:
+        Closure(const TaggedNFA &tagged, int tagCount)
+            : tagCount(tagCount), stamp(0)
+        {
+            const auto &nfa = tagged.nfa;
+            int stateCount = nfa->getAllStates().empty() ? 0 : *nfa->getAllStates().rbegin() + 1;
+            epsilon.resize(stateCount);
+            bytes.resize(stateCount);
+            important.assign(stateCount, 0);
+            accepting.assign(stateCount, 0);
+            visited.assign(stateCount, 0);
+            for (const Edge &edge : nfa->getEdges())
+            {
+                if (edge.epsilon)
+                {
+                    auto it = tagged.tagEdges.find({edge.u, edge.v});
+                    epsilon[edge.u].emplace_back(edge.v, it == tagged.tagEdges.end() ? -1 : it->second);
+                }
+                else
+                {
+                    bytes[edge.u].emplace_back(static_cast<unsigned char>(edge.w), edge.v);
+                    important[edge.u] = 1;
+                }
+            }
+            for (int state : nfa->getAcceptStates())
+            {
+                accepting[state] = 1;
+                important[state] = 1;
+            }
+        }
+
+        // 从seeds出发按优先级做深度优先遍历，先到达某个状态的线程获胜；
+        // 只保留有字节转换或接受的状态
+        void compute(const Threads &seeds, Threads &result)
+        {
+            result.states.clear();
+            result.registers.clear();
+            stamp++;
+            for (size_t seed = 0; seed < seeds.states.size(); seed++)
+            {
+                stackStates.assign(1, seeds.states[seed]);
+                stackRegisters.assign(seeds.registers.begin() + seed * tagCount,
+                                      seeds.registers.begin() + (seed + 1) * tagCount);
+                while (!stackStates.empty())
+                {
+                    int state = stackStates.back();
+                    stackStates.pop_back();
+                    current.assign(stackRegisters.end() - tagCount, stackRegisters.end());
+                    stackRegisters.resize(stackRegisters.size() - tagCount);
+                    if (visited[state] == stamp)
+                        continue;
+                    visited[state] = stamp;
+                    if (important[state])
+                    {
+                        result.states.push_back(state);
+                        result.registers.insert(result.registers.end(), current.begin(), current.end());
+                    }
+                    // 逆序压栈，优先级最高的ε边最先弹出
+                    for (auto it = epsilon[state].rbegin(); it != epsilon[state].rend(); ++it)
+                    {
+                        stackStates.push_back(it->first);
+                        stackRegisters.insert(stackRegisters.end(), current.begin(), current.end());
+                        if (it->second >= 0)
+                        {
+                            stackRegisters[stackRegisters.size() - tagCount + it->second] = CURRENT;
+                        }
+                    }
+                }
+            }
+        }
+
+        std::vector<std::vector<std::pair<int, int>>> epsilon; // ε边的(终点, 标记)，按优先级排列
+        std::vector<std::vector<std::pair<unsigned char, int>>> bytes; // 字节边的(字节, 终点)
+        std::vector<char> important;
+        std::vector<char> accepting;
+
+    private:
+        int tagCount;
+        int stamp;
+        std::vector<int> visited;
+        std::vector<int> stackStates;
+        std::vector<int> stackRegisters;
+        std::vector<int> current;
+    };
+
+    // 把寄存器取值按首次出现的顺序规范编号，values[k]为规范寄存器k的取值
+    void canonicalize(Threads &threads, std::vector<int> &values)
+    {
+        values.clear();
+        std::unordered_map<int, int> numbering;
+        for (int &value : threads.registers)
+        {
+            if (value == UNSET)
+                continue;
+            auto it = numbering.find(value);
+            if (it == numbering.end())
+            {
+                it = numbering.emplace(value, static_cast<int>(values.size())).first;
+                values.push_back(value);
+            }
+            value = it->second;
+        }
+    }
+}
+
+TaggedDFA::TaggedDFA()
+    : groupCount(0), tagCount(0), classCount(1), stateCount(1), initialState(0), deadState(0),
+      registerCount(0), transitions(1, 0), opBegin(2, 0), acceptStates(1, 0)
+{
+    byteClasses.fill(0);
+}
+
+TaggedDFA::TaggedDFA(const std::string &regex, size_t maxStates)
+{
+    NFABuilder builder;
+    TaggedNFA tagged = builder.buildTaggedNFA(regex);
+    groupCount = tagged.groupCount;
+    tagCount = 2 * groupCount;
+    Closure closure(tagged, tagCount);
+
+    // 合并所在边完全相同的字节。有字节没有任何边时等价类0保留给这些字节，
+    // 否则等价类从0开始编号，256个字节各占一类时也不超过256个
+    std::vector<std::vector<std::pair<int, int>>> columns(256);
+    for (const Edge &edge : tagged.nfa->getEdges())
+    {
+        if (!edge.epsilon)
+        {
+            columns[static_cast<unsigned char>(edge.w)].emplace_back(edge.u, edge.v);
+        }
+    }
+    for (auto &column : columns)
+    {
+        std::sort(column.begin(), column.end());
+    }
+    const bool hasDeadBytes = std::any_of(columns.begin(), columns.end(),
+                                          [](const std::vector<std::pair<int, int>> &column)
+                                          { return column.empty(); });
+    std::map<std::vector<std::pair<int, int>>, int> columnToClass;
+    std::vector<unsigned char> representatives;
+    if (hasDeadBytes)
+    {
+        columnToClass[{}] = 0;
+        representatives.push_back(0);
+    }
+    for (int b = 0; b < 256; b++)
+    {
+        const auto &column = columns[b];
+        auto it = columnToClass.find(column);
+        if (it == columnToClass.end())
+        {
+            it = columnToClass.emplace(column, static_cast<int>(representatives.size())).first;
+            representatives.push_back(static_cast<unsigned char>(b));
+        }
+        byteClasses[b] = static_cast<uint8_t>(it->second);
+    }
+    classCount = static_cast<int>(representatives.size());
+    if (classCount > 256)
+    {
+        throw std::runtime_error("字节等价类超过256个");
+    }
+
+    // DFA状态以(线程的NFA状态, 规范寄存器编号)为键
+    std::map<std::pair<std::vector<int>, std::vector<int>>, int> configToState;
+    std::vector<Threads> configs;
+    auto findState = [&](const Threads &threads)
+    {
+        auto key = std::make_pair(threads.states, threads.registers);
+        auto it = configToState.find(key);
+        if (it != configToState.end())
+        {
+            return it->second;
+        }
+        if (maxStates != 0 && configs.size() >= maxStates)
+        {
+            throw DFALimitExceeded("TDFA状态数超过上限 " + std::to_string(maxStates), DFALimitKind::States,
+                                   configs.size(), 0);
+        }
+        int id = static_cast<int>(configs.size());
+        configToState.emplace(std::move(key), id);
+        configs.push_back(threads);
+        return id;
+    };
+
+    int maxRegisters = 0;
+    // 由规范寄存器的取值生成操作：复制在前并排好顺序，置为当前位置的操作在后
+    auto makeOps = [&maxRegisters](const std::vector<int> &values, std::vector<RegisterOp> &result)
+    {
+        maxRegisters = std::max(maxRegisters, static_cast<int>(values.size()));
+        std::vector<RegisterOp> copies;
+        for (int k = 0; k < static_cast<int>(values.size()); k++)
+        {
+            if (values[k] >= 0 && values[k] != k)
+            {
+                copies.push_back({k, values[k]});
+            }
+        }
+        // 并行复制：先执行目标不再被读取的复制；只剩环时把一个目标先存入临时寄存器
+        const int temp = -3; // 构造完成后替换为最后一个寄存器
+        while (!copies.empty())
+        {
+            bool progress = false;
+            for (size_t i = 0; i < copies.size(); i++)
+            {
+                int dst = copies[i].dst;
+                bool read = std::any_of(copies.begin(), copies.end(), [dst](const RegisterOp &op)
+                                        { return op.src == dst; });
+                if (!read)
+                {
+                    result.push_back(copies[i]);
+                    copies.erase(copies.begin() + i);
+                    progress = true;
+                    break;
+                }
+            }
+            if (!progress)
+            {
+                int saved = copies.front().dst;
+                result.push_back({temp, saved});
+                for (auto &op : copies)
+                {
+                    if (op.src == saved)
+                        op.src = temp;
+                }
+            }
+        }
+        for (int k = 0; k < static_cast<int>(values.size()); k++)
+        {
+            if (values[k] == CURRENT)
+            {
+                result.push_back({k, -1});
+            }
+        }
+    };
+
+    Threads seeds, threads;
+    std::vector<int> values;
+    seeds.states.assign(1, tagged.nfa->getInitialState());
+    seeds.registers.assign(tagCount, UNSET);
+    closure.compute(seeds, threads);
+    canonicalize(threads, values);
+    makeOps(values, initialOps);
+    initialState = findState(threads);
+
+    // 逐个处理新状态，转换表中的死状态先记为-1
+    std::vector<int> table;
+    std::vector<std::vector<RegisterOp>> transitionOps;
+    for (size_t current = 0; current < configs.size(); current++)
+    {
+        for (int cls = 0; cls < classCount; cls++)
+        {
+            seeds.states.clear();
+            seeds.registers.clear();
+            // 没有任何边的等价类总是转向死状态
+            if (!(hasDeadBytes && cls == 0))
+            {
+                const Threads &config = configs[current];
+                unsigned char byte = representatives[cls];
+                for (size_t t = 0; t < config.states.size(); t++)
+                {
+                    for (const auto &edge : closure.bytes[config.states[t]])
+                    {
+                        if (edge.first == byte)
+                        {
+                            seeds.states.push_back(edge.second);
+                            seeds.registers.insert(seeds.registers.end(), config.registers.begin() + t * tagCount,
+                                                   config.registers.begin() + (t + 1) * tagCount);
+                        }
+                    }
+                }
+            }
+            std::vector<RegisterOp> opsHere;
+            int next = -1;
+            if (!seeds.states.empty())
+            {
+                closure.compute(seeds, threads);
+                if (!threads.states.empty())
+                {
+                    canonicalize(threads, values);
+                    makeOps(values, opsHere);
+                    next = findState(threads);
+                }
+            }
+            table.push_back(next);
+            transitionOps.push_back(std::move(opsHere));
+        }
+    }
+
+    // 展平转换表与操作，临时寄存器放在最后
+    deadState = static_cast<int>(configs.size());
+    stateCount = deadState + 1;
+    registerCount = maxRegisters + 1;
+    transitions.assign(static_cast<size_t>(stateCount) * classCount, deadState);
+    opBegin.assign(transitions.size() + 1, 0);
+    auto fixTemp = [this](RegisterOp op)
+    {
+        if (op.dst == -3)
+            op.dst = registerCount - 1;
+        if (op.src == -3)
+            op.src = registerCount - 1;
+        return op;
+    };
+    for (size_t i = 0; i < table.size(); i++)
+    {
+        transitions[i] = table[i] < 0 ? deadState : table[i];
+        opBegin[i] = static_cast<uint32_t>(ops.size());
+        for (const RegisterOp &op : transitionOps[i])
+        {
+            ops.push_back(fixTemp(op));
+        }
+    }
+    for (size_t i = table.size(); i < opBegin.size(); i++)
+    {
+        opBegin[i] = static_cast<uint32_t>(ops.size());
+    }
+
+    // 接受状态取优先级最高的接受线程的寄存器
+    acceptStates.assign(stateCount, 0);
+    finalRegisters.assign(static_cast<size_t>(stateCount) * tagCount, -1);
+    for (int s = 0; s < deadState; s++)
+    {
+        const Threads &config = configs[s];
+        for (size_t t = 0; t < config.states.size(); t++)
+        {
+            if (closure.accepting[config.states[t]])
+            {
+                acceptStates[s] = 1;
+                std::copy(config.registers.begin() + t * tagCount, config.registers.begin() + (t + 1) * tagCount,
+                          finalRegisters.begin() + static_cast<size_t>(s) * tagCount);
+                break;
+            }
+        }
+    }
+}
+
+void TaggedDFA::applyOps(uint32_t begin, uint32_t end, std::ptrdiff_t position, std::ptrdiff_t *registers) const
+{
+    for (uint32_t i = begin; i < end; i++)
+    {
+        const RegisterOp &op = ops[i];
+        registers[op.dst] = op.src < 0 ? position : registers[op.src];
+    }
+}
+
+bool TaggedDFA::match(const std::string &input, std::vector<GroupSpan> &groups) const
+{
+    return match(input.data(), input.size(), groups);
+}
+
+bool TaggedDFA::match(const char *data, size_t length, std::vector<GroupSpan> &groups) const
+{
+    groups.assign(groupCount + 1, GroupSpan(-1, -1));
+
+    std::ptrdiff_t stackRegisters[STACK_REGISTERS];
+    std::vector<std::ptrdiff_t> heapRegisters;
+    std::ptrdiff_t *registers = stackRegisters;
+    if (registerCount > STACK_REGISTERS)
+    {
+        heapRegisters.resize(registerCount);
+        registers = heapRegisters.data();
+    }
+    for (const RegisterOp &op : initialOps)
+    {
+        registers[op.dst] = op.src < 0 ? 0 : registers[op.src];
+    }
+
+    const int *table = transitions.data();
+    const uint32_t *begins = opBegin.data();
+    int state = initialState;
+    for (size_t i = 0; i < length; i++)
+    {
+        size_t index = static_cast<size_t>(state) * classCount + byteClasses[static_cast<unsigned char>(data[i])];
+        state = table[index];
+        if (state == deadState)
+        {
+            return false;
+        }
+        if (begins[index] != begins[index + 1])
+        {
+            applyOps(begins[index], begins[index + 1], static_cast<std::ptrdiff_t>(i + 1), registers);
+        }
+    }
+    if (!acceptStates[state])
+    {
+        return false;
+    }
+
+    groups[0] = GroupSpan(0, static_cast<std::ptrdiff_t>(length));
+    const int *finals = &finalRegisters[static_cast<size_t>(state) * tagCount];
+    for (int g = 0; g < groupCount; g++)
+    {
+        if (finals[2 * g] >= 0 && finals[2 * g + 1] >= 0)
+        {
+            groups[g + 1] = GroupSpan(registers[finals[2 * g]], registers[finals[2 * g + 1]]);
+        }
+    }
+    return true;
+}
+
+int TaggedDFA::getGroupCount() const
+{
+    return groupCount;
+}
+
+int TaggedDFA::getStateCount() const
+{
+    return stateCount;
+}
+
+int TaggedDFA::getRegisterCount() const
+{
+    return registerCount;
+}
+
+size_t TaggedDFA::getOperationCount() const
+{
+    return ops.size();
+}
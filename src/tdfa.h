@@ -0,0 +1,73 @@
+#ifndef TDFA_H
+#define TDFA_H
+
+#include "nfa.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 捕获组的[开始, 结束)字节偏移，未参与匹配的组为(-1, -1)
+typedef std::pair<std::ptrdiff_t, std::ptrdiff_t> GroupSpan;
+
+// 带标记的DFA（Laurikari风格的TDFA），整串匹配并提取捕获组
+//
+// buildTaggedNFA把每个括号组的开始和结束记为ε边上的标记。子集构造时DFA状态是
+// 按优先级排列的NFA线程列表，每个线程为每个标记记录一个寄存器；经过标记边时寄存器
+// 取当前位置，否则沿用前驱线程的寄存器。寄存器按出现顺序规范编号后，线程列表相同
+// 的配置合并为同一个DFA状态，转换上附带寄存器操作（置为当前位置或从另一个寄存器复制），
+// 并行复制在构造时排好顺序。匹配时每个字节仍只查一次转换表，再执行该转换的寄存器操作
+// （多数转换没有操作）。
+//
+// 语义为最左优先：选择项先左后右，* + ? 贪婪，与std::regex的ECMAScript语法的结果一致；
+// 重复中的组取最后一次迭代的值，某次迭代未经过的内层组保留之前的值（与Perl相同，
+// ECMAScript会将其清空）。
+class TaggedDFA
+{
+public:
+    TaggedDFA();
+    // maxStates为0时不限制状态数，否则超出时抛出DFALimitExceeded
+    explicit TaggedDFA(const std::string &regex, size_t maxStates = 10000);
+
+    // 判断整个输入是否被接受，接受时groups[0]为整个输入，groups[k]为第k个捕获组
+    bool match(const std::string &input, std::vector<GroupSpan> &groups) const;
+    bool match(const char *data, size_t length, std::vector<GroupSpan> &groups) const;
+
+    // 捕获组数（不含组0）
+    int getGroupCount() const;
+    // 状态数（包含死状态）
+    int getStateCount() const;
+    // 寄存器数
+    int getRegisterCount() const;
+    // 全部转换上的寄存器操作总数
+    size_t getOperationCount() const;
+
+private:
+    // 寄存器操作：src为-1时把dst置为当前位置，否则dst = src
+    struct RegisterOp
+    {
+        int dst;
+        int src;
+    };
+
+    void applyOps(uint32_t begin, uint32_t end, std::ptrdiff_t position, std::ptrdiff_t *registers) const;
+
+    int groupCount;                         // 捕获组数
+    int tagCount;                           // 标记数，为捕获组数的两倍
+    int classCount;                         // 字节等价类数
+    int stateCount;                         // 状态数（包含死状态）
+    int initialState;                       // 初始状态
+    int deadState;                          // 死状态，放在最后
+    int registerCount;                      // 寄存器数（含并行复制用的临时寄存器）
+    std::array<uint8_t, 256> byteClasses;   // 字节到等价类的映射
+    std::vector<int> transitions;           // 转换表，状态数 × 等价类数
+    std::vector<uint32_t> opBegin;          // 每个转换的操作在ops中的起点，多一项作为终点
+    std::vector<RegisterOp> ops;            // 全部转换的寄存器操作
+    std::vector<RegisterOp> initialOps;     // 匹配开始时在位置0执行的操作
+    std::vector<char> acceptStates;         // 接受状态标记
+    std::vector<int> finalRegisters;        // 接受状态下每个标记所在的寄存器，-1表示未设置
+};
+
+#endif // TDFA_H
@@ -0,0 +1,177 @@
+#include "utf8.h"
+#include <stack>
+
+bool decodeUtf8(const std::string &text, size_t &pos, uint32_t &codePoint)
+{
+    if (pos >= text.size())
+    {
+        return false;
+    }
+    unsigned char lead = static_cast<unsigned char>(text[pos]);
+    size_t length;
+    uint32_t value;
+    uint32_t minimum;
+    if (lead < 0x80)
+    {
+        codePoint = lead;
+        pos++;
+        return true;
+    }
+    else if ((lead & 0xE0) == 0xC0)
+    {
+        length = 2;
+        value = lead & 0x1F;
+        minimum = 0x80;
+    }
+    else if ((lead & 0xF0) == 0xE0)
+    {
+        length = 3;
+        value = lead & 0x0F;
+        minimum = 0x800;
+    }
+    else if ((lead & 0xF8) == 0xF0)
+    {
+        length = 4;
+        value = lead & 0x07;
+        minimum = 0x10000;
+    }
+    else
+    {
+        return false;
+    }
+
+    if (pos + length > text.size())
+    {
+        return false;
+    }
+    for (size_t i = 1; i < length; i++)
+    {
+        unsigned char c = static_cast<unsigned char>(text[pos + i]);
+        if ((c & 0xC0) != 0x80)
+        {
+            return false;
+        }
+        value = (value << 6) | (c & 0x3F);
+    }
+    // 拒绝过长编码、代理区和超出范围的码点
+    if (value < minimum || value > MAX_CODE_POINT || (value >= 0xD800 && value <= 0xDFFF))
+    {
+        return false;
+    }
+    codePoint = value;
+    pos += length;
+    return true;
+}
+
+std::string encodeUtf8(uint32_t codePoint)
+{
+    std::string result;
+    if (codePoint < 0x80)
+    {
+        result.push_back(static_cast<char>(codePoint));
+    }
+    else if (codePoint < 0x800)
+    {
+        result.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+        result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else if (codePoint < 0x10000)
+    {
+        result.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+        result.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else
+    {
+        result.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+        result.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        result.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    return result;
+}
+
+std::vector<Utf8Sequence> utf8Sequences(uint32_t first, uint32_t last)
+{
+    std::vector<Utf8Sequence> sequences;
+    std::stack<std::pair<uint32_t, uint32_t>> pending;
+    if (last > MAX_CODE_POINT)
+    {
+        last = MAX_CODE_POINT;
+    }
+    pending.push({first, last});
+
+    while (!pending.empty())
+    {
+        uint32_t start = pending.top().first;
+        uint32_t end = pending.top().second;
+        pending.pop();
+        if (start > end)
+            continue;
+
+        // 去掉代理区
+        if (start <= 0xDFFF && end >= 0xD800)
+        {
+            pending.push({0xE000, end});
+            if (start < 0xD800)
+            {
+                pending.push({start, 0xD7FF});
+            }
+            continue;
+        }
+
+        // 按编码长度的分界拆分，使范围内所有码点编码长度相同
+        bool split = false;
+        for (uint32_t boundary : {0x7Fu, 0x7FFu, 0xFFFFu})
+        {
+            if (start <= boundary && end > boundary)
+            {
+                pending.push({boundary + 1, end});
+                pending.push({start, boundary});
+                split = true;
+                break;
+            }
+        }
+        if (split)
+            continue;
+
+        if (end <= 0x7F)
+        {
+            sequences.push_back({ByteRange(static_cast<unsigned char>(start), static_cast<unsigned char>(end))});
+            continue;
+        }
+
+        // 按续字节对齐拆分，使每个字节位置上的取值构成连续区间且彼此独立
+        for (int i = 1; i < 4 && !split; i++)
+        {
+            uint32_t mask = (1u << (6 * i)) - 1;
+            if ((start & ~mask) != (end & ~mask))
+            {
+                if ((start & mask) != 0)
+                {
+                    pending.push({(start | mask) + 1, end});
+                    pending.push({start, start | mask});
+                    split = true;
+                }
+                else if ((end & mask) != mask)
+                {
+                    pending.push({end & ~mask, end});
+                    pending.push({start, (end & ~mask) - 1});
+                    split = true;
+                }
+            }
+        }
+        if (split)
+            continue;
+
+        std::string low = encodeUtf8(start);
+        std::string high = encodeUtf8(end);
+        Utf8Sequence sequence;
+        for (size_t i = 0; i < low.size(); i++)
+        {
+            sequence.push_back(ByteRange(static_cast<unsigned char>(low[i]), static_cast<unsigned char>(high[i])));
+        }
+        sequences.push_back(sequence);
+    }
+    return sequences;
+}
@@ -0,0 +1,25 @@
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// UTF-8编码工具
+
+const uint32_t MAX_CODE_POINT = 0x10FFFF;
+
+// 字节范围 [first, second]
+typedef std::pair<unsigned char, unsigned char> ByteRange;
+// 一个字节范围序列匹配一组等长的UTF-8编码
+typedef std::vector<ByteRange> Utf8Sequence;
+
+// 从pos处解码一个码点，成功时移动pos；遇到非法编码返回false且不移动pos
+bool decodeUtf8(const std::string &text, size_t &pos, uint32_t &codePoint);
+// 将码点编码为UTF-8
+std::string encodeUtf8(uint32_t codePoint);
+// 将码点范围 [first, last] 拆分为字节范围序列，代理区(D800-DFFF)被排除
+std::vector<Utf8Sequence> utf8Sequences(uint32_t first, uint32_t last);
+
+#endif // UTF8_H
@@ -1,142 +1,250 @@
 #include <iostream>
 #include <string>
 #include <memory>
+#include <cstdlib>
+#include <fstream>
 #include <sstream>
-#include <iomanip>
-#include <set>
+#include <vector>
+#include "alloc_stats.h"
 #include "graph.h"
+#include "lexer.h"
 #include "nfa.h"
 #include "dfa.h"
+#include "output.h"
+#include "server.h"
 
-// 辅助函数：从正则表达式中提取字母表
-std::set<char> extract_alphabet_from_regexp(const std::string &regexp)
+// 服务器模式：regexp_to_dfa --server [--socket PATH] [--threads N] [--cache N] [--deadline MS] [--max-states N]
+// 不指定--socket时在标准输入输出上服务
+int run_server(int argc, char *argv[])
 {
-    std::set<char> alphabet;
-    for (char c : regexp)
+    ServerOptions options;
+    std::string socket_path;
+    for (int i = 2; i < argc; i++)
     {
-        if (isalnum(c) && c != '$' && c != '*' && c != '(' && c != ')')
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
         {
-            alphabet.insert(c);
+            std::cerr << "Error: 选项 " << arg << " 缺少参数" << std::endl;
+            return 1;
         }
+        std::string value = argv[++i];
+        if (arg == "--socket")
+        {
+            socket_path = value;
+            continue;
+        }
+        char *end = nullptr;
+        unsigned long long number = std::strtoull(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0')
+        {
+            std::cerr << "Error: 选项 " << arg << " 需要整数参数" << std::endl;
+            return 1;
+        }
+        if (arg == "--threads")
+            options.threads = static_cast<size_t>(number);
+        else if (arg == "--cache")
+            options.cacheSize = static_cast<size_t>(number);
+        else if (arg == "--deadline")
+            options.deadlineMs = static_cast<unsigned>(number);
+        else if (arg == "--max-states")
+            options.maxStates = static_cast<size_t>(number);
+        else
+        {
+            std::cerr << "Error: 未知的选项 " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    if (!socket_path.empty())
+    {
+        return run_socket_server(socket_path, options);
     }
-    return alphabet;
+    CompileServer server(options);
+    server.serve(std::cin, std::cout);
+    return 0;
 }
 
-// 辅助函数：获取完整的字母表
-std::set<char> get_full_alphabet(const std::shared_ptr<Graph> &graph, const std::string &regexp, bool include_epsilon = false)
+// 把记号文本中的控制字符转义后输出，其余字节原样输出
+void print_token_text(std::ostream &out, const char *data, size_t length)
 {
-    // 从正则表达式中获取字母表
-    auto alphabet = extract_alphabet_from_regexp(regexp);
-
-    // 从图中获取字母表
-    for (char c : graph->getAlphabet())
+    static const char hex[] = "0123456789abcdef";
+    for (size_t i = 0; i < length; i++)
     {
-        if (include_epsilon || c != '$')
-        {
-            alphabet.insert(c);
-        }
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if (c == '\\')
+            out << "\\\\";
+        else if (c == '\n')
+            out << "\\n";
+        else if (c == '\t')
+            out << "\\t";
+        else if (c == '\r')
+            out << "\\r";
+        else if (c < 0x20 || c == 0x7f)
+            out << "\\x" << hex[c >> 4] << hex[c & 0xf];
+        else
+            out << data[i];
     }
-    return alphabet;
 }
 
-// 辅助函数：打印状态转换表
-void print_transition_table(const std::shared_ptr<Graph> &graph, const std::string &title, const std::string &regexp, bool is_nfa = false)
+// 词法分析模式：regexp_to_dfa --lex <规则文件> <输入文件>
+// 规则文件每行一条规则，靠前的优先；每个记号输出一行：规则号、偏移、长度、文本，以制表符分隔
+int run_lexer(const std::string &rules_path, const std::string &input_path)
 {
-    std::cout << title << ":\n";
-
-    // 获取所有状态和完整的字母表
-    auto states = graph->getAllStates();
-    auto alphabet = get_full_alphabet(graph, regexp, is_nfa);
-
-    // 计算每列的宽度
-    size_t state_width = 6; // "State" 的长度
-    for (int state : states)
+    std::ifstream rules_file(rules_path);
+    if (!rules_file)
     {
-        state_width = std::max(state_width, std::to_string(state).length());
+        std::cerr << "Error: 无法打开规则文件 " << rules_path << std::endl;
+        return 1;
     }
-    state_width += 2; // 添加一些padding
-
-    // 打印表头
-    std::cout << std::setw(state_width) << "State";
-    for (char c : alphabet)
+    std::vector<std::string> rules;
+    std::string line;
+    while (std::getline(rules_file, line))
     {
-        if (c == '$')
+        if (!line.empty() && line.back() == '\r')
         {
-            std::cout << std::setw(8) << "ε"; // 使用ε符号代替$
+            line.pop_back();
         }
-        else
+        if (!line.empty())
         {
-            std::cout << std::setw(8) << c;
+            rules.push_back(line);
         }
     }
-    std::cout << "  Accept?\n";
 
-    // 打印分隔线
-    for (size_t i = 0; i < state_width + alphabet.size() * 8 + 8; ++i)
+    std::ifstream input_file(input_path, std::ios::binary);
+    if (!input_file)
     {
-        std::cout << "-";
+        std::cerr << "Error: 无法打开输入文件 " << input_path << std::endl;
+        return 1;
     }
-    std::cout << "\n";
+    std::ostringstream buffer;
+    buffer << input_file.rdbuf();
+    std::string input = buffer.str();
 
-    // 打印每个状态的转换
-    for (int state : states)
+    try
     {
-        // 打印状态号
-        std::cout << std::setw(state_width) << state;
+        Lexer lexer(rules);
 
-        // 打印每个输入符号的转换
-        for (char c : alphabet)
+        // 记号数组只分配一次，分批切分
+        const size_t batch = 4096;
+        std::vector<LexToken> tokens(batch);
+        size_t position = 0;
+        while (position < input.size())
         {
-            auto next_states = graph->getNextStates(state, c);
-            std::stringstream ss;
-            bool first = true;
-            for (int next : next_states)
+            size_t consumed;
+            size_t count = lexer.tokenize(input.data() + position, input.size() - position, tokens.data(), batch, consumed);
+            for (size_t i = 0; i < count; i++)
             {
-                if (!first)
-                    ss << ",";
-                ss << next;
-                first = false;
+                const LexToken &token = tokens[i];
+                std::cout << token.rule << '\t' << position + token.offset << '\t' << token.length << '\t';
+                print_token_text(std::cout, input.data() + position + token.offset, token.length);
+                std::cout << '\n';
+            }
+            position += consumed;
+            if (count < batch && position < input.size())
+            {
+                std::cout.flush();
+                std::cerr << "Error: 偏移 " << position << " 处没有规则能够匹配" << std::endl;
+                return 1;
             }
-            std::cout << std::setw(8) << (ss.str().empty() ? "-" : ss.str());
-        }
-
-        // 打印是否为接受状态和初始状态
-        std::cout << "  " << (graph->getAcceptStates().count(state) > 0 ? "Yes" : "No");
-        if (state == graph->getInitialState())
-        {
-            std::cout << " (Initial)";
         }
-        std::cout << "\n";
+        return 0;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
     }
-    std::cout << "\n";
 }
 
-int main(int argc, char *argv[])
+// 转换模式：regexp_to_dfa [--format table|json|csv|dot] [--no-nfa] [--no-dfa] [--no-min-dfa] [--memory] <regexp>
+// 不需要的自动机不输出，后面的自动机都不需要时也不构造；
+// --memory在输出之后向标准错误输出各阶段与数据结构的内存分配统计
+int run_convert(int argc, char *argv[])
 {
-    if (argc != 2)
+    OutputFormat format = OutputFormat::Table;
+    unsigned sections = OUTPUT_ALL;
+    bool memory_report = false;
+    std::string regexp;
+    bool has_regexp = false;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--format" && i + 1 < argc)
+        {
+            if (!parse_output_format(argv[++i], format))
+            {
+                std::cerr << "Error: 未知的输出格式 " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--no-nfa")
+            sections &= ~OUTPUT_NFA;
+        else if (arg == "--no-dfa")
+            sections &= ~OUTPUT_DFA;
+        else if (arg == "--no-min-dfa")
+            sections &= ~OUTPUT_MIN_DFA;
+        else if (arg == "--memory")
+            memory_report = true;
+        else if (arg == "--" && i + 2 == argc)
+        {
+            regexp = argv[++i];
+            has_regexp = true;
+        }
+        else if (arg.compare(0, 2, "--") == 0 || has_regexp)
+        {
+            std::cerr << "Error: 无法识别的参数 " << arg << std::endl;
+            return 1;
+        }
+        else
+        {
+            regexp = arg;
+            has_regexp = true;
+        }
+    }
+    if (!has_regexp)
     {
-        std::cerr << "Usage: " << argv[0] << " <regexp>" << std::endl;
+        std::cerr << "Error: 缺少正则表达式" << std::endl;
+        return 1;
+    }
+    if (memory_report && !allocStatsEnabled())
+    {
+        std::cerr << "Error: 分配统计未启用，需要以 -DREGEXP_ALLOC_STATS=ON 构建" << std::endl;
         return 1;
     }
-
-    std::string regexp = argv[1];
 
     try
     {
         // 构建NFA
         NFABuilder nfa_builder;
         auto nfa = nfa_builder.buildNFA(regexp);
-        print_transition_table(nfa, "NFA状态转换表", regexp, true); // true表示这是NFA
 
         // 转换为DFA
         DFABuilder dfa_builder;
-        auto dfa = dfa_builder.buildDFA(nfa);
-        print_transition_table(dfa, "DFA状态转换表", regexp);
+        std::shared_ptr<Graph> dfa, min_dfa;
+        if (sections & (OUTPUT_DFA | OUTPUT_MIN_DFA))
+        {
+            dfa = dfa_builder.buildDFA(nfa);
+        }
 
-        // 最小化DFA
-        auto min_dfa = dfa_builder.minimizeDFA(dfa);
-        print_transition_table(min_dfa, "最小化DFA状态转换表", regexp);
+        // 最小化DFA；字典树的顺序细化需要数秒以上，改用并行签名细化
+        if (sections & OUTPUT_MIN_DFA)
+        {
+            if (nfa_builder.builtKeywordTrie())
+            {
+                dfa_builder.setMinimizeMode(MinimizeMode::Parallel);
+            }
+            min_dfa = dfa_builder.minimizeDFA(dfa);
+        }
 
+        {
+            REGEXP_ALLOC_PHASE("output");
+            print_automata(std::cout, regexp, nfa, dfa, min_dfa, format, sections);
+        }
+        if (memory_report)
+        {
+            std::cout.flush();
+            writeAllocReport(std::cerr);
+        }
         return 0;
     }
     catch (const std::exception &e)
@@ -144,4 +252,24 @@ int main(int argc, char *argv[])
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
     }
-}
\ No newline at end of file
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc >= 2 && std::string(argv[1]) == "--server")
+    {
+        return run_server(argc, argv);
+    }
+    if (argc == 4 && std::string(argv[1]) == "--lex")
+    {
+        return run_lexer(argv[2], argv[3]);
+    }
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " [--format table|json|csv|dot] [--no-nfa] [--no-dfa] [--no-min-dfa] [--memory] <regexp>" << std::endl;
+        std::cerr << "       " << argv[0] << " --server [--socket PATH] [--threads N] [--cache N] [--deadline MS] [--max-states N]" << std::endl;
+        std::cerr << "       " << argv[0] << " --lex <rules-file> <input-file>" << std::endl;
+        return 1;
+    }
+    return run_convert(argc, argv);
+}
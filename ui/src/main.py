@@ -1,11 +1,11 @@
 import sys
 import os
-import subprocess
 import warnings
 from PyQt5.QtWidgets import (QApplication, QMainWindow, QWidget, QVBoxLayout,
                            QHBoxLayout, QLabel, QTextEdit, QPushButton,
                            QMessageBox, QFileDialog, QTabWidget)
 from PyQt5.QtCore import Qt
+from regexp_core import RegexpError, create_converter
 
 # 过滤掉 PyQt5 的弃用警告
 warnings.filterwarnings("ignore", category=DeprecationWarning)
@@ -14,6 +14,8 @@ class RegexpToDFAWindow(QMainWindow):
     def __init__(self):
         super().__init__()
         self.current_file = None
+        # 优先在进程内调用regexp动态库，找不到时退回到逐行启动regexp_to_dfa
+        self.converter = create_converter()
         self.initUI()
         
     def initUI(self):
@@ -156,45 +158,24 @@ class RegexpToDFAWindow(QMainWindow):
             if not reg:
                 continue
                 
+            # 为每个部分添加正则表达式标识
+            header = f'正则表达式 {i}: {reg}\n'
             try:
-                # 调用C++程序进行转换
-                result = subprocess.run(
-                    ['regexp_to_dfa.exe', reg],
-                    capture_output=True,
-                    text=True,
-                    encoding='utf-8'
-                )
-                
-                if result.returncode == 0:
-                    # 解析输出，分离三种转换表
-                    output = result.stdout
-                    parts = output.split('\n\n')
-                    
-                    # 为每个部分添加正则表达式标识
-                    header = f'正则表达式 {i}: {reg}\n'
-                    
-                    # NFA部分
-                    nfa_part = next((p for p in parts if 'NFA状态转换表' in p), '')
-                    if nfa_part:
-                        nfa_results.append(header + nfa_part + '\n')
-                    
-                    # DFA部分
-                    dfa_part = next((p for p in parts if 'DFA状态转换表' in p and '最小化' not in p), '')
-                    if dfa_part:
-                        dfa_results.append(header + dfa_part + '\n')
-                    
-                    # 最小化DFA部分
-                    min_dfa_part = next((p for p in parts if '最小化DFA状态转换表' in p), '')
-                    if min_dfa_part:
-                        min_dfa_results.append(header + min_dfa_part + '\n')
-                else:
-                    error_msg = f'正则表达式 {i}: {reg}\n错误：{result.stderr}\n'
-                    nfa_results.append(error_msg)
-                    dfa_results.append(error_msg)
-                    min_dfa_results.append(error_msg)
+                nfa_part, dfa_part, min_dfa_part = self.converter.convert(reg)
+                if nfa_part:
+                    nfa_results.append(header + nfa_part + '\n')
+                if dfa_part:
+                    dfa_results.append(header + dfa_part + '\n')
+                if min_dfa_part:
+                    min_dfa_results.append(header + min_dfa_part + '\n')
                     
+            except RegexpError as e:
+                error_msg = f'{header}错误：{str(e)}\n'
+                nfa_results.append(error_msg)
+                dfa_results.append(error_msg)
+                min_dfa_results.append(error_msg)
             except Exception as e:
-                error_msg = f'正则表达式 {i}: {reg}\n程序执行错误：{str(e)}\n'
+                error_msg = f'{header}程序执行错误：{str(e)}\n'
                 nfa_results.append(error_msg)
                 dfa_results.append(error_msg)
                 min_dfa_results.append(error_msg)
@@ -0,0 +1,503 @@
+#include "output.h"
+#include <algorithm>
+#include <cctype>
+#include <tuple>
+#include <vector>
+
+// 表头中ε列按'$'排序，紧跟在字节'$'之后
+#define EPSILON_CHAR '$'
+
+// JSON与CSV中ε转换的符号值
+const int EPSILON_SYMBOL = -1;
+
+bool parse_output_format(const std::string &name, OutputFormat &format)
+{
+    if (name == "table")
+        format = OutputFormat::Table;
+    else if (name == "json")
+        format = OutputFormat::Json;
+    else if (name == "csv")
+        format = OutputFormat::Csv;
+    else if (name == "dot")
+        format = OutputFormat::Dot;
+    else
+        return false;
+    return true;
+}
+
+BufferedWriter::BufferedWriter(std::ostream &out, size_t capacity) : out(out), capacity(capacity)
+{
+    buffer.reserve(capacity);
+}
+
+BufferedWriter::~BufferedWriter()
+{
+    flush();
+}
+
+void BufferedWriter::put(char c)
+{
+    if (buffer.size() >= capacity)
+    {
+        flush();
+    }
+    buffer.push_back(c);
+}
+
+void BufferedWriter::put(const char *data, size_t length)
+{
+    if (buffer.size() + length > capacity)
+    {
+        flush();
+    }
+    buffer.append(data, length);
+}
+
+void BufferedWriter::put(const std::string &text)
+{
+    put(text.data(), text.size());
+}
+
+void BufferedWriter::putInt(long long value)
+{
+    char digits[24];
+    size_t length = 0;
+    unsigned long long magnitude = value < 0 ? 0ULL - static_cast<unsigned long long>(value)
+                                             : static_cast<unsigned long long>(value);
+    do
+    {
+        digits[sizeof(digits) - ++length] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0)
+    {
+        digits[sizeof(digits) - ++length] = '-';
+    }
+    put(digits + sizeof(digits) - length, length);
+}
+
+void BufferedWriter::putPadded(const std::string &text, size_t width)
+{
+    for (size_t i = text.size(); i < width; i++)
+    {
+        put(' ');
+    }
+    put(text);
+}
+
+void BufferedWriter::flush()
+{
+    if (!buffer.empty())
+    {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+}
+
+// 辅助函数：从正则表达式中提取字母表
+std::set<char> extract_alphabet_from_regexp(const std::string &regexp)
+{
+    std::set<char> alphabet;
+    for (char c : regexp)
+    {
+        if (isalnum(static_cast<unsigned char>(c)) && c != '$' && c != '*' && c != '(' && c != ')')
+        {
+            alphabet.insert(c);
+        }
+    }
+    return alphabet;
+}
+
+// 辅助函数：获取完整的字母表
+std::set<char> get_full_alphabet(const std::shared_ptr<Graph> &graph, const std::string &regexp)
+{
+    // 从正则表达式中获取字母表
+    auto alphabet = extract_alphabet_from_regexp(regexp);
+
+    // 从图中获取字母表
+    for (char c : graph->getAlphabet())
+    {
+        alphabet.insert(c);
+    }
+    return alphabet;
+}
+
+namespace
+{
+    // 表头中的一列：(字节, 是否为ε)，ε列的字节固定为EPSILON_CHAR
+    typedef std::pair<char, bool> TableSymbol;
+
+    // 表头中符号的显示：ε转换显示为ε，不可打印字节（如UTF-8编码中的字节）以十六进制显示
+    std::string symbol_label(char c, bool epsilon = false)
+    {
+        static const char hex[] = "0123456789ABCDEF";
+        unsigned char byte = static_cast<unsigned char>(c);
+        if (epsilon)
+        {
+            return "ε";
+        }
+        if (!isprint(byte))
+        {
+            return std::string("\\x") + hex[byte >> 4] + hex[byte & 0xf];
+        }
+        return std::string(1, c);
+    }
+
+    // JSON与CSV中的符号值
+    int symbol_code(const Edge &edge)
+    {
+        return edge.epsilon ? EPSILON_SYMBOL : static_cast<unsigned char>(edge.w);
+    }
+
+    void write_table(BufferedWriter &writer, const std::shared_ptr<Graph> &graph, const std::string &title,
+                     const std::string &regexp, bool is_nfa)
+    {
+        writer.put(title);
+        writer.put(":\n");
+
+        // 获取所有状态和完整的字母表
+        auto states = graph->getAllStates();
+        std::set<TableSymbol> symbol_set;
+        for (char c : get_full_alphabet(graph, regexp))
+        {
+            symbol_set.insert({c, false});
+        }
+        if (is_nfa)
+        {
+            for (const Edge &edge : graph->getEdges())
+            {
+                if (edge.epsilon)
+                {
+                    symbol_set.insert({EPSILON_CHAR, true});
+                    break;
+                }
+            }
+        }
+        std::vector<TableSymbol> alphabet(symbol_set.begin(), symbol_set.end());
+        // 下标256为ε列
+        int symbol_index[257];
+        std::fill(symbol_index, symbol_index + 257, -1);
+        for (size_t i = 0; i < alphabet.size(); i++)
+        {
+            int slot = alphabet[i].second ? 256 : static_cast<unsigned char>(alphabet[i].first);
+            symbol_index[slot] = static_cast<int>(i);
+        }
+
+        // 计算状态列的宽度
+        size_t state_width = 6; // "State" 的长度
+        if (!states.empty())
+        {
+            state_width = std::max({state_width, std::to_string(*states.begin()).length(),
+                                    std::to_string(*states.rbegin()).length()});
+        }
+        state_width += 2; // 添加一些padding
+
+        // 打印表头和分隔线
+        writer.putPadded("State", state_width);
+        for (const TableSymbol &symbol : alphabet)
+        {
+            writer.putPadded(symbol_label(symbol.first, symbol.second), 8);
+        }
+        writer.put("  Accept?\n");
+        writer.put(std::string(state_width + alphabet.size() * 8 + 8, '-'));
+        writer.put('\n');
+
+        // 一次遍历所有边，按(起点, 符号, 终点)排序后逐行输出，不再为每个单元格查询转换
+        std::vector<std::tuple<int, int, int>> transitions;
+        transitions.reserve(graph->getEdges().size());
+        for (const Edge &edge : graph->getEdges())
+        {
+            int symbol = symbol_index[edge.epsilon ? 256 : static_cast<unsigned char>(edge.w)];
+            if (symbol >= 0)
+            {
+                transitions.emplace_back(edge.u, symbol, edge.v);
+            }
+        }
+        std::sort(transitions.begin(), transitions.end());
+
+        const std::set<int> &accept_states = graph->getAcceptStates();
+        size_t next = 0;
+        std::string cell;
+        for (int state : states)
+        {
+            writer.putPadded(std::to_string(state), state_width);
+            while (next < transitions.size() && std::get<0>(transitions[next]) < state)
+            {
+                next++;
+            }
+            for (int symbol = 0; symbol < static_cast<int>(alphabet.size()); symbol++)
+            {
+                cell.clear();
+                int last = 0;
+                for (; next < transitions.size() && std::get<0>(transitions[next]) == state &&
+                       std::get<1>(transitions[next]) == symbol;
+                     next++)
+                {
+                    int target = std::get<2>(transitions[next]);
+                    if (!cell.empty() && target == last)
+                    {
+                        continue; // 重复的边
+                    }
+                    if (!cell.empty())
+                    {
+                        cell += ',';
+                    }
+                    cell += std::to_string(target);
+                    last = target;
+                }
+                writer.putPadded(cell.empty() ? "-" : cell, 8);
+            }
+
+            // 打印是否为接受状态和初始状态
+            writer.put(accept_states.count(state) ? "  Yes" : "  No");
+            if (state == graph->getInitialState())
+            {
+                writer.put(" (Initial)");
+            }
+            writer.put('\n');
+        }
+        writer.put('\n');
+    }
+
+    void write_json_string(BufferedWriter &writer, const std::string &text)
+    {
+        static const char hex[] = "0123456789abcdef";
+        writer.put('"');
+        for (char c : text)
+        {
+            unsigned char byte = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\')
+            {
+                writer.put('\\');
+                writer.put(c);
+            }
+            else if (byte < 0x20)
+            {
+                writer.put("\\u00", 4);
+                writer.put(hex[byte >> 4]);
+                writer.put(hex[byte & 0xf]);
+            }
+            else
+            {
+                writer.put(c);
+            }
+        }
+        writer.put('"');
+    }
+
+    void write_json_ints(BufferedWriter &writer, const std::set<int> &values)
+    {
+        writer.put('[');
+        bool first = true;
+        for (int value : values)
+        {
+            if (!first)
+            {
+                writer.put(',');
+            }
+            writer.putInt(value);
+            first = false;
+        }
+        writer.put(']');
+    }
+
+    // {"initial":0,"states":[...],"accepts":[...],"edges":[[起点,终点,符号],...]}
+    void write_json_automaton(BufferedWriter &writer, const std::shared_ptr<Graph> &graph)
+    {
+        writer.put("{\"initial\":");
+        writer.putInt(graph->getInitialState());
+        writer.put(",\"states\":");
+        write_json_ints(writer, graph->getAllStates());
+        writer.put(",\"accepts\":");
+        write_json_ints(writer, graph->getAcceptStates());
+        writer.put(",\"edges\":[");
+        bool first = true;
+        for (const Edge &edge : graph->getEdges())
+        {
+            writer.put(first ? "[" : ",[");
+            writer.putInt(edge.u);
+            writer.put(',');
+            writer.putInt(edge.v);
+            writer.put(',');
+            writer.putInt(symbol_code(edge));
+            writer.put(']');
+            first = false;
+        }
+        writer.put("]}");
+    }
+
+    // 每行一项：自动机,类别,状态,目标,符号；类别为initial、accept或edge，前两类的目标与符号为空
+    void write_csv_automaton(BufferedWriter &writer, const std::shared_ptr<Graph> &graph, const char *name)
+    {
+        writer.put(name);
+        writer.put(",initial,");
+        writer.putInt(graph->getInitialState());
+        writer.put(",,\n");
+        for (int state : graph->getAcceptStates())
+        {
+            writer.put(name);
+            writer.put(",accept,");
+            writer.putInt(state);
+            writer.put(",,\n");
+        }
+        for (const Edge &edge : graph->getEdges())
+        {
+            writer.put(name);
+            writer.put(",edge,");
+            writer.putInt(edge.u);
+            writer.put(',');
+            writer.putInt(edge.v);
+            writer.put(',');
+            writer.putInt(symbol_code(edge));
+            writer.put('\n');
+        }
+    }
+
+    // DOT标签中的一个符号，引号和反斜杠需要转义
+    void write_dot_symbol(BufferedWriter &writer, char c, bool epsilon)
+    {
+        if (!epsilon && (c == '"' || c == '\\'))
+        {
+            writer.put('\\');
+            writer.put(c);
+        }
+        else if (epsilon || !isprint(static_cast<unsigned char>(c)))
+        {
+            std::string label = symbol_label(c, epsilon);
+            for (char l : label)
+            {
+                if (l == '\\')
+                {
+                    writer.put('\\');
+                }
+                writer.put(l);
+            }
+        }
+        else
+        {
+            writer.put(c);
+        }
+    }
+
+    // 同一对状态之间的边合并为一条，标签列出所有符号
+    void write_dot_automaton(BufferedWriter &writer, const std::shared_ptr<Graph> &graph, const char *name)
+    {
+        writer.put("digraph ");
+        writer.put(name);
+        writer.put(" {\n  rankdir=LR;\n  node [shape=circle];\n  start [shape=point];\n  start -> ");
+        writer.putInt(graph->getInitialState());
+        writer.put(";\n");
+        for (int state : graph->getAcceptStates())
+        {
+            writer.put("  ");
+            writer.putInt(state);
+            writer.put(" [shape=doublecircle];\n");
+        }
+
+        std::vector<std::tuple<int, int, char, bool>> edges;
+        edges.reserve(graph->getEdges().size());
+        for (const Edge &edge : graph->getEdges())
+        {
+            edges.emplace_back(edge.u, edge.v, edge.w, edge.epsilon);
+        }
+        std::sort(edges.begin(), edges.end());
+        for (size_t i = 0; i < edges.size(); i++)
+        {
+            int from = std::get<0>(edges[i]);
+            int to = std::get<1>(edges[i]);
+            if (i == 0 || from != std::get<0>(edges[i - 1]) || to != std::get<1>(edges[i - 1]))
+            {
+                writer.put("  ");
+                writer.putInt(from);
+                writer.put(" -> ");
+                writer.putInt(to);
+                writer.put(" [label=\"");
+            }
+            else if (std::get<2>(edges[i]) == std::get<2>(edges[i - 1]) &&
+                     std::get<3>(edges[i]) == std::get<3>(edges[i - 1]))
+            {
+                continue; // 重复的边
+            }
+            else
+            {
+                writer.put(',');
+            }
+            write_dot_symbol(writer, std::get<2>(edges[i]), std::get<3>(edges[i]));
+            if (i + 1 == edges.size() || from != std::get<0>(edges[i + 1]) || to != std::get<1>(edges[i + 1]))
+            {
+                writer.put("\"];\n");
+            }
+        }
+        writer.put("}\n");
+    }
+}
+
+void print_transition_table(std::ostream &out, const std::shared_ptr<Graph> &graph, const std::string &title, const std::string &regexp, bool is_nfa)
+{
+    BufferedWriter writer(out);
+    write_table(writer, graph, title, regexp, is_nfa);
+}
+
+void print_all_tables(std::ostream &out, const std::string &regexp, const std::shared_ptr<Graph> &nfa,
+                      const std::shared_ptr<Graph> &dfa, const std::shared_ptr<Graph> &min_dfa)
+{
+    print_automata(out, regexp, nfa, dfa, min_dfa, OutputFormat::Table);
+}
+
+void print_automata(std::ostream &out, const std::string &regexp, const std::shared_ptr<Graph> &nfa,
+                    const std::shared_ptr<Graph> &dfa, const std::shared_ptr<Graph> &min_dfa,
+                    OutputFormat format, unsigned sections)
+{
+    struct Section
+    {
+        unsigned flag;
+        const char *name;
+        const char *title;
+        const std::shared_ptr<Graph> &graph;
+    };
+    const Section all[] = {
+        {OUTPUT_NFA, "nfa", "NFA状态转换表", nfa},
+        {OUTPUT_DFA, "dfa", "DFA状态转换表", dfa},
+        {OUTPUT_MIN_DFA, "min_dfa", "最小化DFA状态转换表", min_dfa},
+    };
+
+    BufferedWriter writer(out);
+    if (format == OutputFormat::Json)
+    {
+        writer.put("{\"regexp\":");
+        write_json_string(writer, regexp);
+    }
+    else if (format == OutputFormat::Csv)
+    {
+        writer.put("automaton,kind,state,target,symbol\n");
+    }
+    for (const Section &section : all)
+    {
+        if (!(sections & section.flag))
+        {
+            continue;
+        }
+        switch (format)
+        {
+        case OutputFormat::Table:
+            write_table(writer, section.graph, section.title, regexp, section.flag == OUTPUT_NFA);
+            break;
+        case OutputFormat::Json:
+            writer.put(",\"");
+            writer.put(section.name);
+            writer.put("\":");
+            write_json_automaton(writer, section.graph);
+            break;
+        case OutputFormat::Csv:
+            write_csv_automaton(writer, section.graph, section.name);
+            break;
+        case OutputFormat::Dot:
+            write_dot_automaton(writer, section.graph, section.name);
+            break;
+        }
+    }
+    if (format == OutputFormat::Json)
+    {
+        writer.put("}\n");
+    }
+}
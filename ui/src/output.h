@@ -0,0 +1,77 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <memory>
+#include <ostream>
+#include <set>
+#include <string>
+#include "graph.h"
+
+// 状态转换表的文本输出，命令行与服务器模式共用
+
+// 输出格式
+enum class OutputFormat
+{
+    Table, // 对齐的状态转换表
+    Json,  // 每个自动机的初始状态、状态、接受状态和边
+    Csv,   // 初始状态、接受状态与边的列表
+    Dot    // Graphviz，每个自动机一个digraph
+};
+
+// 输出哪些自动机，按位组合
+enum OutputSection : unsigned
+{
+    OUTPUT_NFA = 1,
+    OUTPUT_DFA = 2,
+    OUTPUT_MIN_DFA = 4,
+    OUTPUT_ALL = OUTPUT_NFA | OUTPUT_DFA | OUTPUT_MIN_DFA
+};
+
+// 解析table、json、csv、dot，名字无效时返回false
+bool parse_output_format(const std::string &name, OutputFormat &format);
+
+// 带缓冲的输出：先写入内存中的缓冲区，攒满后整块写入ostream，
+// 省去逐项经过流的格式化；析构时写出剩余内容
+class BufferedWriter
+{
+public:
+    explicit BufferedWriter(std::ostream &out, size_t capacity = 1 << 16);
+    ~BufferedWriter();
+
+    BufferedWriter(const BufferedWriter &) = delete;
+    BufferedWriter &operator=(const BufferedWriter &) = delete;
+
+    void put(char c);
+    void put(const char *data, size_t length);
+    void put(const std::string &text);
+    void putInt(long long value);
+    // 左侧补空格右对齐到width字节，与std::setw相同，超出时不截断
+    void putPadded(const std::string &text, size_t width);
+    void flush();
+
+private:
+    std::ostream &out;
+    std::string buffer;
+    size_t capacity;
+};
+
+// 从正则表达式中提取字母表
+std::set<char> extract_alphabet_from_regexp(const std::string &regexp);
+
+// 获取完整的字母表
+std::set<char> get_full_alphabet(const std::shared_ptr<Graph> &graph, const std::string &regexp);
+
+// 打印状态转换表，末尾带一个空行
+void print_transition_table(std::ostream &out, const std::shared_ptr<Graph> &graph, const std::string &title, const std::string &regexp, bool is_nfa = false);
+
+// 依次打印NFA、DFA和最小化DFA三张状态转换表
+void print_all_tables(std::ostream &out, const std::string &regexp, const std::shared_ptr<Graph> &nfa,
+                      const std::shared_ptr<Graph> &dfa, const std::shared_ptr<Graph> &min_dfa);
+
+// 按format输出sections中的自动机，未选中的自动机可以为空指针。
+// JSON与CSV中的符号为0-255的字节值，ε转换为-1，与C接口相同
+void print_automata(std::ostream &out, const std::string &regexp, const std::shared_ptr<Graph> &nfa,
+                    const std::shared_ptr<Graph> &dfa, const std::shared_ptr<Graph> &min_dfa,
+                    OutputFormat format, unsigned sections = OUTPUT_ALL);
+
+#endif // OUTPUT_H
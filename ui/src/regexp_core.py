@@ -0,0 +1,217 @@
+"""regexp动态库的ctypes绑定
+
+在进程内编译正则表达式，得到NFA、DFA、最小化DFA的状态转换表，
+避免每个正则表达式都启动一次regexp_to_dfa进程。
+找不到动态库时可以退回到SubprocessConverter，两者的输出格式相同。
+"""
+import ctypes
+import json
+import os
+import subprocess
+import sys
+
+API_VERSION = 1
+EPSILON = -1
+NFA, DFA, MIN_DFA = 0, 1, 2
+
+_HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+class RegexpError(Exception):
+    """正则表达式有误或转换失败"""
+
+
+class Automaton:
+    """一个自动机的扁平表示，edges中每条边为(起点, 终点, 符号)，ε转换的符号为EPSILON"""
+
+    def __init__(self, initial, states, edges, accepts):
+        self.initial = initial
+        self.states = states
+        self.edges = edges
+        self.accepts = accepts
+
+
+def _library_names():
+    if sys.platform.startswith('win'):
+        return ['regexp.dll', 'libregexp.dll']
+    if sys.platform == 'darwin':
+        return ['libregexp.dylib']
+    return ['libregexp.so']
+
+
+def load_library(path=None):
+    """加载regexp动态库，依次尝试path、环境变量REGEXP_LIBRARY和本文件所在目录，失败时抛出OSError"""
+    candidates = []
+    if path:
+        candidates.append(path)
+    if os.environ.get('REGEXP_LIBRARY'):
+        candidates.append(os.environ['REGEXP_LIBRARY'])
+    candidates += [os.path.join(_HERE, name) for name in _library_names()]
+
+    errors = []
+    for candidate in candidates:
+        if not os.path.exists(candidate):
+            continue
+        try:
+            lib = ctypes.CDLL(candidate)
+        except OSError as e:
+            errors.append(f'{candidate}: {e}')
+            continue
+        _declare(lib)
+        if lib.regexp_api_version() != API_VERSION:
+            errors.append(f'{candidate}: 接口版本不匹配')
+            continue
+        return lib
+    raise OSError('找不到regexp动态库' + (('：\n' + '\n'.join(errors)) if errors else ''))
+
+
+def _declare(lib):
+    result_p = ctypes.c_void_p
+    int_p = ctypes.POINTER(ctypes.c_int)
+    lib.regexp_api_version.restype = ctypes.c_int
+    lib.regexp_api_version.argtypes = []
+    lib.regexp_compile.restype = result_p
+    lib.regexp_compile.argtypes = [ctypes.c_char_p, ctypes.c_size_t]
+    lib.regexp_free.restype = None
+    lib.regexp_free.argtypes = [result_p]
+    lib.regexp_error.restype = ctypes.c_char_p
+    lib.regexp_error.argtypes = [result_p]
+    lib.regexp_initial_state.restype = ctypes.c_int
+    lib.regexp_initial_state.argtypes = [result_p, ctypes.c_int]
+    for name in ('state', 'edge', 'accept'):
+        count = getattr(lib, f'regexp_{name}_count')
+        count.restype = ctypes.c_size_t
+        count.argtypes = [result_p, ctypes.c_int]
+        array = getattr(lib, f'regexp_{name}s')
+        array.restype = int_p
+        array.argtypes = [result_p, ctypes.c_int]
+
+
+def _read_array(pointer, count):
+    # 切片一次性复制整个数组，比逐个下标访问快得多
+    return pointer[:count] if count else []
+
+
+class Compiler:
+    """通过动态库在进程内编译正则表达式"""
+
+    def __init__(self, library_path=None):
+        self.lib = load_library(library_path)
+
+    def compile(self, regexp):
+        """返回(NFA, DFA, 最小化DFA)三个Automaton，正则表达式有误时抛出RegexpError"""
+        data = regexp.encode('utf-8')
+        result = self.lib.regexp_compile(data, len(data))
+        if not result:
+            raise MemoryError('regexp_compile: 内存不足')
+        try:
+            error = self.lib.regexp_error(result)
+            if error is not None:
+                raise RegexpError(error.decode('utf-8', errors='replace'))
+            return tuple(self._automaton(result, kind) for kind in (NFA, DFA, MIN_DFA))
+        finally:
+            self.lib.regexp_free(result)
+
+    def _automaton(self, result, kind):
+        lib = self.lib
+        states = _read_array(lib.regexp_states(result, kind), lib.regexp_state_count(result, kind))
+        flat = _read_array(lib.regexp_edges(result, kind), lib.regexp_edge_count(result, kind) * 3)
+        accepts = _read_array(lib.regexp_accepts(result, kind), lib.regexp_accept_count(result, kind))
+        edges = list(zip(flat[0::3], flat[1::3], flat[2::3]))
+        return Automaton(lib.regexp_initial_state(result, kind), states, edges, accepts)
+
+    def convert(self, regexp):
+        """返回NFA、DFA、最小化DFA三张状态转换表的文本"""
+        nfa, dfa, min_dfa = self.compile(regexp)
+        return (format_table(nfa, 'NFA状态转换表', regexp, True),
+                format_table(dfa, 'DFA状态转换表', regexp),
+                format_table(min_dfa, '最小化DFA状态转换表', regexp))
+
+
+class SubprocessConverter:
+    """调用regexp_to_dfa可执行文件，每个正则表达式启动一次进程"""
+
+    def __init__(self, executable=None):
+        if executable is None:
+            name = 'regexp_to_dfa.exe' if sys.platform.startswith('win') else 'regexp_to_dfa'
+            local = os.path.join(_HERE, name)
+            executable = local if os.path.exists(local) else name
+        self.executable = executable
+
+    def compile(self, regexp):
+        """返回(NFA, DFA, 最小化DFA)三个Automaton，正则表达式有误时抛出RegexpError"""
+        result = subprocess.run(
+            [self.executable, '--format', 'json', '--', regexp],
+            capture_output=True
+        )
+        if result.returncode != 0:
+            raise RegexpError(result.stderr.decode('utf-8', errors='replace').strip())
+
+        # JSON中边的符号与动态库相同：字节值，ε转换为-1
+        data = json.loads(result.stdout)
+        return tuple(Automaton(part['initial'], part['states'], [tuple(e) for e in part['edges']],
+                               part['accepts'])
+                     for part in (data['nfa'], data['dfa'], data['min_dfa']))
+
+    def convert(self, regexp):
+        """返回NFA、DFA、最小化DFA三张状态转换表的文本"""
+        nfa, dfa, min_dfa = self.compile(regexp)
+        return (format_table(nfa, 'NFA状态转换表', regexp, True),
+                format_table(dfa, 'DFA状态转换表', regexp),
+                format_table(min_dfa, '最小化DFA状态转换表', regexp))
+
+
+def create_converter():
+    """优先使用动态库，加载失败时退回到子进程方式"""
+    try:
+        return Compiler()
+    except OSError:
+        return SubprocessConverter()
+
+
+def _char_order(symbol):
+    # 与C++中std::set<char>的顺序一致（char为有符号类型）
+    return symbol - 256 if symbol >= 128 else symbol
+
+
+def _symbol_label(symbol):
+    if symbol == EPSILON:
+        # "ε"在UTF-8中占两个字节，C++的setw按字节计算宽度
+        return ' ' * 6 + 'ε'
+    if 0x20 <= symbol <= 0x7E:
+        return chr(symbol).rjust(8)
+    return f'\\x{symbol:02X}'.rjust(8)
+
+
+def format_table(automaton, title, regexp, is_nfa=False):
+    """生成与regexp_to_dfa输出相同的状态转换表（不含末尾空行）"""
+    transitions = {}
+    symbols = set()
+    for u, v, symbol in automaton.edges:
+        if symbol == EPSILON and not is_nfa:
+            continue
+        transitions.setdefault((u, symbol), set()).add(v)
+        symbols.add(symbol)
+    # 表头还包含正则表达式中出现的字母和数字
+    for byte in regexp.encode('utf-8'):
+        if byte < 0x80 and chr(byte).isalnum():
+            symbols.add(byte)
+    # ε在C++中按'$'排序，紧跟在字节'$'之后
+    alphabet = sorted(symbols, key=lambda s: (_char_order(ord('$') if s == EPSILON else s), s == EPSILON))
+
+    state_width = max([6] + [len(str(s)) for s in automaton.states]) + 2
+    accepts = set(automaton.accepts)
+
+    lines = [f'{title}:']
+    lines.append('State'.rjust(state_width) + ''.join(_symbol_label(s) for s in alphabet) + '  Accept?')
+    lines.append('-' * (state_width + len(alphabet) * 8 + 8))
+    for state in automaton.states:
+        row = str(state).rjust(state_width)
+        for symbol in alphabet:
+            targets = transitions.get((state, symbol))
+            row += (','.join(str(t) for t in sorted(targets)) if targets else '-').rjust(8)
+        row += '  ' + ('Yes' if state in accepts else 'No')
+        if state == automaton.initial:
+            row += ' (Initial)'
+        lines.append(row)
+    return '\n'.join(lines)
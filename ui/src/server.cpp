@@ -0,0 +1,593 @@
+#include "server.h"
+#include "dfa.h"
+#include "nfa.h"
+#include "output.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // 编译失败的原因
+    struct CompileError
+    {
+        std::string code;
+        std::string message;
+    };
+
+    // 编译一个正则表达式，成功时返回三张状态转换表
+    // 每个工作线程复用自己的构造器，避免每个请求重新分配内部容器
+    std::shared_ptr<const std::string> compile(const std::string &regexp, const DFALimits &limits, CompileError &error)
+    {
+        thread_local NFABuilder nfa_builder;
+        thread_local DFABuilder dfa_builder;
+
+        // 请求可能在排队期间已被取消或超时
+        if (limits.cancelled && limits.cancelled->load())
+        {
+            error = {"CANCELLED", "请求已被取消"};
+            return nullptr;
+        }
+        if (std::chrono::steady_clock::now() > limits.deadline)
+        {
+            error = {"TIMEOUT", "请求在排队时超过截止时间"};
+            return nullptr;
+        }
+
+        try
+        {
+            nfa_builder.setLimits(limits);
+            auto nfa = nfa_builder.buildNFA(regexp);
+            dfa_builder.setLimits(limits);
+            auto dfa = dfa_builder.buildDFA(nfa);
+            dfa_builder.setMinimizeMode(nfa_builder.builtKeywordTrie() ? MinimizeMode::Parallel : MinimizeMode::Sequential);
+            auto min_dfa = dfa_builder.minimizeDFA(dfa);
+
+            std::ostringstream out;
+            print_all_tables(out, regexp, nfa, dfa, min_dfa);
+            return std::make_shared<const std::string>(out.str());
+        }
+        catch (const DFALimitExceeded &e)
+        {
+            switch (e.getKind())
+            {
+            case DFALimitKind::Deadline:
+                error = {"TIMEOUT", e.what()};
+                break;
+            case DFALimitKind::Cancelled:
+                error = {"CANCELLED", e.what()};
+                break;
+            default:
+                error = {"TOO_LARGE", e.what()};
+                break;
+            }
+        }
+        catch (const std::invalid_argument &e)
+        {
+            error = {"INVALID", e.what()};
+        }
+        catch (const std::exception &e)
+        {
+            error = {"INTERNAL", e.what()};
+        }
+        return nullptr;
+    }
+
+    // 读取一行，去掉行尾的\r
+    bool read_line(std::istream &in, std::string &line)
+    {
+        if (!std::getline(in, line))
+        {
+            return false;
+        }
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        return true;
+    }
+
+    // 读取定长负载及其后的换行
+    bool read_payload(std::istream &in, size_t length, std::string &payload)
+    {
+        payload.resize(length);
+        if (length != 0 && !in.read(&payload[0], static_cast<std::streamsize>(length)))
+        {
+            return false;
+        }
+        if (in.peek() == '\r')
+        {
+            in.get();
+        }
+        if (in.peek() == '\n')
+        {
+            in.get();
+        }
+        return true;
+    }
+}
+
+// 一个连接的状态：答复的输出流与尚未完成的请求
+struct CompileServer::Connection
+{
+    explicit Connection(std::ostream &out) : out(out), inflight(0) {}
+
+    // 输出一帧答复，header为长度之前的部分
+    void send(const std::string &header, const std::string &payload)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        out << header << ' ' << payload.size() << '\n';
+        out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+        out << '\n';
+        out.flush();
+    }
+
+    // 登记一个请求，id重复时返回空指针
+    std::shared_ptr<std::atomic<bool>> begin(const std::string &id)
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        auto flag = std::make_shared<std::atomic<bool>>(false);
+        if (!pending.emplace(id, flag).second)
+        {
+            return nullptr;
+        }
+        inflight++;
+        return flag;
+    }
+
+    // 先从pending中删除再答复，答复之后的CANCEL不会影响同一id的新请求
+    void finish(const std::string &id)
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        pending.erase(id);
+    }
+
+    void done()
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        inflight--;
+        idle.notify_all();
+    }
+
+    void cancel(const std::string &id)
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        auto it = pending.find(id);
+        if (it != pending.end())
+        {
+            it->second->store(true);
+        }
+    }
+
+    // 等待全部请求答复完毕
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(pendingMutex);
+        idle.wait(lock, [this]
+                  { return inflight == 0; });
+    }
+
+    std::ostream &out;
+    std::mutex writeMutex;
+    std::mutex pendingMutex;
+    std::condition_variable idle;
+    std::unordered_map<std::string, std::shared_ptr<std::atomic<bool>>> pending;
+    size_t inflight;
+};
+
+CompileServer::CompileServer(const ServerOptions &options)
+    : options(options), pool(options.threads)
+{
+}
+
+std::shared_ptr<const std::string> CompileServer::lookup(const std::string &regex)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cacheIndex.find(regex);
+    if (it == cacheIndex.end())
+    {
+        return nullptr;
+    }
+    cacheEntries.splice(cacheEntries.begin(), cacheEntries, it->second);
+    return it->second->second;
+}
+
+void CompileServer::store(const std::string &regex, const std::shared_ptr<const std::string> &result)
+{
+    if (options.cacheSize == 0)
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (cacheIndex.count(regex))
+    {
+        return;
+    }
+    cacheEntries.emplace_front(regex, result);
+    cacheIndex[regex] = cacheEntries.begin();
+    if (cacheEntries.size() > options.cacheSize)
+    {
+        cacheIndex.erase(cacheEntries.back().first);
+        cacheEntries.pop_back();
+    }
+}
+
+void CompileServer::serve(std::istream &in, std::ostream &out)
+{
+    Connection connection(out);
+    std::string line;
+    while (read_line(in, line))
+    {
+        std::istringstream header(line);
+        std::string command, id;
+        header >> command;
+        if (command.empty())
+        {
+            continue;
+        }
+        if (command == "QUIT")
+        {
+            break;
+        }
+        if (command == "CANCEL")
+        {
+            if (header >> id)
+            {
+                connection.cancel(id);
+            }
+            else
+            {
+                connection.send("ERR - BAD_REQUEST", "CANCEL缺少id");
+            }
+            continue;
+        }
+        if (command != "COMPILE")
+        {
+            connection.send("ERR - BAD_REQUEST", "未知的命令 " + command);
+            continue;
+        }
+
+        unsigned long long deadlineMs, maxStates, length;
+        if (!(header >> id >> deadlineMs >> maxStates >> length))
+        {
+            // 无法确定负载长度，只能放弃这个连接
+            connection.send("ERR " + (id.empty() ? std::string("-") : id) + " BAD_REQUEST", "COMPILE的头部格式错误");
+            break;
+        }
+        if (length > options.maxPatternBytes)
+        {
+            in.ignore(static_cast<std::streamsize>(length));
+            read_payload(in, 0, line);
+            connection.send("ERR " + id + " BAD_REQUEST",
+                            "正则表达式超过 " + std::to_string(options.maxPatternBytes) + " 字节");
+            continue;
+        }
+        std::string regexp;
+        if (!read_payload(in, static_cast<size_t>(length), regexp))
+        {
+            break;
+        }
+
+        auto cached = lookup(regexp);
+        if (cached)
+        {
+            connection.send("OK " + id, *cached);
+            continue;
+        }
+        auto cancelled = connection.begin(id);
+        if (!cancelled)
+        {
+            connection.send("ERR " + id + " BAD_REQUEST", "id " + id + " 的请求尚未完成");
+            continue;
+        }
+
+        // 请求的上限不超过服务器的默认值
+        DFALimits limits;
+        unsigned effectiveMs = deadlineMs == 0 ? options.deadlineMs
+                                               : static_cast<unsigned>(std::min<unsigned long long>(deadlineMs, options.deadlineMs));
+        limits.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(effectiveMs);
+        limits.maxStates = maxStates == 0 ? options.maxStates
+                                          : static_cast<size_t>(std::min<unsigned long long>(maxStates, options.maxStates));
+        limits.maxMemoryBytes = options.maxMemoryBytes;
+
+        pool.submit([this, &connection, id, regexp, limits, cancelled]() mutable
+                    {
+                        limits.cancelled = cancelled.get();
+                        CompileError error;
+                        auto result = compile(regexp, limits, error);
+                        if (result)
+                        {
+                            store(regexp, result);
+                        }
+                        connection.finish(id);
+                        if (result)
+                        {
+                            connection.send("OK " + id, *result);
+                        }
+                        else
+                        {
+                            connection.send("ERR " + id + " " + error.code, error.message);
+                        }
+                        connection.done(); });
+    }
+    connection.wait();
+}
+
+#if !defined(_WIN32)
+namespace
+{
+    // 基于文件描述符的流缓冲区，供套接字连接使用iostream
+    class FdStreamBuf : public std::streambuf
+    {
+    public:
+        explicit FdStreamBuf(int fd) : fd(fd)
+        {
+            setg(input, input, input);
+            setp(output, output + sizeof(output));
+        }
+
+        ~FdStreamBuf() override
+        {
+            sync();
+        }
+
+    protected:
+        int_type underflow() override
+        {
+            ssize_t count;
+            do
+            {
+                count = ::read(fd, input, sizeof(input));
+            } while (count < 0 && errno == EINTR);
+            if (count <= 0)
+            {
+                return traits_type::eof();
+            }
+            setg(input, input, input + count);
+            return traits_type::to_int_type(*gptr());
+        }
+
+        int_type overflow(int_type c) override
+        {
+            if (sync() != 0)
+            {
+                return traits_type::eof();
+            }
+            if (!traits_type::eq_int_type(c, traits_type::eof()))
+            {
+                *pptr() = traits_type::to_char_type(c);
+                pbump(1);
+            }
+            return traits_type::not_eof(c);
+        }
+
+        int sync() override
+        {
+            const char *data = pbase();
+            while (data < pptr())
+            {
+                ssize_t count = ::write(fd, data, static_cast<size_t>(pptr() - data));
+                if (count < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return -1;
+                }
+                data += count;
+            }
+            setp(output, output + sizeof(output));
+            return 0;
+        }
+
+    private:
+        int fd;
+        char input[4096];
+        char output[4096];
+    };
+
+    // 信号处理函数写入的管道，主循环与accept一起等待它的读端
+    int shutdownPipe[2] = {-1, -1};
+
+    void on_shutdown_signal(int)
+    {
+        int saved = errno;
+        char byte = 0;
+        ssize_t ignored = ::write(shutdownPipe[1], &byte, 1);
+        (void)ignored;
+        errno = saved;
+    }
+
+    // SIGINT与SIGTERM请求正常退出；信号可能送达任意线程，因此经管道通知主循环
+    class ShutdownSignals
+    {
+    public:
+        ~ShutdownSignals()
+        {
+            if (installed)
+            {
+                ::sigaction(SIGINT, &previousInt, nullptr);
+                ::sigaction(SIGTERM, &previousTerm, nullptr);
+            }
+            if (shutdownPipe[0] >= 0)
+            {
+                ::close(shutdownPipe[0]);
+                ::close(shutdownPipe[1]);
+                shutdownPipe[0] = shutdownPipe[1] = -1;
+            }
+        }
+
+        bool install()
+        {
+            if (::pipe(shutdownPipe) != 0)
+            {
+                shutdownPipe[0] = shutdownPipe[1] = -1;
+                return false;
+            }
+            ::fcntl(shutdownPipe[1], F_SETFL, O_NONBLOCK);
+            struct sigaction action{};
+            action.sa_handler = on_shutdown_signal;
+            sigemptyset(&action.sa_mask);
+            installed = ::sigaction(SIGINT, &action, &previousInt) == 0;
+            if (installed && ::sigaction(SIGTERM, &action, &previousTerm) != 0)
+            {
+                ::sigaction(SIGINT, &previousInt, nullptr);
+                installed = false;
+            }
+            return installed;
+        }
+
+        int fd() const
+        {
+            return shutdownPipe[0];
+        }
+
+    private:
+        bool installed = false;
+        struct sigaction previousInt{};
+        struct sigaction previousTerm{};
+    };
+
+    // 服务一个连接的线程；finished在线程退出前置位，主循环据此回收。
+    // 描述符只由主线程在join之后关闭，关闭前不会被复用，主线程随时可以对它调用shutdown
+    struct ClientThread
+    {
+        int fd;
+        std::shared_ptr<std::atomic<bool>> finished;
+        std::thread thread;
+    };
+}
+
+int run_socket_server(const std::string &path, const ServerOptions &options)
+{
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        std::cerr << "Error: 套接字路径过长: " << path << std::endl;
+        return 1;
+    }
+    address.sun_family = AF_UNIX;
+    std::copy(path.begin(), path.end(), address.sun_path);
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+    {
+        std::cerr << "Error: 无法创建套接字" << std::endl;
+        return 1;
+    }
+    ::unlink(path.c_str());
+    if (::bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+        ::listen(listener, SOMAXCONN) != 0)
+    {
+        std::cerr << "Error: 无法监听 " << path << std::endl;
+        ::close(listener);
+        return 1;
+    }
+    ShutdownSignals signals;
+    if (!signals.install())
+    {
+        std::cerr << "Error: 无法安装信号处理函数" << std::endl;
+        ::close(listener);
+        ::unlink(path.c_str());
+        return 1;
+    }
+
+    CompileServer server(options);
+    std::list<ClientThread> clients;
+    int status = 0;
+    while (true)
+    {
+        pollfd fds[2] = {{listener, POLLIN, 0}, {signals.fd(), POLLIN, 0}};
+        if (::poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            status = 1;
+            break;
+        }
+        if (fds[1].revents != 0)
+        {
+            break;
+        }
+        if (fds[0].revents == 0)
+        {
+            continue;
+        }
+        int client = ::accept(listener, nullptr, nullptr);
+        if (client < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            std::cerr << "Error: accept失败" << std::endl;
+            status = 1;
+            break;
+        }
+
+        // 回收已经结束的连接线程，长时间运行时线程对象不会越积越多
+        for (auto it = clients.begin(); it != clients.end();)
+        {
+            if (it->finished->load())
+            {
+                it->thread.join();
+                ::close(it->fd);
+                it = clients.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        auto finished = std::make_shared<std::atomic<bool>>(false);
+        clients.push_back({client, finished, std::thread([&server, client, finished]
+                                                             {
+                                                                 {
+                                                                     FdStreamBuf buffer(client);
+                                                                     std::istream in(&buffer);
+                                                                     std::ostream out(&buffer);
+                                                                     server.serve(in, out);
+                                                                 }
+                                                                 // 描述符留给主线程关闭，这里只结束双向传输，对端随即读到文件结束
+                                                                 ::shutdown(client, SHUT_RDWR);
+                                                                 finished->store(true); })});
+    }
+
+    // 不再接受新连接；关闭各连接的读端，serve读到输入结束后答复已提交的请求再返回
+    ::close(listener);
+    ::unlink(path.c_str());
+    for (auto &entry : clients)
+    {
+        if (!entry.finished->load())
+        {
+            ::shutdown(entry.fd, SHUT_RD);
+        }
+    }
+    for (auto &entry : clients)
+    {
+        entry.thread.join();
+        ::close(entry.fd);
+    }
+    return status;
+}
+#else
+int run_socket_server(const std::string &path, const ServerOptions &)
+{
+    std::cerr << "Error: 当前平台不支持套接字模式，无法监听 " << path << std::endl;
+    return 1;
+}
+#endif
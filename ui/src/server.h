@@ -0,0 +1,72 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "thread_pool.h"
+#include <cstddef>
+#include <istream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+// 常驻编译服务器
+//
+// 以文本帧通信，每帧一行头部，需要时跟随定长负载；id是不含空白的任意字符串。
+// 请求：
+//   COMPILE <id> <deadline_ms> <max_states> <length>\n<length字节的正则表达式>\n
+//       deadline_ms与max_states为0时使用服务器的默认值，非0时不超过默认值
+//   CANCEL <id>\n
+//       取消尚未完成的请求，该请求随后以ERR CANCELLED答复；请求已经完成时忽略
+//   QUIT\n
+//       等待本连接已提交的请求全部答复后关闭连接，输入结束时同样处理
+// 答复（请求在线程池中并行处理，答复顺序可能与请求不同，以id对应）：
+//   OK <id> <length>\n<length字节的三张状态转换表>\n
+//   ERR <id> <code> <length>\n<length字节的错误信息>\n
+//       code为 BAD_REQUEST、INVALID（正则表达式有误）、TOO_LARGE（超出状态数或内存上限）、
+//       TIMEOUT（超过截止时间）、CANCELLED 或 INTERNAL；无法确定id时id为-
+//
+// 截止时间从服务器读完请求时开始计算，包含排队时间。
+// 成功的结果按正则表达式缓存（LRU），命中缓存时不再检查上限。
+
+struct ServerOptions
+{
+    size_t threads = 0;                     // 工作线程数，0表示使用硬件线程数
+    size_t cacheSize = 256;                 // 缓存的结果数
+    unsigned deadlineMs = 10000;            // 默认且最大的截止时间（毫秒）
+    size_t maxStates = 100000;              // 默认且最大的DFA状态数
+    size_t maxMemoryBytes = 256 << 20;      // DFA构造的内存上限（字节）
+    size_t maxPatternBytes = 1 << 20;       // 单个正则表达式的最大长度
+};
+
+class CompileServer
+{
+public:
+    explicit CompileServer(const ServerOptions &options);
+
+    // 处理一个连接上的全部请求，直到QUIT或输入结束；可以在多个线程中同时调用
+    void serve(std::istream &in, std::ostream &out);
+
+private:
+    struct Connection;
+
+    // 查找与更新结果缓存
+    std::shared_ptr<const std::string> lookup(const std::string &regex);
+    void store(const std::string &regex, const std::shared_ptr<const std::string> &result);
+
+    ServerOptions options;
+    ThreadPool pool;
+
+    typedef std::list<std::pair<std::string, std::shared_ptr<const std::string>>> CacheList;
+    std::mutex cacheMutex;
+    CacheList cacheEntries; // 最近使用的在前
+    std::unordered_map<std::string, CacheList::iterator> cacheIndex;
+};
+
+// 在Unix域套接字path上监听，每个连接由一个线程服务，所有连接共享线程池和缓存。
+// 收到SIGINT或SIGTERM时停止接受新连接，各连接答复已提交的请求后关闭，然后返回0；
+// 返回非0表示无法监听或accept出错
+int run_socket_server(const std::string &path, const ServerOptions &options);
+
+#endif // SERVER_H